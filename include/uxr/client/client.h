@@ -21,6 +21,14 @@
 #include <uxr/client/profile/discovery/discovery.h>
 #endif //PROFILE_DISCOVERY
 
+#if defined(PROFILE_DURABLE_HISTORY) && defined(PLATFORM_NAME_LINUX)
+#include <uxr/client/profile/storage/durable_history.h>
+#endif //PROFILE_DURABLE_HISTORY
+
+#if defined(PROFILE_MESSAGE_CAPTURE) && defined(PLATFORM_NAME_LINUX)
+#include <uxr/client/profile/capture/message_capture.h>
+#endif //PROFILE_MESSAGE_CAPTURE
+
 #include <uxr/client/core/session/session.h>
 #include <uxr/client/core/session/write_access.h>
 #include <uxr/client/core/session/read_access.h>
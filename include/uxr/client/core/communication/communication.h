@@ -27,6 +27,7 @@ extern "C"
 typedef bool (*send_msg_func)(void* instance, const uint8_t* buf, size_t len);
 typedef bool (*recv_msg_func)(void* instance, uint8_t** buf, size_t* len, int timeout);
 typedef uint8_t (*comm_error_func)(void);
+typedef bool (*msg_timestamps_func)(void* instance, int64_t* sent, int64_t* received);
 
 typedef struct uxrCommunication
 {
@@ -34,6 +35,7 @@ typedef struct uxrCommunication
     send_msg_func send_msg;
     recv_msg_func recv_msg;
     comm_error_func comm_error;
+    msg_timestamps_func msg_timestamps; // Optional, NULL if the transport does not provide timestamps.
     uint16_t mtu;
 
 } uxrCommunication;
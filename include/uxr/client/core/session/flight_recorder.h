@@ -0,0 +1,56 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _UXR_CLIENT_CORE_SESSION_FLIGHT_RECORDER_H_
+#define _UXR_CLIENT_CORE_SESSION_FLIGHT_RECORDER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <uxr/client/config.h>
+#include <uxr/client/core/session/stream/seq_num.h>
+
+#include <stdint.h>
+
+#define UXR_EVENT_HEARTBEAT_SENT        0x01 // seq_num: first unacked, value: last unacked, extra: tries
+#define UXR_EVENT_ACKNACK_RECEIVED      0x02 // seq_num: first unacked, value: nack bitmap
+#define UXR_EVENT_SEND_LOST             0x03 // seq_num: last acknowledged, value: 1 when entering, 0 when leaving
+#define UXR_EVENT_PREPARE_FAILED        0x04 // seq_num: last written, value: submessage size
+#define UXR_EVENT_FRAGMENTS_COMPLETED   0x05 // seq_num: last fragment, value: fragment count
+
+typedef struct uxrFlightEvent
+{
+    int64_t timestamp; // nanoseconds
+    uint8_t type;
+    uint8_t stream_id;
+    uxrSeqNum seq_num;
+    uint16_t value;
+    uint16_t extra;
+
+} uxrFlightEvent;
+
+typedef struct uxrFlightRecorder
+{
+    uxrFlightEvent events[UXR_CONFIG_FLIGHT_RECORDER_EVENTS];
+    uint32_t count;
+
+} uxrFlightRecorder;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _UXR_CLIENT_CORE_SESSION_FLIGHT_RECORDER_H_
@@ -21,7 +21,11 @@ extern "C"
 #endif
 
 #include <uxr/client/core/session/session_info.h>
+#include <uxr/client/core/session/time_sync.h>
+#include <uxr/client/core/session/session_stats.h>
+#include <uxr/client/core/session/flight_recorder.h>
 #include <uxr/client/core/session/stream/stream_storage.h>
+#include <uxr/client/util/token_bucket.h>
 
 #define UXR_TIMEOUT_INF       -1
 
@@ -48,6 +52,14 @@ typedef void (*uxrOnTimeFunc) (struct uxrSession* session,
                                int64_t originate_timestamp,
                                void* args);
 
+typedef void (*uxrOnMessageFunc) (struct uxrSession* session,
+                                  bool output,
+                                  const uint8_t* buffer,
+                                  size_t length,
+                                  void* args);
+
+typedef bool (*uxrOnBuffersFull) (struct uxrSession* session);
+
 #ifdef PERFORMANCE_TESTING
 typedef void (*uxrOnPerformanceFunc) (struct uxrSession* session, struct ucdrBuffer* mb, void* args);
 #endif
@@ -72,6 +84,23 @@ typedef struct uxrSession
     void* on_time_args;
     int64_t time_offset;
     bool synchronized;
+    uxrTimeSync time_sync;
+
+    uxrOnMessageFunc on_message;
+    void* on_message_args;
+
+    uxrOnBuffersFull on_buffers_full;
+
+    uxrTokenBucket* shaper;     // NULL if the transport is not rate limited
+    int64_t next_flash;         // milliseconds, INT64_MAX if no message is held back by the shapers or congestion windows
+
+#ifdef PROFILE_SESSION_STATS
+    uxrSessionStats stats;
+#endif
+
+#ifdef PROFILE_FLIGHT_RECORDER
+    uxrFlightRecorder flight_recorder;
+#endif
 
 #ifdef PERFORMANCE_TESTING
     uxrOnPerformanceFunc on_performance;
@@ -92,6 +121,19 @@ UXRDLLAPI void uxr_init_session(
         struct uxrCommunication* comm,
         uint32_t key);
 
+/**
+ * @brief Replaces the stream arrays of the session by caller-provided ones, of any length.
+ *        The arrays with a NULL pointer keep the ones sized by the `CONFIG_MAX_*_STREAMS` variables
+ *        at `client.config` file, which can then be set to 0 for the kinds given here,
+ *        so the session embeds no stream of those kinds.
+ *        Shall be called before creating any stream; the arrays shall outlive the session.
+ * @param session   A uxrSession structure previously initialized.
+ * @param arrays    The stream arrays and their capacities, copied by the session.
+ */
+UXRDLLAPI void uxr_set_session_streams(
+        uxrSession* session,
+        const uxrStreamArrays* arrays);
+
 /**
  * @brief Sets the status callback.
  *        This is called when a status message is received from the Agent.
@@ -130,6 +172,19 @@ UXRDLLAPI void uxr_set_time_callback(
         uxrOnTimeFunc on_time_func,
         void* args);
 
+/**
+ * @brief Sets the message callback.
+ *        The callback is called with every raw message successfully sent to or received from the Agent,
+ *        before it is processed. It is intended for capturing the traffic, so it shall return quickly.
+ * @param session           A uxrSession structure previously initialized.
+ * @param on_message_func   The function that will be called for each message.
+ * @param args              User pointer data. The args will be provided to `on_message_func` function.
+ */
+UXRDLLAPI void uxr_set_message_callback(
+        uxrSession* session,
+        uxrOnMessageFunc on_message_func,
+        void* args);
+
 #ifdef PERFORMANCE_TESTING
 UXRDLLAPI void uxr_set_performance_callback(uxrSession* session, uxrOnPerformanceFunc on_performance_func, void* args);
 #endif
@@ -154,11 +209,12 @@ UXRDLLAPI bool uxr_delete_session(uxrSession* session);
 /**
  * @brief Creates and initializes an output best-effort stream.
  *        The maximum number of output best-effort streams is set by the `CONFIG_MAX_OUTPUT_BEST_EFFORT_STREAMS`
- *        variable at `client.config` file.
+ *        variable at `client.config` file, or by the arrays given to `uxr_set_session_streams`.
  * @param session   A uxrSession structure previously initialized.
  * @param buffer    The memory block where the messages will be written.
  * @param size      The buffer size.
- * @return  A uxrStreamId which could by used for managing the stream.
+ * @return  A uxrStreamId which could by used for managing the stream,
+ *          or one of type UXR_NONE_STREAM if the maximum number of streams is reached.
  */
 UXRDLLAPI uxrStreamId uxr_create_output_best_effort_stream(
         uxrSession* session,
@@ -168,14 +224,15 @@ UXRDLLAPI uxrStreamId uxr_create_output_best_effort_stream(
 /**
  * @brief Creates and initializes an output reliable stream.
  *        The maximum number of output reliable streams is set by the `CONFIG_MAX_OUTPUT_RELIABLE_STREAMS`
- *        variable at `client.config` file.
+ *        variable at `client.config` file, or by the arrays given to `uxr_set_session_streams`.
  * @param session   A uxrSession structure previously initialized.
  * @param buffer    The memory block where the messages will be written.
  * @param size      The buffer size.
  * @param history   The amount of messages that the stream is able to manage.
  *                  The buffer size will be splitted into blocks according to this value.
  *                  This value shall be power of 2.
- * @return  A uxrStreamId which could by used for managing the stream.
+ * @return  A uxrStreamId which could by used for managing the stream,
+ *          or one of type UXR_NONE_STREAM if the maximum number of streams is reached.
  */
 UXRDLLAPI uxrStreamId uxr_create_output_reliable_stream(
         uxrSession* session,
@@ -183,26 +240,75 @@ UXRDLLAPI uxrStreamId uxr_create_output_reliable_stream(
         size_t size,
         uint16_t history);
 
+/**
+ * @brief Creates and initializes an output reliable stream whose history survives a restart.
+ *        The stream state is stored together with the messages in `memory`, so when it is backed by
+ *        persistent storage (e.g. a memory-mapped file opened with `uxr_open_durable_history`),
+ *        the messages sent but not acknowledged before a restart are retransmitted in the new session.
+ *        Messages written but not flushed before the restart are discarded.
+ *        The maximum number of output reliable streams is set by the `CONFIG_MAX_OUTPUT_RELIABLE_STREAMS`
+ *        variable at `client.config` file, or by the arrays given to `uxr_set_session_streams`.
+ * @param session   A uxrSession structure previously initialized.
+ * @param memory    The persistent memory block where the stream state and the messages will be written.
+ *                  It shall be aligned to 4 bytes.
+ * @param size      The memory size, including `UXR_DURABLE_STREAM_OVERHEAD` bytes for the stream state.
+ * @param history   The amount of messages that the stream is able to manage.
+ *                  This value shall be power of 2.
+ * @return  A uxrStreamId which could by used for managing the stream, or one of type UXR_NONE_STREAM
+ *          if the maximum number of streams is reached or the memory is too small or misaligned.
+ */
+UXRDLLAPI uxrStreamId uxr_create_output_durable_stream(
+        uxrSession* session,
+        uint8_t* memory,
+        size_t size,
+        uint16_t history);
+
+/**
+ * @brief Creates and initializes an output reliable stream whose messages are packed one after another
+ *        instead of taking a fixed block each, so small messages do not waste the space of a full block.
+ *        The maximum number of output reliable streams is set by the `CONFIG_MAX_OUTPUT_RELIABLE_STREAMS`
+ *        variable at `client.config` file, or by the arrays given to `uxr_set_session_streams`.
+ * @param session   A uxrSession structure previously initialized.
+ * @param memory    The memory block where the message index and the messages will be written, 2-byte aligned.
+ * @param size      The memory size, including `UXR_PACKED_STREAM_OVERHEAD(history)` bytes for the index.
+ *                  Only the first 64 KiB after the index are used for the messages.
+ * @param history   The amount of messages that the stream is able to manage.
+ *                  This value shall be power of 2.
+ * @param mtu       The maximum size of a message, that of the transport used.
+ * @return  A uxrStreamId which could by used for managing the stream,
+ *          or one of type UXR_NONE_STREAM if the maximum number of streams is reached.
+ */
+UXRDLLAPI uxrStreamId uxr_create_output_packed_stream(
+        uxrSession* session,
+        uint8_t* memory,
+        size_t size,
+        uint16_t history,
+        size_t mtu);
+
 /**
  * @brief Creates and initializes an input best-effort stream.
  *        The maximum number of input best-effort streams is set by the `CONFIG_MAX_INPUT_BEST_EFFORT_STREAMS`
- *        variable at `client.config` file.
+ *        variable at `client.config` file, or by the arrays given to `uxr_set_session_streams`.
  * @param session   A uxrSession structure previously initialized.
- * @return  A uxrStreamId which could by used for managing the stream.
+ * @return  A uxrStreamId which could by used for managing the stream,
+ *          or one of type UXR_NONE_STREAM if the maximum number of streams is reached.
  */
 UXRDLLAPI uxrStreamId uxr_create_input_best_effort_stream(uxrSession* session);
 
 /**
  * @brief Creates and initializes an input reliable stream.
  *        The maximum number of input reliable streams is set by the `CONFIG_MAX_INPUT_RELIABLE_STREAMS`
- *        variable at `client.config` file.
+ *        variable at `client.config` file, or by the arrays given to `uxr_set_session_streams`.
  * @param session   A uxrSession structure previously initialized.
  * @param buffer    The memory block where the messages will be written.
  * @param size      The buffer size.
  * @param history   The amount of messages that the stream is able to manage.
  *                  The buffer size will be splitted into blocks according to this value.
- *                  This value shall be power of 2.
- * @return  A uxrStreamId which could by used for managing the stream.
+ *                  This value shall be power of 2, up to the `CONFIG_MAX_INPUT_RELIABLE_HISTORY`
+ *                  variable at `client.config` file.
+ * @return  A uxrStreamId which could by used for managing the stream,
+ *          or one of type UXR_NONE_STREAM if the maximum number of streams is reached
+ *          or the history is above `CONFIG_MAX_INPUT_RELIABLE_HISTORY`.
  */
 UXRDLLAPI uxrStreamId uxr_create_input_reliable_stream(
         uxrSession* session,
@@ -212,6 +318,8 @@ UXRDLLAPI uxrStreamId uxr_create_input_reliable_stream(
 
 /**
  * @brief Flashes all the output streams seding the data through the transport.
+ *        The messages are sent one at a time from the stream with the earliest deadline,
+ *        then the lowest priority value; see `uxr_set_output_stream_priority`.
  * @param session   A uxrSession structure previously initialized.
  */
 UXRDLLAPI void uxr_flash_output_streams(uxrSession* session);
@@ -308,6 +416,9 @@ UXRDLLAPI bool uxr_run_session_until_one_status(
 
 /**
  * @brief Synchronizes the session time using by default the NTP protocol.
+ *        A burst of `UXR_CONFIG_TIME_SYNC_SAMPLES` exchanges is performed, only the ones with the lowest
+ *        round trip time are used, and the clock drift is estimated from the previous synchronizations.
+ *        If a time callback is set, only one exchange is performed and the callback is in charge of the offset.
  * @param session   A uxrSession structure previously initialized.
  * @param time      The waiting time in milliseconds.
  * @return  `true` in case of successful synchronization. `false` in other case.
@@ -316,6 +427,217 @@ UXRDLLAPI bool uxr_sync_session(
         uxrSession* session,
         int time);
 
+/**
+ * @brief Sets the period of the background time synchronization.
+ *        The synchronization bursts are performed while the session is running (`uxr_run_session_*` functions),
+ *        so `uxr_epoch_nanos` follows the Agent clock between explicit synchronizations.
+ *        No background synchronization is performed while a time callback is set (`uxr_set_time_callback`).
+ * @param session   A uxrSession structure previously initialized.
+ * @param period    The period in milliseconds. A value of 0 disables the background synchronization.
+ */
+UXRDLLAPI void uxr_set_time_sync_period(
+        uxrSession* session,
+        int64_t period);
+
+/**
+ * @brief Sets the priority of an output stream, 0 (the default) being the most urgent.
+ *        When flashing, and before retransmitting lost messages, the streams with a lower value go first,
+ *        so bulk transfers can yield to the control ones sharing the transport.
+ * @param session       A uxrSession structure previously initialized.
+ * @param stream_id     The identifier of an output stream.
+ * @param priority      The priority of the stream.
+ * @return `true` if the stream exists. `false` in other case.
+ */
+UXRDLLAPI bool uxr_set_output_stream_priority(
+        uxrSession* session,
+        uxrStreamId stream_id,
+        uint8_t priority);
+
+/**
+ * @brief Sets a deadline for the messages written to an output stream and not sent yet.
+ *        The streams with the earliest deadline are flashed first, regardless of their priority.
+ *        The earliest deadline given is kept until all the messages of the stream have been sent.
+ * @param session       A uxrSession structure previously initialized.
+ * @param stream_id     The identifier of an output stream.
+ * @param deadline      The deadline in milliseconds, in the `uxr_millis` clock.
+ * @return `true` if the stream exists. `false` in other case.
+ */
+UXRDLLAPI bool uxr_set_output_stream_deadline(
+        uxrSession* session,
+        uxrStreamId stream_id,
+        int64_t deadline);
+
+/**
+ * @brief Limits the rate of all the messages sent through the transport of the session.
+ *        The output streams held back are flashed again by the `uxr_run_session_*` functions,
+ *        which wake up as soon as the tokens are available.
+ * @param session   A uxrSession structure previously initialized.
+ * @param shaper    A token bucket initialized by `uxr_init_token_bucket`. NULL removes the limit.
+ */
+UXRDLLAPI void uxr_set_session_shaper(
+        uxrSession* session,
+        uxrTokenBucket* shaper);
+
+/**
+ * @brief Limits the rate of the messages sent, or retransmitted, by an output stream.
+ *        The messages of the stream wait in its buffer until the tokens are available.
+ * @param session       A uxrSession structure previously initialized.
+ * @param stream_id     The identifier of an output stream.
+ * @param shaper        A token bucket initialized by `uxr_init_token_bucket`. NULL removes the limit.
+ * @return `true` if the stream exists. `false` in other case.
+ */
+UXRDLLAPI bool uxr_set_output_stream_shaper(
+        uxrSession* session,
+        uxrStreamId stream_id,
+        uxrTokenBucket* shaper);
+
+/**
+ * @brief Enables the congestion control of an output reliable stream.
+ *        The messages in flight are limited by a window that grows with the clean ACKNACKs (slow start,
+ *        then one message per window acknowledged), halves when the Agent reports lost messages,
+ *        and goes back to one message when the heartbeats are not answered.
+ *        Without it, the whole history may be in flight.
+ * @param session       A uxrSession structure previously initialized.
+ * @param stream_id     The identifier of an output reliable stream.
+ * @param enable        Whether the congestion control is enabled.
+ * @return `true` if the congestion control is enabled (or disabled). `false` in other case.
+ */
+UXRDLLAPI bool uxr_set_output_stream_congestion_control(
+        uxrSession* session,
+        uxrStreamId stream_id,
+        bool enable);
+
+/**
+ * @brief Enables the delivery statistics of an output reliable stream.
+ *        The time from the first send of each message to its acknowledgement, and the number of retransmissions
+ *        it required, are recorded in the `latency` structure.
+ * @param session       A uxrSession structure previously initialized.
+ * @param stream_id     The identifier of an output reliable stream.
+ * @param latency       The structure where the statistics are recorded. NULL disables the statistics.
+ * @param slots         An array used to keep the send time of each message in the stream history.
+ * @param slots_size    The size of the `slots` array. It shall be at least the history of the stream.
+ * @return `true` if the statistics are enabled (or disabled). `false` in other case.
+ */
+UXRDLLAPI bool uxr_set_output_stream_latency(
+        uxrSession* session,
+        uxrStreamId stream_id,
+        uxrOutputReliableStreamLatency* latency,
+        uxrReliableSlotTiming* slots,
+        uint16_t slots_size);
+
+/**
+ * @brief Returns the delivery statistics of an output reliable stream.
+ *        The percentiles of the acknowledgement latency could be obtained with `uxr_histogram_percentile`.
+ * @param session       A uxrSession structure previously initialized.
+ * @param stream_id     The identifier of an output reliable stream.
+ * @return The statistics structure, or NULL if the statistics are not enabled for the stream.
+ */
+UXRDLLAPI const uxrOutputReliableStreamLatency* uxr_get_output_stream_latency(
+        const uxrSession* session,
+        uxrStreamId stream_id);
+
+/**
+ * @brief Delays the ACKNACKs of an input reliable stream, so one acknowledges several messages.
+ *        An ACKNACK is sent once `messages` messages are received in order, or `delay` milliseconds after the first
+ *        of them, whatever comes first. Gaps, retransmissions already received and the Agent HEARTBEATs are answered at once.
+ *        By default, every message is acknowledged (`messages` 1, `delay` 0).
+ * @param session   A uxrSession structure previously initialized.
+ * @param stream_id The identifier of an input reliable stream.
+ * @param messages  The messages acknowledged by each ACKNACK.
+ * @param delay     The longest time an ACKNACK waits, in milliseconds. 0 sends it at once.
+ * @return `true` if the delay is set. `false` in other case.
+ */
+UXRDLLAPI bool uxr_set_input_stream_acknack_delay(
+        uxrSession* session,
+        uxrStreamId stream_id,
+        uint16_t messages,
+        int64_t delay);
+
+/**
+ * @brief Sets a buffer where the fragmented samples of an input reliable stream are reassembled.
+ *        Each fragment is copied at its offset as soon as the previous ones have arrived, and its history slot
+ *        released, so the samples could be larger than the stream buffer. They are delivered to the topic callback
+ *        as a single contiguous buffer. A sample larger than `size` is dropped.
+ * @param session   A uxrSession structure previously initialized.
+ * @param stream_id The identifier of an input reliable stream.
+ * @param buffer    The memory block where the samples are reassembled. NULL reassembles them in the stream history.
+ * @param size      The buffer size, the largest sample that could be received.
+ * @return `true` if the buffer is set (or unset). `false` in other case.
+ */
+UXRDLLAPI bool uxr_set_input_stream_reassembly(
+        uxrSession* session,
+        uxrStreamId stream_id,
+        uint8_t* buffer,
+        size_t size);
+
+#ifdef PROFILE_SESSION_STATS
+/**
+ * @brief Copies the counters of the session.
+ *        The counters are updated as the messages are sent and received, and wrap around on overflow.
+ * @param session   A uxrSession structure previously initialized.
+ * @param stats     The structure where the counters are copied.
+ */
+UXRDLLAPI void uxr_get_session_stats(
+        const uxrSession* session,
+        uxrSessionStats* stats);
+
+/**
+ * @brief Copies the counters of a stream, the messages and bytes it has sent or received.
+ *        They are kept in the stream itself, so the streams of caller-provided arrays are counted as well.
+ * @param session   A uxrSession structure previously initialized.
+ * @param stream_id The identifier of a stream of the session.
+ * @param stats     The structure where the counters are copied.
+ * @return `true` if the stream exists. `false` in other case.
+ */
+UXRDLLAPI bool uxr_get_stream_stats(
+        const uxrSession* session,
+        uxrStreamId stream_id,
+        uxrStreamStats* stats);
+
+/**
+ * @brief Sets to zero the counters of the session and of its streams.
+ * @param session   A uxrSession structure previously initialized.
+ */
+UXRDLLAPI void uxr_reset_session_stats(uxrSession* session);
+#endif
+
+#ifdef PROFILE_FLIGHT_RECORDER
+/**
+ * @brief Copies the most recent reliability events of the session, from the oldest to the newest.
+ *        The session keeps the last `CONFIG_FLIGHT_RECORDER_EVENTS` events in a ring, so they
+ *        can be inspected after a stall of a reliable stream.
+ * @param session   A uxrSession structure previously initialized.
+ * @param events    The array where the events are copied.
+ * @param capacity  The number of elements of `events`.
+ * @return The number of events copied.
+ */
+UXRDLLAPI size_t uxr_get_flight_events(
+        const uxrSession* session,
+        uxrFlightEvent* events,
+        size_t capacity);
+
+/**
+ * @brief Writes the recorded events of the session as text lines into a file descriptor.
+ *        It only uses async-signal-safe calls, so it can be called from a signal handler.
+ *        Only available on POSIX platforms.
+ * @param session   A uxrSession structure previously initialized.
+ * @param fd        The file descriptor, for example `STDERR_FILENO`.
+ * @return `true` if all the events were written. `false` in other case.
+ */
+UXRDLLAPI bool uxr_dump_flight_events(
+        const uxrSession* session,
+        int fd);
+#endif
+
+/**
+ * @brief Returns the reception time of the last message received, in nanoseconds.
+ *        The kernel timestamp is used if the transport provides it (see `uxr_enable_udp_timestamping`),
+ *        in other case the current time is returned. It is intended to be called from the session callbacks.
+ * @param session   A uxrSession structure previously initialized.
+ * @return The reception time in nanoseconds, in the local clock.
+ */
+UXRDLLAPI int64_t uxr_message_timestamp(const uxrSession* session);
+
 /**
  * @brief Returns the epoch time in milliseconds taking into account the offset computed during the time synchronization.
  * @param session   A uxrSession structure previosly initialized.
@@ -52,6 +52,8 @@ typedef struct uxrSessionInfo
 {
     uint8_t id;
     uint8_t key[4];
+    uint8_t header[8];      // Message header of the session, the stream id and seq num patched when stamped.
+    uint8_t header_size;
     uint8_t last_requested_status;
     uint16_t last_request_id;
 
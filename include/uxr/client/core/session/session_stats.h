@@ -0,0 +1,57 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _UXR_CLIENT_CORE_SESSION_SESSION_STATS_H_
+#define _UXR_CLIENT_CORE_SESSION_SESSION_STATS_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <uxr/client/config.h>
+
+#include <stdint.h>
+
+typedef struct uxrStreamStats
+{
+    uint32_t messages;
+    uint64_t bytes;
+
+} uxrStreamStats;
+
+typedef struct uxrSessionStats
+{
+    uxrStreamStats sent;
+    uxrStreamStats received;
+
+    uint32_t heartbeats_sent;
+    uint32_t heartbeats_received;
+    uint32_t acknacks_sent;
+    uint32_t acknacks_received;
+    uint32_t retransmissions;       // Reliable messages sent again after a NACK.
+    uint32_t reliable_drops;        // Reliable messages out of the window or already received.
+    uint32_t fragments_sent;
+    uint32_t fragments_received;
+    uint32_t failed_prepares;       // Submessages not written because the stream had no room.
+    uint32_t send_errors;
+    uint32_t recv_errors;
+
+} uxrSessionStats;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _UXR_CLIENT_CORE_SESSION_SESSION_STATS_H_
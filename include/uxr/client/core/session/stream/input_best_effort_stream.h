@@ -21,6 +21,7 @@ extern "C"
 #endif
 
 #include <uxr/client/core/session/stream/seq_num.h>
+#include <uxr/client/core/session/session_stats.h>
 
 #include <stdint.h>
 #include <stdbool.h>
@@ -29,6 +30,10 @@ typedef struct uxrInputBestEffortStream
 {
     uxrSeqNum last_handled;
 
+#ifdef PROFILE_SESSION_STATS
+    uxrStreamStats stats; // see `uxr_get_stream_stats`
+#endif
+
 } uxrInputBestEffortStream;
 
 #ifdef __cplusplus
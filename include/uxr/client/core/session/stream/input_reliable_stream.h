@@ -21,6 +21,8 @@ extern "C"
 #endif
 
 #include <uxr/client/core/session/stream/seq_num.h>
+#include <uxr/client/core/session/session_stats.h>
+#include <uxr/client/config.h>
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -37,6 +39,20 @@ typedef enum FragmentationInfo
 
 typedef FragmentationInfo (*OnGetFragmentationInfo)(uint8_t* buffer);
 
+#define UXR_INPUT_RELIABLE_BITMAP_WORDS ((UXR_CONFIG_MAX_INPUT_RELIABLE_HISTORY + 31) / 32)
+
+typedef struct uxrInputReliableReassembly
+{
+    uint8_t* buffer;
+    size_t size;
+    size_t fragment_offset;
+
+    size_t length;
+    bool complete;
+    bool overflow;
+
+} uxrInputReliableReassembly;
+
 typedef struct uxrInputReliableStream
 {
     uint8_t* buffer;
@@ -45,9 +61,32 @@ typedef struct uxrInputReliableStream
 
     uxrSeqNum last_handled;
     uxrSeqNum last_announced;
+    bool acknack_pending; // written into the next message leaving the session
+
+    /* Delayed ACKNACK: one every `acknack_messages` messages received in order, or `acknack_delay`
+     * milliseconds after the first of them, whatever comes first. */
+    uint16_t acknack_messages;
+    int64_t acknack_delay;
+    uint16_t unacked_messages;
+    int64_t next_acknack_timestamp; // INT64_MAX if no ACKNACK is delayed
+
+    /* Reassembly progress of the fragmented message after last_handled: its fragments are received
+     * up to last_contiguous, which is its last fragment once last_fragment_found. */
+    uxrSeqNum last_contiguous;
+    bool last_fragment_found;
+
+    /* One bit per history slot, set while the slot holds a received message. */
+    uint32_t received[UXR_INPUT_RELIABLE_BITMAP_WORDS];
+
+    /* Optional buffer where the fragments are placed as they arrive, see `uxr_set_input_stream_reassembly`. */
+    uxrInputReliableReassembly reassembly;
 
     OnGetFragmentationInfo on_get_fragmentation_info;
 
+#ifdef PROFILE_SESSION_STATS
+    uxrStreamStats stats; // see `uxr_get_stream_stats`
+#endif
+
 } uxrInputReliableStream;
 
 #ifdef __cplusplus
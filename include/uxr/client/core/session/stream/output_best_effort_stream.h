@@ -21,6 +21,8 @@ extern "C"
 #endif
 
 #include <uxr/client/core/session/stream/seq_num.h>
+#include <uxr/client/core/session/session_stats.h>
+#include <uxr/client/util/token_bucket.h>
 
 #include <stddef.h>
 #include <stdbool.h>
@@ -35,6 +37,15 @@ typedef struct uxrOutputBestEffortStream
 
     uxrSeqNum last_send;
 
+    /* Flushing order among the output streams: earliest deadline first, then lowest priority. */
+    uint8_t priority;
+    int64_t deadline; // milliseconds, INT64_MAX if none
+    uxrTokenBucket* shaper; // NULL if the stream is not rate limited
+
+#ifdef PROFILE_SESSION_STATS
+    uxrStreamStats stats; // see `uxr_get_stream_stats`
+#endif
+
 } uxrOutputBestEffortStream;
 
 #ifdef __cplusplus
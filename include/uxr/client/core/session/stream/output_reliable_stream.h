@@ -21,6 +21,9 @@ extern "C"
 #endif
 
 #include <uxr/client/core/session/stream/seq_num.h>
+#include <uxr/client/core/session/session_stats.h>
+#include <uxr/client/util/histogram.h>
+#include <uxr/client/util/token_bucket.h>
 
 #include <stddef.h>
 #include <stdbool.h>
@@ -29,6 +32,60 @@ struct ucdrBuffer;
 struct uxrOutputReliableStream;
 
 typedef void (*OnNewFragment)(struct ucdrBuffer* ub, struct uxrOutputReliableStream* stream);
+typedef bool (*OnFullHistory)(struct uxrOutputReliableStream* stream, void* args);
+
+/*
+ * Image of the stream state kept at the beginning of a durable history.
+ * It allows recovering the unacknowledged messages after a restart.
+ */
+typedef struct uxrOutputReliableStreamCursors
+{
+    uint32_t magic;
+    uint32_t size;
+    uint16_t history;
+    uint8_t offset;
+
+    uxrSeqNum last_written;
+    uxrSeqNum last_sent;
+    uxrSeqNum last_acknown;
+
+} uxrOutputReliableStreamCursors;
+
+#define UXR_DURABLE_STREAM_OVERHEAD ((sizeof(uxrOutputReliableStreamCursors) + 7u) / 8u * 8u)
+
+/*
+ * Position of a message in a packed history, where the messages are laid out one after another
+ * instead of in fixed slots. The index takes the beginning of the memory given to the stream.
+ */
+typedef struct uxrPackedMessage
+{
+    uint16_t start;
+    uint16_t length;
+
+} uxrPackedMessage;
+
+#define UXR_PACKED_STREAM_OVERHEAD(history) (((history) * sizeof(uxrPackedMessage) + 7u) / 8u * 8u)
+
+#define UXR_RETRANSMISSION_HISTOGRAM_SIZE 8
+
+typedef struct uxrReliableSlotTiming
+{
+    int64_t sent_timestamp; // nanoseconds, 0 if unknown
+    uint16_t retransmissions;
+
+} uxrReliableSlotTiming;
+
+/*
+ * Optional delivery statistics of an output reliable stream.
+ * The slots are provided by the user, one per history position.
+ */
+typedef struct uxrOutputReliableStreamLatency
+{
+    uxrReliableSlotTiming* slots;
+    uxrHistogram ack_latency; // microseconds from the first send to the acknowledgement
+    uint32_t retransmissions[UXR_RETRANSMISSION_HISTOGRAM_SIZE]; // the last position counts also the higher ones
+
+} uxrOutputReliableStreamLatency;
 
 typedef struct uxrOutputReliableStream
 {
@@ -44,9 +101,38 @@ typedef struct uxrOutputReliableStream
     int64_t next_heartbeat_timestamp;
     uint8_t next_heartbeat_tries;
     bool send_lost;
+    bool heartbeat_pending; // written into the next message leaving the session
+
+    /* Messages in flight allowed by the congestion control, AIMD over the ACKNACKs and heartbeats. */
+    bool congestion_control;
+    uint16_t cwnd;
+    uint16_t ssthresh;
+    uint16_t cwnd_acked;        // acknowledgements counted towards the next increase
+    uxrSeqNum recovery_seq_num; // last message sent when the window shrank, losses up to it shrink it only once
+
+    /* Flushing order among the output streams: earliest deadline first, then lowest priority. */
+    uint8_t priority;
+    int64_t deadline; // milliseconds, INT64_MAX if none
+    uxrTokenBucket* shaper; // NULL if the stream is not rate limited
 
     OnNewFragment on_new_fragment;
 
+    /* Fragmented message written slot by slot, waiting on `on_full_history` for free slots. */
+    size_t fragmented_remaining;
+    size_t fragmented_offset;
+    OnFullHistory on_full_history;
+    void* on_full_history_args;
+
+    uxrPackedMessage* packed; // NULL for fixed slots
+    size_t max_message_size;
+
+    uxrOutputReliableStreamCursors* durable;
+    uxrOutputReliableStreamLatency* latency;
+
+#ifdef PROFILE_SESSION_STATS
+    uxrStreamStats stats; // see `uxr_get_stream_stats`
+#endif
+
 } uxrOutputReliableStream;
 
 #ifdef __cplusplus
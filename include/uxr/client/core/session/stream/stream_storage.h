@@ -27,16 +27,51 @@ extern "C"
 #include <uxr/client/core/session/stream/stream_id.h>
 #include <uxr/client/config.h>
 
+/*
+ * Caller-provided stream arrays, of any length up to 127 streams of each kind.
+ * A NULL array keeps the one embedded in the session, sized by the `CONFIG_MAX_*_STREAMS` variables.
+ * A variable set to 0 embeds no array of that kind, so the kinds always given here cost nothing in the session.
+ */
+typedef struct uxrStreamArrays
+{
+    uxrOutputBestEffortStream* output_best_effort;
+    uint8_t output_best_effort_capacity;
+    uxrOutputReliableStream* output_reliable;
+    uint8_t output_reliable_capacity;
+    uxrInputBestEffortStream* input_best_effort;
+    uint8_t input_best_effort_capacity;
+    uxrInputReliableStream* input_reliable;
+    uint8_t input_reliable_capacity;
+
+} uxrStreamArrays;
+
 typedef struct uxrStreamStorage
 {
-    uxrOutputBestEffortStream output_best_effort[UXR_CONFIG_MAX_OUTPUT_BEST_EFFORT_STREAMS];
+    uxrOutputBestEffortStream* output_best_effort;
     uint8_t output_best_effort_size;
-    uxrOutputReliableStream output_reliable[UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS];
+    uint8_t output_best_effort_capacity;
+    uxrOutputReliableStream* output_reliable;
     uint8_t output_reliable_size;
-    uxrInputBestEffortStream input_best_effort[UXR_CONFIG_MAX_INPUT_BEST_EFFORT_STREAMS];
+    uint8_t output_reliable_capacity;
+    uxrInputBestEffortStream* input_best_effort;
     uint8_t input_best_effort_size;
-    uxrInputReliableStream input_reliable[UXR_CONFIG_MAX_INPUT_RELIABLE_STREAMS];
+    uint8_t input_best_effort_capacity;
+    uxrInputReliableStream* input_reliable;
     uint8_t input_reliable_size;
+    uint8_t input_reliable_capacity;
+
+#if 0 < UXR_CONFIG_MAX_OUTPUT_BEST_EFFORT_STREAMS
+    uxrOutputBestEffortStream default_output_best_effort[UXR_CONFIG_MAX_OUTPUT_BEST_EFFORT_STREAMS];
+#endif
+#if 0 < UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS
+    uxrOutputReliableStream default_output_reliable[UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS];
+#endif
+#if 0 < UXR_CONFIG_MAX_INPUT_BEST_EFFORT_STREAMS
+    uxrInputBestEffortStream default_input_best_effort[UXR_CONFIG_MAX_INPUT_BEST_EFFORT_STREAMS];
+#endif
+#if 0 < UXR_CONFIG_MAX_INPUT_RELIABLE_STREAMS
+    uxrInputReliableStream default_input_reliable[UXR_CONFIG_MAX_INPUT_RELIABLE_STREAMS];
+#endif
 
 } uxrStreamStorage;
 
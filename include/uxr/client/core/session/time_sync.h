@@ -0,0 +1,62 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _UXR_CLIENT_CORE_SESSION_TIME_SYNC_H_
+#define _UXR_CLIENT_CORE_SESSION_TIME_SYNC_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <uxr/client/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct uxrTimeSyncSample
+{
+    int64_t timestamp; // local nanoseconds
+    int64_t offset;    // nanoseconds
+    int64_t delay;     // nanoseconds
+
+} uxrTimeSyncSample;
+
+typedef struct uxrTimeSync
+{
+    uxrTimeSyncSample samples[UXR_CONFIG_TIME_SYNC_SAMPLES];
+    uint8_t sample_count;
+    uint8_t request_count;
+    bool active;
+
+    uxrTimeSyncSample points[UXR_CONFIG_TIME_SYNC_HISTORY];
+    uint8_t point_count;
+    uint8_t last_point;
+
+    int64_t offset;
+    int64_t reference;
+    double skew;
+
+    int64_t period;
+    int64_t next_request;
+    int64_t request_timestamp;
+    int64_t request_sent;
+
+} uxrTimeSync;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _UXR_CLIENT_CORE_SESSION_TIME_SYNC_H_
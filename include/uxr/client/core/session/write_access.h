@@ -41,6 +41,28 @@ UXRDLLAPI bool uxr_prepare_output_stream(
         struct ucdrBuffer* ub_topic,
         uint32_t topic_size);
 
+/**
+ * @brief Buffers into the reliable stream identified by `stream_id` an XRCE WRITE_DATA submessage larger than its history.
+ *        The submessage is fragmented while it is serialized: each time the history is full,
+ *        `flush_callback` is called to send the written fragments and wait for their acknowledgement,
+ *        for example through `uxr_run_session_until_confirm_delivery`.
+ *        The serialization of the topic fails if the callback does not free any slot of the history.
+ * @param session           A uxrSession structure previously initialized.
+ * @param stream_id         The output reliable stream identifier where the WRITE_DATA submessage will be buffered.
+ * @param datawriter_id     The identifier of the XRCE DataWriter that will write the topic into the DDS GDS.
+ * @param ub_topic          The ucdrBuffer structure used for serializing the topic.
+ * @param topic_size        The size of the topic in bytes.
+ * @param flush_callback    The function called when the history is full, returning false on failure.
+ * @return `true` if the first fragment could be buffered, `false` otherwise.
+ */
+UXRDLLAPI bool uxr_prepare_output_stream_fragmented(
+        uxrSession* session,
+        uxrStreamId stream_id,
+        uxrObjectId datawriter_id,
+        struct ucdrBuffer* ub_topic,
+        size_t topic_size,
+        uxrOnBuffersFull flush_callback);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,85 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef UXR_CLIENT_PROFILE_CAPTURE_MESSAGE_CAPTURE_H_
+#define UXR_CLIENT_PROFILE_CAPTURE_MESSAGE_CAPTURE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <uxr/client/core/session/session.h>
+#include <uxr/client/visibility.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Link type of the captured packets (LINKTYPE_USER0): raw XRCE messages, without transport headers. */
+#define UXR_CAPTURE_LINKTYPE 147
+
+/* Flags of the Enhanced Packet Blocks, as defined by pcapng. */
+#define UXR_CAPTURE_INBOUND  0x01
+#define UXR_CAPTURE_OUTBOUND 0x02
+
+typedef struct uxrMessageCapture
+{
+    uint8_t* buffer;
+    size_t size;
+    size_t head;
+    size_t tail;
+    uint32_t dropped;
+
+    int fd;
+    pthread_t writer;
+    bool running;
+
+} uxrMessageCapture;
+
+/**
+ * @brief Starts capturing the messages sent and received by a session into a pcapng file.
+ *        The messages are copied with their timestamp and direction into a lock-free ring,
+ *        and a writer thread drains the ring into the file, so the session never blocks on the disk.
+ *        Messages that do not fit in the ring are dropped and counted in `dropped`.
+ * @param capture   The uninitialized structure used for managing the capture.
+ * @param session   A uxrSession structure previously initialized. Its message callback is replaced.
+ * @param path      The path of the pcapng file. It is truncated if it exists.
+ * @param buffer    The memory block used as ring between the session and the writer thread.
+ * @param size      The buffer size. This value shall be power of 2.
+ * @return `true` in case of successful start. `false` in other case.
+ */
+UXRDLLAPI bool uxr_start_message_capture(
+        uxrMessageCapture* capture,
+        uxrSession* session,
+        const char* path,
+        uint8_t* buffer,
+        size_t size);
+
+/**
+ * @brief Stops a capture, writing the pending messages and closing the file.
+ * @param capture   The capture structure.
+ * @param session   The session being captured. Its message callback is removed.
+ * @return `true` in case of successful stop. `false` in other case.
+ */
+UXRDLLAPI bool uxr_stop_message_capture(
+        uxrMessageCapture* capture,
+        uxrSession* session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UXR_CLIENT_PROFILE_CAPTURE_MESSAGE_CAPTURE_H_
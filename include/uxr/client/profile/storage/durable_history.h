@@ -0,0 +1,70 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef UXR_CLIENT_PROFILE_STORAGE_DURABLE_HISTORY_H_
+#define UXR_CLIENT_PROFILE_STORAGE_DURABLE_HISTORY_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <uxr/client/visibility.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct uxrDurableHistory
+{
+    uint8_t* memory;
+    size_t size;
+    int fd;
+
+} uxrDurableHistory;
+
+/**
+ * @brief Opens a memory-mapped file to be used as the memory of a durable output stream.
+ *        The file is created if it does not exist, and its content is kept if it already has the requested size.
+ * @param durable   The uninitialized structure used for managing the durable history.
+ * @param path      The path of the backing file.
+ * @param size      The size of the memory, including `UXR_DURABLE_STREAM_OVERHEAD` bytes.
+ * @return `true` in case of successful opening. `false` in other case.
+ */
+UXRDLLAPI bool uxr_open_durable_history(
+        uxrDurableHistory* durable,
+        const char* path,
+        size_t size);
+
+/**
+ * @brief Flushes the durable history to the backing file.
+ *        The content already survives a process crash without this call,
+ *        but it is required to survive a power loss.
+ * @param durable   The durable history structure.
+ * @return `true` in case of successful flushing. `false` in other case.
+ */
+UXRDLLAPI bool uxr_sync_durable_history(uxrDurableHistory* durable);
+
+/**
+ * @brief Unmaps and closes a durable history.
+ * @param durable   The durable history structure.
+ * @return `true` in case of successful closing. `false` in other case.
+ */
+UXRDLLAPI bool uxr_close_durable_history(uxrDurableHistory* durable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UXR_CLIENT_PROFILE_STORAGE_DURABLE_HISTORY_H_
@@ -49,6 +49,20 @@ UXRDLLAPI bool uxr_init_udp_transport(
         const char* ip,
         uint16_t port);
 
+/**
+ * @brief Enables the kernel timestamping of the messages sent and received by a UDP transport.
+ *        The timestamps are used by the session for the time synchronization,
+ *        and are available through `uxr_message_timestamp`.
+ *        Only supported on Linux.
+ * @param transport The transport structure previously initialized.
+ * @param hardware  Whether the NIC timestamps are used when available, instead of the software ones.
+ *                  The NIC clock shall be synchronized with the system clock (e.g. by phc2sys).
+ * @return `true` in case of timestamping enabled. `false` in other case.
+ */
+UXRDLLAPI bool uxr_enable_udp_timestamping(
+        uxrUDPTransport* transport,
+        bool hardware);
+
 /**
  * @brief Closes a UDP transport.
  * @param transport The transport structure.
@@ -23,11 +23,15 @@ extern "C"
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <poll.h>
+#include <stdint.h>
 
 typedef struct uxrUDPPlatform
 {
     struct sockaddr remote_addr;
     struct pollfd poll_fd;
+    uint8_t timestamping;
+    int64_t sent_timestamp;
+    int64_t received_timestamp;
 
 } uxrUDPPlatform;
 
@@ -0,0 +1,67 @@
+// Copyright 2017 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef UXR_CLIENT_UTIL_HISTOGRAM_H_
+#define UXR_CLIENT_UTIL_HISTOGRAM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <uxr/client/visibility.h>
+#include <stdint.h>
+
+/*
+ * Log-linear histogram of 32-bit values: each power of two is divided in 2^UXR_HISTOGRAM_SUB_BUCKET_BITS buckets,
+ * so the values are recorded with a relative error below 1 / 2^UXR_HISTOGRAM_SUB_BUCKET_BITS.
+ */
+#define UXR_HISTOGRAM_SUB_BUCKET_BITS   3
+#define UXR_HISTOGRAM_SIZE              ((32 - UXR_HISTOGRAM_SUB_BUCKET_BITS + 1) << UXR_HISTOGRAM_SUB_BUCKET_BITS)
+
+typedef struct uxrHistogram
+{
+    uint32_t counts[UXR_HISTOGRAM_SIZE];
+    uint32_t total;
+    uint32_t min;
+    uint32_t max;
+
+} uxrHistogram;
+
+/**
+ * @brief Sets to zero all the buckets of a histogram.
+ * @param histogram The histogram.
+ */
+UXRDLLAPI void uxr_reset_histogram(uxrHistogram* histogram);
+
+/**
+ * @brief Records a value in a histogram.
+ * @param histogram The histogram.
+ * @param value     The value to record.
+ */
+UXRDLLAPI void uxr_record_histogram_value(uxrHistogram* histogram, uint32_t value);
+
+/**
+ * @brief Returns the value below which a given percentage of the recorded values fall.
+ * @param histogram     The histogram.
+ * @param percentile    The percentage, between 0 and 100.
+ * @return The highest value of the bucket of the percentile, or 0 if the histogram is empty.
+ */
+UXRDLLAPI uint32_t uxr_histogram_percentile(const uxrHistogram* histogram, double percentile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UXR_CLIENT_UTIL_HISTOGRAM_H_
@@ -0,0 +1,71 @@
+// Copyright 2017 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef UXR_CLIENT_UTIL_TOKEN_BUCKET_H_
+#define UXR_CLIENT_UTIL_TOKEN_BUCKET_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <uxr/client/visibility.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Token bucket shaping a flow of bytes to `rate` bytes per second, with bursts up to `burst` bytes.
+ * The tokens are kept in thousandths of byte, so slow rates refill precisely on every millisecond.
+ */
+typedef struct uxrTokenBucket
+{
+    uint32_t rate;
+    uint32_t burst;
+    int64_t tokens;     // thousandths of byte, negative while paying for a message larger than the available tokens
+    int64_t timestamp;  // milliseconds of the last refill
+
+} uxrTokenBucket;
+
+/**
+ * @brief Initializes a token bucket, full.
+ * @param bucket    The token bucket.
+ * @param rate      The bytes per second allowed. 0 does not limit the flow.
+ * @param burst     The bytes that can be sent at once. Larger messages wait for a full bucket.
+ */
+UXRDLLAPI void uxr_init_token_bucket(uxrTokenBucket* bucket, uint32_t rate, uint32_t burst);
+
+/**
+ * @brief Returns the time to wait until a message could be sent.
+ * @param bucket    The token bucket.
+ * @param size      The size of the message.
+ * @param timestamp The current time in milliseconds.
+ * @return The milliseconds to wait, 0 if the message can be sent now.
+ */
+UXRDLLAPI int64_t uxr_token_bucket_delay(uxrTokenBucket* bucket, size_t size, int64_t timestamp);
+
+/**
+ * @brief Takes the tokens of a message sent, even if there were not enough of them.
+ * @param bucket    The token bucket.
+ * @param size      The size of the message.
+ * @param timestamp The current time in milliseconds.
+ */
+UXRDLLAPI void uxr_take_tokens(uxrTokenBucket* bucket, size_t size, int64_t timestamp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UXR_CLIENT_UTIL_TOKEN_BUCKET_H_
@@ -87,13 +87,18 @@ static void print_acknack_submessage(const char* pre, const ACKNACK_Payload* pay
 static void print_heartbeat_submessage(const char* pre, const HEARTBEAT_Payload* payload);
 static void print_fragment_submessage(const char* pre, uint16_t size, uint8_t flags);
 static void print_header(size_t size, int direction, uint8_t stream_id, uint16_t seq_num, const uint8_t* client_key);
-static void print_tail(int64_t initial_log_time);
+static void print_tail(int64_t initial_log_time, int64_t millis);
 
 
 //==================================================================
 //                             PUBLIC
 //==================================================================
 void uxr_print_message(int direction, uint8_t* buffer, size_t size, const uint8_t* client_key)
+{
+    uxr_print_message_at(direction, buffer, size, client_key, uxr_millis());
+}
+
+void uxr_print_message_at(int direction, uint8_t* buffer, size_t size, const uint8_t* client_key, int64_t millis)
 {
     static int64_t initial_log_time = 0;
 
@@ -138,7 +143,7 @@ void uxr_print_message(int direction, uint8_t* buffer, size_t size, const uint8_
         {
             case SUBMESSAGE_ID_CREATE_CLIENT:
             {
-                initial_log_time = uxr_millis();
+                initial_log_time = millis;
                 CREATE_CLIENT_Payload payload;
                 uxr_deserialize_CREATE_CLIENT_Payload(&ub, &payload);
                 print_create_client_submessage(color, &payload);
@@ -264,7 +269,7 @@ void uxr_print_message(int direction, uint8_t* buffer, size_t size, const uint8_
         submessage_counter++;
     }
 tail:
-    print_tail(initial_log_time);
+    print_tail(initial_log_time, millis);
     printf(" \n");
 }
 
@@ -649,9 +654,9 @@ void print_header(size_t size, int direction, uint8_t stream_id, uint16_t seq_nu
             RESTORE_COLOR);
 }
 
-void print_tail(int64_t initial_log_time)
+void print_tail(int64_t initial_log_time, int64_t millis)
 {
-    int64_t ms = uxr_millis() - initial_log_time;
+    int64_t ms = millis - initial_log_time;
 #ifdef WIN32
     printf(" %st: %I64ims%s", BLUE, ms, RESTORE_COLOR);
 #else
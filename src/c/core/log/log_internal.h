@@ -41,6 +41,7 @@ extern "C"
 #endif
 
 void uxr_print_message(int direction, uint8_t* buffer, size_t size, const uint8_t* client_key);
+void uxr_print_message_at(int direction, uint8_t* buffer, size_t size, const uint8_t* client_key, int64_t millis);
 void uxr_print_serialization(int direction, const uint8_t* buffer, size_t size);
 
 #if defined(UXR_MESSAGE_LOGS) || defined(UXR_SERIALIZATION_LOGS)
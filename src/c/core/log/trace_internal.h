@@ -0,0 +1,41 @@
+// Copyright 2017 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _SRC_C_CORE_LOG_TRACE_INTERNAL_H_
+#define _SRC_C_CORE_LOG_TRACE_INTERNAL_H_
+
+/*
+ * Static tracepoints of the "uxr" provider (USDT), available with UCLIENT_TRACEPOINTS.
+ * Each probe compiles to a nop, so they could be kept in production binaries and attached with bpftrace or perf:
+ *
+ *   message_send(buffer, length, sent)
+ *   message_recv(buffer, length)
+ *   submessage_read(stream_id, submessage_id, length, flags)
+ *   heartbeat_send(stream_id, first_unacked, last_unacked)
+ *   acknack_send(stream_id, first_unacked, nack_bitmap)
+ *   output_window(stream_id, last_acknown, last_sent, last_written)
+ *   input_window(stream_id, last_handled, last_announced)
+ */
+#ifdef UXR_TRACEPOINTS
+#include <sys/sdt.h>
+#define UXR_TRACE2(name, a, b)          DTRACE_PROBE2(uxr, name, a, b)
+#define UXR_TRACE3(name, a, b, c)       DTRACE_PROBE3(uxr, name, a, b, c)
+#define UXR_TRACE4(name, a, b, c, d)    DTRACE_PROBE4(uxr, name, a, b, c, d)
+#else
+#define UXR_TRACE2(name, a, b)          do {} while(0)
+#define UXR_TRACE3(name, a, b, c)       do {} while(0)
+#define UXR_TRACE4(name, a, b, c, d)    do {} while(0)
+#endif
+
+#endif // _SRC_C_CORE_LOG_TRACE_INTERNAL_H_
@@ -1,6 +1,14 @@
 #include "xrce_protocol_internal.h"
 #include <string.h>
 
+#define BASE_OBJECT_REQUEST_SIZE    4
+#define STATUS_PAYLOAD_SIZE         6
+#define ACKNACK_PAYLOAD_SIZE        5
+#define HEARTBEAT_PAYLOAD_SIZE      5
+
+static bool ready_to_read(ucdrBuffer* buffer, size_t size);
+static uint16_t read_uint16(const ucdrBuffer* buffer, const uint8_t* data);
+
 //==================================================================
 //                             PUBLIC
 //==================================================================
@@ -2158,6 +2166,61 @@ bool uxr_deserialize_TIMESTAMP_REPLY_Payload(ucdrBuffer* buffer, TIMESTAMP_REPLY
     return ret;
 }
 
+bool uxr_read_BaseObjectRequest(ucdrBuffer* buffer, BaseObjectRequest* output)
+{
+    bool ret = ready_to_read(buffer, BASE_OBJECT_REQUEST_SIZE);
+    if(ret)
+    {
+        memcpy(output->request_id.data, buffer->iterator, 2);
+        memcpy(output->object_id.data, buffer->iterator + 2, 2);
+        buffer->iterator += BASE_OBJECT_REQUEST_SIZE;
+        buffer->last_data_size = sizeof(uint8_t);
+    }
+    return ret;
+}
+
+bool uxr_read_STATUS_Payload(ucdrBuffer* buffer, STATUS_Payload* output)
+{
+    bool ret = ready_to_read(buffer, STATUS_PAYLOAD_SIZE);
+    if(ret)
+    {
+        (void) uxr_read_BaseObjectRequest(buffer, &output->base.related_request);
+        output->base.result.status = buffer->iterator[0];
+        output->base.result.implementation_status = buffer->iterator[1];
+        buffer->iterator += STATUS_PAYLOAD_SIZE - BASE_OBJECT_REQUEST_SIZE;
+    }
+    return ret;
+}
+
+bool uxr_read_ACKNACK_Payload(ucdrBuffer* buffer, ACKNACK_Payload* output)
+{
+    bool ret = ready_to_read(buffer, ACKNACK_PAYLOAD_SIZE);
+    if(ret)
+    {
+        output->first_unacked_seq_num = read_uint16(buffer, buffer->iterator);
+        output->nack_bitmap[0] = buffer->iterator[2];
+        output->nack_bitmap[1] = buffer->iterator[3];
+        output->stream_id = buffer->iterator[4];
+        buffer->iterator += ACKNACK_PAYLOAD_SIZE;
+        buffer->last_data_size = sizeof(uint8_t);
+    }
+    return ret;
+}
+
+bool uxr_read_HEARTBEAT_Payload(ucdrBuffer* buffer, HEARTBEAT_Payload* output)
+{
+    bool ret = ready_to_read(buffer, HEARTBEAT_PAYLOAD_SIZE);
+    if(ret)
+    {
+        output->first_unacked_seq_nr = read_uint16(buffer, buffer->iterator);
+        output->last_unacked_seq_nr = read_uint16(buffer, buffer->iterator + 2);
+        output->stream_id = buffer->iterator[4];
+        buffer->iterator += HEARTBEAT_PAYLOAD_SIZE;
+        buffer->last_data_size = sizeof(uint8_t);
+    }
+    return ret;
+}
+
 #ifdef PERFORMANCE_TESTING
 bool uxr_serialize_PERFORMANCE_Payload(ucdrBuffer* buffer, const PERFORMANCE_Payload* input)
 {
@@ -2177,3 +2240,23 @@ bool uxr_deserialize_PERFORMANCE_Payload(ucdrBuffer* buffer, PERFORMANCE_Payload
     return ret;
 }
 #endif
+
+//==================================================================
+//                             PRIVATE
+//==================================================================
+bool ready_to_read(ucdrBuffer* buffer, size_t size)
+{
+    bool ready = !buffer->error && ucdr_buffer_remaining(buffer) >= size;
+    if(!ready)
+    {
+        buffer->error = true;
+    }
+    return ready;
+}
+
+uint16_t read_uint16(const ucdrBuffer* buffer, const uint8_t* data)
+{
+    return (UCDR_BIG_ENDIANNESS == buffer->endianness)
+        ? (uint16_t)((data[0] << 8) | data[1])
+        : (uint16_t)(data[0] | (data[1] << 8));
+}
@@ -1289,6 +1289,13 @@ bool uxr_deserialize_TIMESTAMP_Payload(ucdrBuffer* buffer, TIMESTAMP_Payload* ou
 bool uxr_serialize_TIMESTAMP_REPLY_Payload(ucdrBuffer* buffer, const TIMESTAMP_REPLY_Payload* input);
 bool uxr_deserialize_TIMESTAMP_REPLY_Payload(ucdrBuffer* buffer, TIMESTAMP_REPLY_Payload* output);
 
+/* Fixed-size decoders of the control submessages: one length check, then the fields are loaded in place.
+ * Equivalent to the uxr_deserialize_* functions for a payload starting at a 4 bytes aligned position. */
+bool uxr_read_BaseObjectRequest(ucdrBuffer* buffer, BaseObjectRequest* output);
+bool uxr_read_STATUS_Payload(ucdrBuffer* buffer, STATUS_Payload* output);
+bool uxr_read_ACKNACK_Payload(ucdrBuffer* buffer, ACKNACK_Payload* output);
+bool uxr_read_HEARTBEAT_Payload(ucdrBuffer* buffer, HEARTBEAT_Payload* output);
+
 #ifdef PERFORMANCE_TESTING
 bool uxr_serialize_PERFORMANCE_Payload(ucdrBuffer* buffer, const PERFORMANCE_Payload* input);
 bool uxr_deserialize_PERFORMANCE_Payload(ucdrBuffer* buffer, PERFORMANCE_Payload* input);
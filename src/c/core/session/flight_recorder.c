@@ -0,0 +1,141 @@
+#include "flight_recorder_internal.h"
+
+#include <uxr/client/util/time.h>
+
+#if defined(PLATFORM_NAME_LINUX) || defined(PLATFORM_NAME_NUTTX)
+#include <unistd.h>
+#endif
+
+#define EVENT_LINE_SIZE 96
+
+static size_t format_event(const uxrFlightEvent* event, char* line);
+static size_t append_string(char* line, size_t pos, const char* string);
+static size_t append_number(char* line, size_t pos, uint64_t number, unsigned base);
+
+//==================================================================
+//                             PUBLIC
+//==================================================================
+void uxr_init_flight_recorder(uxrFlightRecorder* recorder)
+{
+    recorder->count = 0;
+}
+
+void uxr_record_flight_event(uxrFlightRecorder* recorder, uint8_t type, uint8_t stream_id, uxrSeqNum seq_num, uint16_t value, uint16_t extra)
+{
+    /* The oldest events are overwritten, so only the recent history is kept. */
+    uxrFlightEvent* event = &recorder->events[recorder->count % UXR_CONFIG_FLIGHT_RECORDER_EVENTS];
+    event->timestamp = uxr_nanos();
+    event->type = type;
+    event->stream_id = stream_id;
+    event->seq_num = seq_num;
+    event->value = value;
+    event->extra = extra;
+    recorder->count++;
+}
+
+size_t uxr_read_flight_events(const uxrFlightRecorder* recorder, uxrFlightEvent* events, size_t capacity)
+{
+    size_t available = (UXR_CONFIG_FLIGHT_RECORDER_EVENTS < recorder->count) ? UXR_CONFIG_FLIGHT_RECORDER_EVENTS : recorder->count;
+    size_t read = (capacity < available) ? capacity : available;
+
+    /* The most recent events are returned, from the oldest to the newest. */
+    uint32_t first = recorder->count - (uint32_t)read;
+    for(size_t i = 0; i < read; ++i)
+    {
+        events[i] = recorder->events[(first + i) % UXR_CONFIG_FLIGHT_RECORDER_EVENTS];
+    }
+
+    return read;
+}
+
+bool uxr_write_flight_events(const uxrFlightRecorder* recorder, int fd)
+{
+    bool rv = false;
+#if defined(PLATFORM_NAME_LINUX) || defined(PLATFORM_NAME_NUTTX)
+    /* Only async-signal-safe calls are used, so it can be called from a signal handler. */
+    size_t available = (UXR_CONFIG_FLIGHT_RECORDER_EVENTS < recorder->count) ? UXR_CONFIG_FLIGHT_RECORDER_EVENTS : recorder->count;
+    uint32_t first = recorder->count - (uint32_t)available;
+
+    rv = true;
+    for(size_t i = 0; i < available && rv; ++i)
+    {
+        char line[EVENT_LINE_SIZE];
+        size_t length = format_event(&recorder->events[(first + i) % UXR_CONFIG_FLIGHT_RECORDER_EVENTS], line);
+        rv = (ssize_t)length == write(fd, line, length);
+    }
+#else
+    (void) recorder;
+    (void) fd;
+#endif
+    return rv;
+}
+
+//==================================================================
+//                             PRIVATE
+//==================================================================
+size_t format_event(const uxrFlightEvent* event, char* line)
+{
+    const char* name;
+    switch(event->type)
+    {
+        case UXR_EVENT_HEARTBEAT_SENT:
+            name = " HEARTBEAT_SENT";
+            break;
+        case UXR_EVENT_ACKNACK_RECEIVED:
+            name = " ACKNACK_RECEIVED";
+            break;
+        case UXR_EVENT_SEND_LOST:
+            name = " SEND_LOST";
+            break;
+        case UXR_EVENT_PREPARE_FAILED:
+            name = " PREPARE_FAILED";
+            break;
+        case UXR_EVENT_FRAGMENTS_COMPLETED:
+            name = " FRAGMENTS_COMPLETED";
+            break;
+        default:
+            name = " UNKNOWN";
+            break;
+    }
+
+    size_t pos = append_number(line, 0, (uint64_t)event->timestamp, 10);
+    pos = append_string(line, pos, name);
+    pos = append_string(line, pos, " stream: 0x");
+    pos = append_number(line, pos, event->stream_id, 16);
+    pos = append_string(line, pos, " seq: ");
+    pos = append_number(line, pos, event->seq_num, 10);
+    pos = append_string(line, pos, " value: 0x");
+    pos = append_number(line, pos, event->value, 16);
+    pos = append_string(line, pos, " extra: ");
+    pos = append_number(line, pos, event->extra, 10);
+    pos = append_string(line, pos, "\n");
+
+    return pos;
+}
+
+size_t append_string(char* line, size_t pos, const char* string)
+{
+    while('\0' != *string)
+    {
+        line[pos++] = *string++;
+    }
+    return pos;
+}
+
+size_t append_number(char* line, size_t pos, uint64_t number, unsigned base)
+{
+    char digits[20];
+    size_t count = 0;
+    do
+    {
+        digits[count++] = "0123456789ABCDEF"[number % base];
+        number /= base;
+    }
+    while(0 != number);
+
+    while(0 < count)
+    {
+        line[pos++] = digits[--count];
+    }
+    return pos;
+}
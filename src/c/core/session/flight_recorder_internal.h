@@ -0,0 +1,38 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _SRC_C_CORE_SESSION_FLIGHT_RECORDER_INTERNAL_H_
+#define _SRC_C_CORE_SESSION_FLIGHT_RECORDER_INTERNAL_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <uxr/client/core/session/flight_recorder.h>
+
+#include <stddef.h>
+#include <stdbool.h>
+
+void uxr_init_flight_recorder(uxrFlightRecorder* recorder);
+void uxr_record_flight_event(uxrFlightRecorder* recorder, uint8_t type, uint8_t stream_id, uxrSeqNum seq_num, uint16_t value, uint16_t extra);
+
+size_t uxr_read_flight_events(const uxrFlightRecorder* recorder, uxrFlightEvent* events, size_t capacity);
+bool uxr_write_flight_events(const uxrFlightRecorder* recorder, int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SRC_C_CORE_SESSION_FLIGHT_RECORDER_INTERNAL_H_
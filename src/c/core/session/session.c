@@ -6,6 +6,8 @@
 #include "submessage_internal.h"
 #include "session_internal.h"
 #include "session_info_internal.h"
+#include "time_sync_internal.h"
+#include "flight_recorder_internal.h"
 #include "stream/stream_storage_internal.h"
 #include "stream/common_reliable_stream_internal.h"
 #include "stream/input_best_effort_stream_internal.h"
@@ -15,25 +17,75 @@
 #include "stream/seq_num_internal.h"
 #include "../serialization/xrce_protocol_internal.h"
 #include "../log/log_internal.h"
+#include "../log/trace_internal.h"
 #include "../../util/time_internal.h"
 
+#include <string.h>
+
 #define CREATE_SESSION_MAX_MSG_SIZE (MAX_HEADER_SIZE + SUBHEADER_SIZE + CREATE_CLIENT_PAYLOAD_SIZE)
 #define DELETE_SESSION_MAX_MSG_SIZE (MAX_HEADER_SIZE + SUBHEADER_SIZE + DELETE_CLIENT_PAYLOAD_SIZE)
-#define HEARTBEAT_MAX_MSG_SIZE      (MAX_HEADER_SIZE + SUBHEADER_SIZE + HEARTBEAT_PAYLOAD_SIZE)
-#define ACKNACK_MAX_MSG_SIZE        (MAX_HEADER_SIZE + SUBHEADER_SIZE + ACKNACK_PAYLOAD_SIZE)
+#define CONTROL_SUBMESSAGE_SIZE     (SUBHEADER_SIZE + 8) // HEARTBEAT or ACKNACK, padded up to the next subheader
+#define CONTROL_MAX_MSG_SIZE        (MAX_HEADER_SIZE + CONTROL_MAX_SUBMESSAGES * CONTROL_SUBMESSAGE_SIZE)
+/* At least one, for the reliable streams of the caller-provided arrays when none is embedded. */
+#if 0 < UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS + UXR_CONFIG_MAX_INPUT_RELIABLE_STREAMS
+#define CONTROL_MAX_SUBMESSAGES     (UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS + UXR_CONFIG_MAX_INPUT_RELIABLE_STREAMS)
+#else
+#define CONTROL_MAX_SUBMESSAGES     1
+#endif
 #define TIMESTAMP_PAYLOAD_SIZE      8
 #define TIMESTAMP_MAX_MSG_SIZE      (MAX_HEADER_SIZE + SUBHEADER_SIZE + TIMESTAMP_PAYLOAD_SIZE)
 
+#ifdef PROFILE_SESSION_STATS
+#define UXR_SESSION_STATS_AVAILABLE 1
+#define UXR_STATS_INC(session, counter) ((session)->stats.counter++)
+#define UXR_STATS_ADD_MESSAGE(session, counter, length) \
+    do \
+    { \
+        (session)->stats.counter.messages++; \
+        (session)->stats.counter.bytes += (length); \
+    } while (0)
+#define UXR_STATS_ADD_STREAM_MESSAGE(stream, length) \
+    do \
+    { \
+        (stream)->stats.messages++; \
+        (stream)->stats.bytes += (length); \
+    } while (0)
+#else
+#define UXR_SESSION_STATS_AVAILABLE 0
+#define UXR_STATS_INC(session, counter) do {} while(0)
+#define UXR_STATS_ADD_MESSAGE(session, counter, length) do {} while(0)
+#define UXR_STATS_ADD_STREAM_MESSAGE(stream, length) do {} while(0)
+#endif
+
+#ifdef PROFILE_FLIGHT_RECORDER
+#define UXR_FLIGHT_EVENT(session, type, stream_id, seq_num, value, extra) \
+    uxr_record_flight_event(&(session)->flight_recorder, type, stream_id, seq_num, value, extra)
+#else
+#define UXR_FLIGHT_EVENT(session, type, stream_id, seq_num, value, extra) do {} while(0)
+#endif
+
 static bool listen_message(uxrSession* session, int poll_ms);
 static bool listen_message_reliably(uxrSession* session, int poll_ms);
 
 static bool wait_session_status(uxrSession* session, uint8_t* buffer, size_t length, size_t attempts);
 
-static bool send_message(const uxrSession* session, uint8_t* buffer, size_t length);
-static bool recv_message(const uxrSession* session, uint8_t** buffer, size_t* length, int poll_ms);
+static bool send_message(uxrSession* session, uint8_t* buffer, size_t length);
+static bool recv_message(uxrSession* session, uint8_t** buffer, size_t* length, int poll_ms);
 
-static void write_submessage_heartbeat(const uxrSession* session, uxrStreamId stream);
-static void write_submessage_acknack(const uxrSession* session, uxrStreamId stream);
+static void flash_output_streams(uxrSession* session, const uxrStreamId* bound);
+static bool next_output_stream(uxrSession* session, int64_t timestamp, uxrStreamId* stream_id, size_t* length);
+static bool is_shaped(uxrSession* session, uxrTokenBucket* shaper, size_t length, int64_t timestamp);
+static bool get_output_stream_schedule(uxrSession* session, uxrStreamId stream_id, uint8_t** priority, int64_t** deadline);
+static int compare_output_streams(uxrSession* session, uxrStreamId stream_id, uxrStreamId other_id);
+static void send_output_stream_buffer(uxrSession* session, uxrStreamId stream_id, int64_t timestamp);
+
+static void send_control_submessages(uxrSession* session);
+static size_t append_control_submessages(uxrSession* session, uint8_t* buffer, size_t length, size_t capacity);
+static bool write_control_submessages(uxrSession* session, ucdrBuffer* ub);
+static bool has_room_for_submessage(ucdrBuffer* ub, size_t payload_size);
+static void write_submessage_heartbeat(uxrSession* session, uxrStreamId stream, ucdrBuffer* ub);
+static void write_submessage_acknack(uxrSession* session, uxrStreamId stream, ucdrBuffer* ub);
+static void write_submessage_timestamp(uxrSession* session);
 
 static void read_message(uxrSession* session, ucdrBuffer* message);
 static void read_stream(uxrSession* session, ucdrBuffer* message, uxrStreamId id, uxrSeqNum seq_num);
@@ -41,23 +93,62 @@ static void read_submessage_list(uxrSession* session, ucdrBuffer* submessages, u
 static void read_submessage(uxrSession* session, ucdrBuffer* submessage,
                             uint8_t submessage_id, uxrStreamId stream_id, uint16_t length, uint8_t flags);
 
-static void read_submessage_status(uxrSession* session, ucdrBuffer* submessage);
-static void read_submessage_data(uxrSession* session, ucdrBuffer* submessage, uint16_t length, uxrStreamId stream_id, uint8_t format);
-static void read_submessage_heartbeat(uxrSession* session, ucdrBuffer* submessage);
-static void read_submessage_acknack(uxrSession* session, ucdrBuffer* submessage);
-static void read_submessage_timestamp_reply(uxrSession* session, ucdrBuffer* submessage);
+typedef void (*SubmessageReader)(uxrSession* session, ucdrBuffer* submessage,
+                                 uxrStreamId stream_id, uint16_t length, uint8_t flags);
+
+static void read_submessage_status_agent(uxrSession* session, ucdrBuffer* submessage,
+                                         uxrStreamId stream_id, uint16_t length, uint8_t flags);
+static void read_submessage_status(uxrSession* session, ucdrBuffer* submessage,
+                                   uxrStreamId stream_id, uint16_t length, uint8_t flags);
+static void read_submessage_data(uxrSession* session, ucdrBuffer* submessage,
+                                 uxrStreamId stream_id, uint16_t length, uint8_t flags);
+static void read_submessage_heartbeat(uxrSession* session, ucdrBuffer* submessage,
+                                      uxrStreamId stream_id, uint16_t length, uint8_t flags);
+static void read_submessage_acknack(uxrSession* session, ucdrBuffer* submessage,
+                                    uxrStreamId stream_id, uint16_t length, uint8_t flags);
+static void read_submessage_timestamp_reply(uxrSession* session, ucdrBuffer* submessage,
+                                            uxrStreamId stream_id, uint16_t length, uint8_t flags);
 #ifdef PERFORMANCE_TESTING
-static void read_submessage_performance(uxrSession* session, ucdrBuffer* submessage, uint16_t length);
+static void read_submessage_performance(uxrSession* session, ucdrBuffer* submessage,
+                                        uxrStreamId stream_id, uint16_t length, uint8_t flags);
 #endif
+static void skip_submessage(ucdrBuffer* submessage, uint16_t length);
 
 static void process_status(uxrSession* session, uxrObjectId object_id, uint16_t request_id, uint8_t status);
 static void process_timestamp_reply(uxrSession* session, TIMESTAMP_REPLY_Payload* timestamp);
 
 static void on_new_output_reliable_stream_segment(ucdrBuffer* ub, uxrOutputReliableStream* args);
+static bool on_full_output_reliable_history(uxrOutputReliableStream* stream, void* args);
 static FragmentationInfo on_get_fragmentation_info(uint8_t* submessage_header);
 
 static bool run_session_until_sync(uxrSession* session, int timeout);
 
+/* Indexed by submessage id, NULL for the submessages a Client does not receive. */
+#define SUBMESSAGE_READERS_SIZE (SUBMESSAGE_ID_TIMESTAMP_REPLY + 1)
+static const SubmessageReader submessage_readers[SUBMESSAGE_READERS_SIZE] =
+{
+    NULL,                               // SUBMESSAGE_ID_CREATE_CLIENT
+    NULL,                               // SUBMESSAGE_ID_CREATE
+    NULL,                               // SUBMESSAGE_ID_GET_INFO
+    NULL,                               // SUBMESSAGE_ID_DELETE
+    read_submessage_status_agent,       // SUBMESSAGE_ID_STATUS_AGENT
+    read_submessage_status,             // SUBMESSAGE_ID_STATUS
+    NULL,                               // SUBMESSAGE_ID_INFO
+    NULL,                               // SUBMESSAGE_ID_WRITE_DATA
+    NULL,                               // SUBMESSAGE_ID_READ_DATA
+    read_submessage_data,               // SUBMESSAGE_ID_DATA
+    read_submessage_acknack,            // SUBMESSAGE_ID_ACKNACK
+    read_submessage_heartbeat,          // SUBMESSAGE_ID_HEARTBEAT
+    NULL,                               // SUBMESSAGE_ID_RESET
+    NULL,                               // SUBMESSAGE_ID_FRAGMENT
+#ifdef PERFORMANCE_TESTING
+    read_submessage_performance,        // SUBMESSAGE_ID_PERFORMANCE
+#else
+    NULL,                               // SUBMESSAGE_ID_TIMESTAMP
+#endif
+    read_submessage_timestamp_reply     // SUBMESSAGE_ID_TIMESTAMP_REPLY
+};
+
 //==================================================================
 //                             PUBLIC
 //==================================================================
@@ -79,9 +170,30 @@ void uxr_init_session(uxrSession* session, uxrCommunication* comm, uint32_t key)
     session->on_time_args = NULL;
     session->time_offset = 0;
     session->synchronized = false;
+    uxr_init_time_sync(&session->time_sync);
+    session->on_message = NULL;
+    session->on_message_args = NULL;
+    session->on_buffers_full = NULL;
+    session->shaper = NULL;
+    session->next_flash = INT64_MAX;
+#ifdef PERFORMANCE_TESTING
+    session->on_performance = NULL;
+    session->on_performance_args = NULL;
+#endif
+#ifdef PROFILE_FLIGHT_RECORDER
+    uxr_init_flight_recorder(&session->flight_recorder);
+#endif
 
     uxr_init_session_info(&session->info, 0x81, key);
     uxr_init_stream_storage(&session->streams);
+#ifdef PROFILE_SESSION_STATS
+    uxr_reset_session_stats(session);
+#endif
+}
+
+void uxr_set_session_streams(uxrSession* session, const uxrStreamArrays* arrays)
+{
+    uxr_set_stream_storage_arrays(&session->streams, arrays);
 }
 
 void uxr_set_status_callback(uxrSession* session, uxrOnStatusFunc on_status_func, void* args)
@@ -102,6 +214,12 @@ void uxr_set_time_callback(uxrSession* session, uxrOnTimeFunc on_time_func, void
     session->on_time_args = args;
 }
 
+void uxr_set_message_callback(uxrSession* session, uxrOnMessageFunc on_message_func, void* args)
+{
+    session->on_message = on_message_func;
+    session->on_message_args = args;
+}
+
 #ifdef PERFORMANCE_TESTING
 void uxr_set_performance_callback(uxrSession* session, uxrOnPerformanceFunc on_echo_func, void* args)
 {
@@ -151,6 +269,18 @@ uxrStreamId uxr_create_output_reliable_stream(uxrSession* session, uint8_t* buff
     return uxr_add_output_reliable_buffer(&session->streams, buffer, size, history, header_offset, on_new_output_reliable_stream_segment);
 }
 
+uxrStreamId uxr_create_output_durable_stream(uxrSession* session, uint8_t* memory, size_t size, uint16_t history)
+{
+    uint8_t header_offset = uxr_session_header_offset(&session->info);
+    return uxr_add_output_durable_buffer(&session->streams, memory, size, history, header_offset, on_new_output_reliable_stream_segment);
+}
+
+uxrStreamId uxr_create_output_packed_stream(uxrSession* session, uint8_t* memory, size_t size, uint16_t history, size_t mtu)
+{
+    uint8_t header_offset = uxr_session_header_offset(&session->info);
+    return uxr_add_output_packed_buffer(&session->streams, memory, size, history, mtu, header_offset, on_new_output_reliable_stream_segment);
+}
+
 uxrStreamId uxr_create_input_best_effort_stream(uxrSession* session)
 {
     return uxr_add_input_best_effort_buffer(&session->streams);
@@ -263,30 +393,226 @@ bool uxr_run_session_until_one_status(uxrSession* session, int timeout_ms, const
 
 bool uxr_sync_session(uxrSession* session, int time)
 {
-    uint8_t timestamp_buffer[TIMESTAMP_MAX_MSG_SIZE];
-    ucdrBuffer ub;
-    ucdr_init_buffer_offset(&ub, timestamp_buffer, sizeof(timestamp_buffer), uxr_session_header_offset(&session->info));
-    uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_TIMESTAMP, TIMESTAMP_PAYLOAD_SIZE, 0);
-
-    TIMESTAMP_Payload timestamp;
-    int64_t nanos = uxr_nanos();
-    timestamp.transmit_timestamp.seconds = (int32_t)(nanos / 1000000000);
-    timestamp.transmit_timestamp.nanoseconds = (uint32_t)(nanos % 1000000000);
-    (void) uxr_serialize_TIMESTAMP_Payload(&ub, &timestamp);
-
-    uxr_stamp_session_header(&session->info, 0, 0, ub.init);
-    send_message(session, timestamp_buffer, ucdr_buffer_length(&ub));
+    if(NULL != session->on_time)
+    {
+        write_submessage_timestamp(session);
+    }
+    else
+    {
+        /* The requests of the burst are sent while the session is listening. */
+        uxr_start_time_sync(&session->time_sync, uxr_millis());
+    }
     return run_session_until_sync(session, time);
 }
 
+void uxr_set_time_sync_period(uxrSession* session, int64_t period)
+{
+    uxr_schedule_time_sync(&session->time_sync, period, uxr_millis());
+}
+
 int64_t uxr_epoch_millis(uxrSession* session)
 {
     return uxr_epoch_nanos(session) / 1000000;
 }
 
+bool uxr_set_output_stream_priority(uxrSession* session, uxrStreamId stream_id, uint8_t priority)
+{
+    uint8_t* stream_priority; int64_t* stream_deadline;
+    bool rv = get_output_stream_schedule(session, stream_id, &stream_priority, &stream_deadline);
+    if(rv)
+    {
+        *stream_priority = priority;
+    }
+    return rv;
+}
+
+bool uxr_set_output_stream_deadline(uxrSession* session, uxrStreamId stream_id, int64_t deadline)
+{
+    uint8_t* stream_priority; int64_t* stream_deadline;
+    bool rv = get_output_stream_schedule(session, stream_id, &stream_priority, &stream_deadline);
+    if(rv && deadline < *stream_deadline)
+    {
+        *stream_deadline = deadline;
+    }
+    return rv;
+}
+
+void uxr_set_session_shaper(uxrSession* session, uxrTokenBucket* shaper)
+{
+    session->shaper = shaper;
+}
+
+bool uxr_set_output_stream_shaper(uxrSession* session, uxrStreamId stream_id, uxrTokenBucket* shaper)
+{
+    bool rv = false;
+    if(UXR_OUTPUT_STREAM == stream_id.direction)
+    {
+        if(UXR_BEST_EFFORT_STREAM == stream_id.type)
+        {
+            uxrOutputBestEffortStream* stream = uxr_get_output_best_effort_stream(&session->streams, stream_id.index);
+            if(stream)
+            {
+                stream->shaper = shaper;
+                rv = true;
+            }
+        }
+        else if(UXR_RELIABLE_STREAM == stream_id.type)
+        {
+            uxrOutputReliableStream* stream = uxr_get_output_reliable_stream(&session->streams, stream_id.index);
+            if(stream)
+            {
+                stream->shaper = shaper;
+                rv = true;
+            }
+        }
+    }
+    return rv;
+}
+
+bool uxr_set_output_stream_congestion_control(uxrSession* session, uxrStreamId stream_id, bool enable)
+{
+    bool rv = false;
+    uxrOutputReliableStream* stream = (UXR_RELIABLE_STREAM == stream_id.type && UXR_OUTPUT_STREAM == stream_id.direction)
+                                      ? uxr_get_output_reliable_stream(&session->streams, stream_id.index)
+                                      : NULL;
+    if(stream)
+    {
+        uxr_set_output_reliable_stream_congestion_control(stream, enable);
+        rv = true;
+    }
+    return rv;
+}
+
+bool uxr_set_output_stream_latency(uxrSession* session, uxrStreamId stream_id, uxrOutputReliableStreamLatency* latency, uxrReliableSlotTiming* slots, uint16_t slots_size)
+{
+    bool rv = false;
+    uxrOutputReliableStream* stream = (UXR_RELIABLE_STREAM == stream_id.type && UXR_OUTPUT_STREAM == stream_id.direction)
+                                      ? uxr_get_output_reliable_stream(&session->streams, stream_id.index)
+                                      : NULL;
+    if(stream && (NULL == latency || stream->history <= slots_size))
+    {
+        uxr_set_output_reliable_stream_latency(stream, latency, slots);
+        rv = true;
+    }
+    return rv;
+}
+
+const uxrOutputReliableStreamLatency* uxr_get_output_stream_latency(const uxrSession* session, uxrStreamId stream_id)
+{
+    const uxrOutputReliableStreamLatency* latency = NULL;
+    if(UXR_RELIABLE_STREAM == stream_id.type && UXR_OUTPUT_STREAM == stream_id.direction
+       && stream_id.index < session->streams.output_reliable_size)
+    {
+        latency = session->streams.output_reliable[stream_id.index].latency;
+    }
+    return latency;
+}
+
+bool uxr_set_input_stream_acknack_delay(uxrSession* session, uxrStreamId stream_id, uint16_t messages, int64_t delay)
+{
+    bool rv = false;
+    uxrInputReliableStream* stream = (UXR_RELIABLE_STREAM == stream_id.type && UXR_INPUT_STREAM == stream_id.direction)
+                                     ? uxr_get_input_reliable_stream(&session->streams, stream_id.index)
+                                     : NULL;
+    if(stream)
+    {
+        uxr_set_input_reliable_stream_acknack_delay(stream, messages, delay);
+        rv = true;
+    }
+    return rv;
+}
+
+bool uxr_set_input_stream_reassembly(uxrSession* session, uxrStreamId stream_id, uint8_t* buffer, size_t size)
+{
+    bool rv = false;
+    uxrInputReliableStream* stream = (UXR_RELIABLE_STREAM == stream_id.type && UXR_INPUT_STREAM == stream_id.direction)
+                                     ? uxr_get_input_reliable_stream(&session->streams, stream_id.index)
+                                     : NULL;
+    if(stream)
+    {
+        uxr_set_input_reliable_stream_reassembly(stream, buffer, size, SUBHEADER_SIZE);
+        rv = true;
+    }
+    return rv;
+}
+
+#ifdef PROFILE_SESSION_STATS
+void uxr_get_session_stats(const uxrSession* session, uxrSessionStats* stats)
+{
+    *stats = session->stats;
+}
+
+bool uxr_get_stream_stats(const uxrSession* session, uxrStreamId stream_id, uxrStreamStats* stats)
+{
+    const uxrStreamStorage* streams = &session->streams;
+    bool rv = true;
+    if(UXR_OUTPUT_STREAM == stream_id.direction)
+    {
+        if(UXR_BEST_EFFORT_STREAM == stream_id.type && stream_id.index < streams->output_best_effort_size)
+        {
+            *stats = streams->output_best_effort[stream_id.index].stats;
+        }
+        else if(UXR_RELIABLE_STREAM == stream_id.type && stream_id.index < streams->output_reliable_size)
+        {
+            *stats = streams->output_reliable[stream_id.index].stats;
+        }
+        else
+        {
+            rv = false;
+        }
+    }
+    else
+    {
+        if(UXR_BEST_EFFORT_STREAM == stream_id.type && stream_id.index < streams->input_best_effort_size)
+        {
+            *stats = streams->input_best_effort[stream_id.index].stats;
+        }
+        else if(UXR_RELIABLE_STREAM == stream_id.type && stream_id.index < streams->input_reliable_size)
+        {
+            *stats = streams->input_reliable[stream_id.index].stats;
+        }
+        else
+        {
+            rv = false;
+        }
+    }
+    return rv;
+}
+
+void uxr_reset_session_stats(uxrSession* session)
+{
+    memset(&session->stats, 0, sizeof(session->stats));
+    uxr_reset_stream_storage_stats(&session->streams);
+}
+#endif
+
+#ifdef PROFILE_FLIGHT_RECORDER
+size_t uxr_get_flight_events(const uxrSession* session, uxrFlightEvent* events, size_t capacity)
+{
+    return uxr_read_flight_events(&session->flight_recorder, events, capacity);
+}
+
+bool uxr_dump_flight_events(const uxrSession* session, int fd)
+{
+    return uxr_write_flight_events(&session->flight_recorder, fd);
+}
+#endif
+
+int64_t uxr_message_timestamp(const uxrSession* session)
+{
+    int64_t sent = 0;
+    int64_t received = 0;
+    if(NULL != session->comm->msg_timestamps)
+    {
+        (void) session->comm->msg_timestamps(session->comm->instance, &sent, &received);
+    }
+    return (0 != received) ? received : uxr_nanos();
+}
+
 int64_t uxr_epoch_nanos(uxrSession* session)
 {
-    return uxr_nanos() - session->time_offset;
+    int64_t nanos = uxr_nanos();
+    return nanos - uxr_time_sync_offset(&session->time_sync, session->time_offset, nanos);
 }
 
 #ifdef PERFORMANCE_TESTING
@@ -320,31 +646,7 @@ bool uxr_buffer_performance(uxrSession *session,
 
 void uxr_flash_output_streams(uxrSession* session)
 {
-    for(uint8_t i = 0; i < session->streams.output_best_effort_size; ++i)
-    {
-        uxrOutputBestEffortStream* stream = &session->streams.output_best_effort[i];
-        uxrStreamId id = uxr_stream_id(i, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
-
-        uint8_t* buffer; size_t length; uxrSeqNum seq_num;
-        if(uxr_prepare_best_effort_buffer_to_send(stream, &buffer, &length, &seq_num))
-        {
-            uxr_stamp_session_header(&session->info, id.raw, seq_num, buffer);
-            send_message(session, buffer, length);
-        }
-    }
-
-    for(uint8_t i = 0; i < session->streams.output_reliable_size; ++i)
-    {
-        uxrOutputReliableStream* stream = &session->streams.output_reliable[i];
-        uxrStreamId id = uxr_stream_id(i, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
-
-        uint8_t* buffer; size_t length; uxrSeqNum seq_num;
-        while(uxr_prepare_next_reliable_buffer_to_send(stream, &buffer, &length, &seq_num))
-        {
-            uxr_stamp_session_header(&session->info, id.raw, seq_num, buffer);
-            send_message(session, buffer, length);
-        }
-    }
+    flash_output_streams(session, NULL);
 }
 
 //==================================================================
@@ -359,6 +661,7 @@ bool listen_message(uxrSession* session, int poll_ms)
         ucdrBuffer ub;
         ucdr_init_buffer(&ub, data, (uint32_t)length);
         read_message(session, &ub);
+        send_control_submessages(session);
     }
 
     return must_be_read;
@@ -375,11 +678,9 @@ bool listen_message_reliably(uxrSession* session, int poll_ms)
         for(uint8_t i = 0; i < session->streams.output_reliable_size; ++i)
         {
             uxrOutputReliableStream* stream = &session->streams.output_reliable[i];
-            uxrStreamId id = uxr_stream_id(i, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
-
             if(uxr_update_output_stream_heartbeat_timestamp(stream, timestamp))
             {
-                write_submessage_heartbeat(session, id);
+                stream->heartbeat_pending = true;
             }
 
             if(stream->next_heartbeat_timestamp < next_heartbeat_timestamp)
@@ -388,8 +689,44 @@ bool listen_message_reliably(uxrSession* session, int poll_ms)
             }
         }
 
+        for(uint8_t i = 0; i < session->streams.input_reliable_size; ++i)
+        {
+            uxrInputReliableStream* stream = &session->streams.input_reliable[i];
+            if(uxr_is_input_acknack_due(stream, timestamp))
+            {
+                stream->acknack_pending = true;
+            }
+            else if(stream->next_acknack_timestamp < next_heartbeat_timestamp)
+            {
+                next_heartbeat_timestamp = stream->next_acknack_timestamp;
+            }
+        }
+
+        if(NULL == session->on_time && uxr_update_time_sync_request(&session->time_sync, timestamp))
+        {
+            write_submessage_timestamp(session);
+        }
+
+        /* The heartbeats and ACKNACKs go along with the best-effort messages flashed, the rest together in one message. */
+        if(session->next_flash <= timestamp)
+        {
+            flash_output_streams(session, NULL);
+        }
+        send_control_submessages(session);
+
+        /* The time synchronization requests, the delayed ACKNACKs and the messages held back by the shapers
+         * wake up the session as the heartbeats do. The requests are only sent without a time callback. */
+        if(NULL == session->on_time && session->time_sync.next_request < next_heartbeat_timestamp)
+        {
+            next_heartbeat_timestamp = session->time_sync.next_request;
+        }
+        if(session->next_flash < next_heartbeat_timestamp)
+        {
+            next_heartbeat_timestamp = session->next_flash;
+        }
+
         int32_t poll_to_next_heartbeat = (next_heartbeat_timestamp != INT64_MAX) ? (int32_t)(next_heartbeat_timestamp - timestamp) : poll;
-        if(0 == poll_to_next_heartbeat)
+        if(0 >= poll_to_next_heartbeat)
         {
             poll_to_next_heartbeat = 1;
         }
@@ -420,56 +757,300 @@ bool wait_session_status(uxrSession* session, uint8_t* buffer, size_t length, si
     return session->info.last_requested_status != UXR_STATUS_NONE;
 }
 
-inline bool send_message(const uxrSession* session, uint8_t* buffer, size_t length)
+inline bool send_message(uxrSession* session, uint8_t* buffer, size_t length)
 {
     bool sent = session->comm->send_msg(session->comm->instance, buffer, length);
     UXR_DEBUG_PRINT_MESSAGE((sent) ? UXR_SEND : UXR_ERROR_SEND, buffer, length, session->info.key);
+    UXR_TRACE3(message_send, buffer, length, sent);
+    if(sent)
+    {
+        if(NULL != session->shaper)
+        {
+            uxr_take_tokens(session->shaper, length, uxr_millis());
+        }
+        UXR_STATS_ADD_MESSAGE(session, sent, length);
+        if(NULL != session->on_message)
+        {
+            session->on_message(session, true, buffer, length, session->on_message_args);
+        }
+    }
+    else
+    {
+        UXR_STATS_INC(session, send_errors);
+    }
     return sent;
 }
 
-inline bool recv_message(const uxrSession* session, uint8_t**buffer, size_t* length, int poll_ms)
+inline bool recv_message(uxrSession* session, uint8_t**buffer, size_t* length, int poll_ms)
 {
     bool received = session->comm->recv_msg(session->comm->instance, buffer, length, poll_ms);
     if(received)
     {
         UXR_DEBUG_PRINT_MESSAGE(UXR_RECV, *buffer, *length, session->info.key);
+        UXR_TRACE2(message_recv, *buffer, *length);
+        UXR_STATS_ADD_MESSAGE(session, received, *length);
+        if(NULL != session->on_message)
+        {
+            session->on_message(session, false, *buffer, *length, session->on_message_args);
+        }
+    }
+    else if(UXR_SESSION_STATS_AVAILABLE && NULL != session->comm->comm_error && 0 != session->comm->comm_error())
+    {
+        UXR_STATS_INC(session, recv_errors);
     }
     return received;
 }
 
-void write_submessage_heartbeat(const uxrSession* session, uxrStreamId id)
+void flash_output_streams(uxrSession* session, const uxrStreamId* bound)
 {
-    uint8_t heartbeat_buffer[HEARTBEAT_MAX_MSG_SIZE];
-    ucdrBuffer ub;
-    ucdr_init_buffer_offset(&ub, heartbeat_buffer, HEARTBEAT_MAX_MSG_SIZE, uxr_session_header_offset(&session->info));
+    /* One message at a time, so a stream written meanwhile by a callback is scheduled as well. */
+    int64_t timestamp = uxr_millis();
+    session->next_flash = INT64_MAX;
+
+    uxrStreamId stream_id; size_t length;
+    while(next_output_stream(session, timestamp, &stream_id, &length)
+          && (NULL == bound || 0 > compare_output_streams(session, stream_id, *bound))
+          && !is_shaped(session, session->shaper, length, timestamp))
+    {
+        send_output_stream_buffer(session, stream_id, timestamp);
+    }
+}
+
+bool next_output_stream(uxrSession* session, int64_t timestamp, uxrStreamId* stream_id, size_t* length)
+{
+    /* Between streams of the same deadline and priority, best-effort ones go first, then by index. */
+    bool found = false;
+    for(uint8_t i = 0; i < session->streams.output_best_effort_size; ++i)
+    {
+        uxrOutputBestEffortStream* stream = &session->streams.output_best_effort[i];
+        uxrStreamId id = uxr_stream_id(i, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
+        if(uxr_has_pending_best_effort_buffer(stream)
+           && (!found || 0 > compare_output_streams(session, id, *stream_id))
+           && !is_shaped(session, stream->shaper, stream->writer, timestamp))
+        {
+            *stream_id = id;
+            *length = stream->writer;
+            found = true;
+        }
+    }
 
+    for(uint8_t i = 0; i < session->streams.output_reliable_size; ++i)
+    {
+        uxrOutputReliableStream* stream = &session->streams.output_reliable[i];
+        uxrStreamId id = uxr_stream_id(i, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+        if(uxr_has_pending_reliable_buffer(stream)
+           && (!found || 0 > compare_output_streams(session, id, *stream_id))
+           && !is_shaped(session, stream->shaper, uxr_get_next_reliable_buffer_length(stream), timestamp))
+        {
+            *stream_id = id;
+            *length = uxr_get_next_reliable_buffer_length(stream);
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool is_shaped(uxrSession* session, uxrTokenBucket* shaper, size_t length, int64_t timestamp)
+{
+    /* The session wakes up to flash again when the message held back could go. */
+    int64_t delay = (NULL != shaper) ? uxr_token_bucket_delay(shaper, length, timestamp) : 0;
+    if(0 < delay && timestamp + delay < session->next_flash)
+    {
+        session->next_flash = timestamp + delay;
+    }
+    return 0 < delay;
+}
+
+bool get_output_stream_schedule(uxrSession* session, uxrStreamId stream_id, uint8_t** priority, int64_t** deadline)
+{
+    bool rv = false;
+    if(UXR_OUTPUT_STREAM == stream_id.direction)
+    {
+        if(UXR_BEST_EFFORT_STREAM == stream_id.type)
+        {
+            uxrOutputBestEffortStream* stream = uxr_get_output_best_effort_stream(&session->streams, stream_id.index);
+            if(stream)
+            {
+                *priority = &stream->priority;
+                *deadline = &stream->deadline;
+                rv = true;
+            }
+        }
+        else if(UXR_RELIABLE_STREAM == stream_id.type)
+        {
+            uxrOutputReliableStream* stream = uxr_get_output_reliable_stream(&session->streams, stream_id.index);
+            if(stream)
+            {
+                *priority = &stream->priority;
+                *deadline = &stream->deadline;
+                rv = true;
+            }
+        }
+    }
+    return rv;
+}
+
+int compare_output_streams(uxrSession* session, uxrStreamId stream_id, uxrStreamId other_id)
+{
+    uint8_t* priority = NULL; int64_t* deadline = NULL;
+    uint8_t* other_priority = NULL; int64_t* other_deadline = NULL;
+
+    int rv = 0;
+    if(get_output_stream_schedule(session, stream_id, &priority, &deadline)
+       && get_output_stream_schedule(session, other_id, &other_priority, &other_deadline))
+    {
+        if(*deadline != *other_deadline)
+        {
+            rv = (*deadline < *other_deadline) ? -1 : 1;
+        }
+        else if(*priority != *other_priority)
+        {
+            rv = (*priority < *other_priority) ? -1 : 1;
+        }
+    }
+    return rv;
+}
+
+void send_output_stream_buffer(uxrSession* session, uxrStreamId stream_id, int64_t timestamp)
+{
+    uint8_t* buffer; size_t length; uxrSeqNum seq_num;
+    if(UXR_BEST_EFFORT_STREAM == stream_id.type)
+    {
+        uxrOutputBestEffortStream* stream = &session->streams.output_best_effort[stream_id.index];
+        if(uxr_prepare_best_effort_buffer_to_send(stream, &buffer, &length, &seq_num))
+        {
+            UXR_STATS_ADD_STREAM_MESSAGE(stream, length);
+            length = append_control_submessages(session, buffer, length, stream->size);
+            uxr_stamp_session_header(&session->info, stream_id.raw, seq_num, buffer);
+            send_message(session, buffer, length);
+            if(NULL != stream->shaper)
+            {
+                uxr_take_tokens(stream->shaper, length, timestamp);
+            }
+        }
+        stream->deadline = INT64_MAX;
+    }
+    else
+    {
+        uxrOutputReliableStream* stream = &session->streams.output_reliable[stream_id.index];
+        if(uxr_prepare_next_reliable_buffer_to_send(stream, &buffer, &length, &seq_num))
+        {
+            uxr_stamp_session_header(&session->info, stream_id.raw, seq_num, buffer);
+            send_message(session, buffer, length);
+            UXR_STATS_ADD_STREAM_MESSAGE(stream, length);
+            if(NULL != stream->shaper)
+            {
+                uxr_take_tokens(stream->shaper, length, timestamp);
+            }
+            if(NULL != stream->latency)
+            {
+                uxr_register_output_reliable_send(stream, seq_num, uxr_nanos());
+            }
+            if(UXR_SESSION_STATS_AVAILABLE && NO_FRAGMENTED != on_get_fragmentation_info(buffer + stream->offset))
+            {
+                UXR_STATS_INC(session, fragments_sent);
+            }
+        }
+        if(!uxr_has_unsent_reliable_buffer(stream))
+        {
+            stream->deadline = INT64_MAX;
+        }
+    }
+}
+
+void send_control_submessages(uxrSession* session)
+{
+    /* The pending HEARTBEATs and ACKNACKs of all the reliable streams, as few messages as the MTU allows. */
+    uint8_t control_buffer[CONTROL_MAX_MSG_SIZE];
+    size_t size = (session->comm->mtu < sizeof(control_buffer)) ? session->comm->mtu : sizeof(control_buffer);
+    bool written;
+    do
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer_offset(&ub, control_buffer, (uint32_t)size, uxr_session_header_offset(&session->info));
+        written = write_control_submessages(session, &ub);
+        if(written)
+        {
+            uxr_stamp_session_header(&session->info, 0, 0, ub.init);
+            send_message(session, control_buffer, ucdr_buffer_length(&ub));
+        }
+    }
+    while(written);
+}
+
+size_t append_control_submessages(uxrSession* session, uint8_t* buffer, size_t length, size_t capacity)
+{
+    /* Only best-effort messages carry them: a reliable one could be held in the reorder buffer of the Agent,
+     * or dropped there as a duplicate, with the control submessages needed to recover from the loss. */
+    size_t size = (session->comm->mtu < capacity) ? session->comm->mtu : capacity;
+    if(length < size)
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer_offset(&ub, buffer, (uint32_t)size, (uint32_t)length);
+        (void) write_control_submessages(session, &ub);
+        length = ucdr_buffer_length(&ub);
+    }
+    return length;
+}
+
+bool write_control_submessages(uxrSession* session, ucdrBuffer* ub)
+{
+    bool written = false;
+    for(uint8_t i = 0; i < session->streams.output_reliable_size; ++i)
+    {
+        uxrOutputReliableStream* stream = &session->streams.output_reliable[i];
+        if(stream->heartbeat_pending && has_room_for_submessage(ub, HEARTBEAT_PAYLOAD_SIZE))
+        {
+            write_submessage_heartbeat(session, uxr_stream_id(i, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM), ub);
+            stream->heartbeat_pending = false;
+            written = true;
+        }
+    }
+
+    for(uint8_t i = 0; i < session->streams.input_reliable_size; ++i)
+    {
+        uxrInputReliableStream* stream = &session->streams.input_reliable[i];
+        if(stream->acknack_pending && has_room_for_submessage(ub, ACKNACK_PAYLOAD_SIZE))
+        {
+            write_submessage_acknack(session, uxr_stream_id(i, UXR_RELIABLE_STREAM, UXR_INPUT_STREAM), ub);
+            stream->acknack_pending = false;
+            uxr_reset_input_stream_acknack(stream);
+            written = true;
+        }
+    }
+    return written;
+}
+
+bool has_room_for_submessage(ucdrBuffer* ub, size_t payload_size)
+{
+    return uxr_submessage_padding(ucdr_buffer_length(ub)) + SUBHEADER_SIZE + payload_size <= ucdr_buffer_remaining(ub);
+}
+
+void write_submessage_heartbeat(uxrSession* session, uxrStreamId id, ucdrBuffer* ub)
+{
     const uxrOutputReliableStream* stream = &session->streams.output_reliable[id.index];
 
     /* Buffer submessage header. */
-    uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_HEARTBEAT, HEARTBEAT_PAYLOAD_SIZE, 0);
+    uxr_buffer_submessage_header(ub, SUBMESSAGE_ID_HEARTBEAT, HEARTBEAT_PAYLOAD_SIZE, 0);
 
     /* Buffer HEARTBEAT. */
     HEARTBEAT_Payload payload;
     payload.first_unacked_seq_nr = uxr_seq_num_add(stream->last_acknown, 1);
     payload.last_unacked_seq_nr = stream->last_sent;
     payload.stream_id = id.raw;
-    (void) uxr_serialize_HEARTBEAT_Payload(&ub, &payload);
+    (void) uxr_serialize_HEARTBEAT_Payload(ub, &payload);
 
-    /* Stamp message header. */
-    uxr_stamp_session_header(&session->info, 0, 0, ub.init);
-    send_message(session, heartbeat_buffer, ucdr_buffer_length(&ub));
+    UXR_STATS_INC(session, heartbeats_sent);
+    UXR_FLIGHT_EVENT(session, UXR_EVENT_HEARTBEAT_SENT, id.raw, payload.first_unacked_seq_nr, payload.last_unacked_seq_nr, stream->next_heartbeat_tries);
+    UXR_TRACE3(heartbeat_send, id.raw, payload.first_unacked_seq_nr, payload.last_unacked_seq_nr);
 }
 
-void write_submessage_acknack(const uxrSession* session, uxrStreamId id)
+void write_submessage_acknack(uxrSession* session, uxrStreamId id, ucdrBuffer* ub)
 {
-    uint8_t acknack_buffer[ACKNACK_MAX_MSG_SIZE];
-    ucdrBuffer ub;
-    ucdr_init_buffer_offset(&ub, acknack_buffer, ACKNACK_MAX_MSG_SIZE, uxr_session_header_offset(&session->info));
-
     const uxrInputReliableStream* stream = &session->streams.input_reliable[id.index];
 
     /* Buffer submessage header. */
-    uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_ACKNACK, ACKNACK_PAYLOAD_SIZE, 0);
+    uxr_buffer_submessage_header(ub, SUBMESSAGE_ID_ACKNACK, ACKNACK_PAYLOAD_SIZE, 0);
 
     /* Buffer ACKNACK. */
     ACKNACK_Payload payload;
@@ -477,11 +1058,38 @@ void write_submessage_acknack(const uxrSession* session, uxrStreamId id)
     payload.nack_bitmap[0] = (uint8_t)(nack_bitmap >> 8);
     payload.nack_bitmap[1] = (uint8_t)((nack_bitmap << 8) >> 8);
     payload.stream_id = id.raw;
-    (void) uxr_serialize_ACKNACK_Payload(&ub, &payload);
+    (void) uxr_serialize_ACKNACK_Payload(ub, &payload);
+
+    UXR_STATS_INC(session, acknacks_sent);
+    UXR_TRACE3(acknack_send, id.raw, payload.first_unacked_seq_num, nack_bitmap);
+}
+
+void write_submessage_timestamp(uxrSession* session)
+{
+    uint8_t timestamp_buffer[TIMESTAMP_MAX_MSG_SIZE];
+    ucdrBuffer ub;
+    ucdr_init_buffer_offset(&ub, timestamp_buffer, sizeof(timestamp_buffer), uxr_session_header_offset(&session->info));
+    uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_TIMESTAMP, TIMESTAMP_PAYLOAD_SIZE, 0);
+
+    TIMESTAMP_Payload timestamp;
+    int64_t nanos = uxr_nanos();
+    timestamp.transmit_timestamp.seconds = (int32_t)(nanos / 1000000000);
+    timestamp.transmit_timestamp.nanoseconds = (uint32_t)(nanos % 1000000000);
+    (void) uxr_serialize_TIMESTAMP_Payload(&ub, &timestamp);
 
-    /* Stamp message header. */
     uxr_stamp_session_header(&session->info, 0, 0, ub.init);
-    send_message(session, acknack_buffer, ucdr_buffer_length(&ub));
+    send_message(session, timestamp_buffer, ucdr_buffer_length(&ub));
+
+    /* The kernel transmission time replaces the originate timestamp when the reply arrives. */
+    int64_t sent = 0;
+    int64_t received = 0;
+    if(NULL != session->comm->msg_timestamps)
+    {
+        (void) session->comm->msg_timestamps(session->comm->instance, &sent, &received);
+    }
+    session->time_sync.request_timestamp = uxr_convert_to_nanos(timestamp.transmit_timestamp.seconds,
+                                                               timestamp.transmit_timestamp.nanoseconds);
+    session->time_sync.request_sent = sent;
 }
 
 void read_message(uxrSession* session, ucdrBuffer* ub)
@@ -509,6 +1117,7 @@ void read_stream(uxrSession* session, ucdrBuffer* ub, uxrStreamId stream_id, uxr
             uxrInputBestEffortStream* stream = uxr_get_input_best_effort_stream(&session->streams, stream_id.index);
             if(stream && uxr_receive_best_effort_message(stream, seq_num))
             {
+                UXR_STATS_ADD_STREAM_MESSAGE(stream, ucdr_buffer_remaining(ub));
                 read_submessage_list(session, ub, stream_id);
             }
             break;
@@ -516,8 +1125,27 @@ void read_stream(uxrSession* session, ucdrBuffer* ub, uxrStreamId stream_id, uxr
         case UXR_RELIABLE_STREAM:
         {
             uxrInputReliableStream* stream = uxr_get_input_reliable_stream(&session->streams, stream_id.index);
-            bool input_buffer_used;
-            if(stream && uxr_receive_reliable_message(stream, seq_num, ub->iterator, ucdr_buffer_remaining(ub), &input_buffer_used))
+            if(UXR_SESSION_STATS_AVAILABLE && stream)
+            {
+                UXR_STATS_ADD_STREAM_MESSAGE(stream, ucdr_buffer_remaining(ub));
+                if(NO_FRAGMENTED != on_get_fragmentation_info(ub->iterator))
+                {
+                    UXR_STATS_INC(session, fragments_received);
+                }
+            }
+
+            bool input_buffer_used = false;
+            bool ready_to_read = stream && uxr_receive_reliable_message(stream, seq_num, ub->iterator, ucdr_buffer_remaining(ub), &input_buffer_used);
+            if(stream && !ready_to_read && !input_buffer_used)
+            {
+                UXR_STATS_INC(session, reliable_drops);
+            }
+            if(stream)
+            {
+                UXR_TRACE3(input_window, stream_id.raw, stream->last_handled, stream->last_announced);
+            }
+
+            if(ready_to_read)
             {
                 if(!input_buffer_used)
                 {
@@ -525,12 +1153,23 @@ void read_stream(uxrSession* session, ucdrBuffer* ub, uxrStreamId stream_id, uxr
                 }
 
                 ucdrBuffer next_mb;
+                uxrSeqNum last_handled = stream->last_handled;
                 while(uxr_next_input_reliable_buffer_available(stream, &next_mb, SUBHEADER_SIZE))
                 {
+                    /* A reassembled message consumes all its fragments at once. */
+                    uint16_t handled = uxr_seq_num_sub(stream->last_handled, last_handled);
+                    if(1 < handled)
+                    {
+                        UXR_FLIGHT_EVENT(session, UXR_EVENT_FRAGMENTS_COMPLETED, stream_id.raw, stream->last_handled, handled, 0);
+                    }
+                    last_handled = stream->last_handled;
                     read_submessage_list(session, &next_mb, stream_id);
                 }
             }
-            write_submessage_acknack(session, stream_id);
+            if(stream && uxr_register_input_reliable_message(stream, !ready_to_read && !input_buffer_used, uxr_millis()))
+            {
+                stream->acknack_pending = true;
+            }
             break;
         }
         default:
@@ -549,123 +1188,168 @@ void read_submessage_list(uxrSession* session, ucdrBuffer* submessages, uxrStrea
 
 void read_submessage(uxrSession* session, ucdrBuffer* submessage, uint8_t submessage_id, uxrStreamId stream_id, uint16_t length, uint8_t flags)
 {
-    switch(submessage_id)
+    UXR_TRACE4(submessage_read, stream_id.raw, submessage_id, length, flags);
+    SubmessageReader reader = (SUBMESSAGE_READERS_SIZE > submessage_id) ? submessage_readers[submessage_id] : NULL;
+    if(NULL != reader)
     {
-        case SUBMESSAGE_ID_STATUS_AGENT:
-            if(stream_id.type == UXR_NONE_STREAM)
-            {
-                uxr_read_create_session_status(&session->info, submessage);
-            }
-            break;
-
-        case SUBMESSAGE_ID_STATUS:
-            if(stream_id.type == UXR_NONE_STREAM)
-            {
-                uxr_read_delete_session_status(&session->info, submessage);
-            }
-            else
-            {
-                read_submessage_status(session, submessage);
-            }
-            break;
-
-        case SUBMESSAGE_ID_DATA:
-            read_submessage_data(session, submessage, length, stream_id, flags & FORMAT_MASK);
-            break;
-
-        case SUBMESSAGE_ID_HEARTBEAT:
-            read_submessage_heartbeat(session, submessage);
-            break;
-
-        case SUBMESSAGE_ID_ACKNACK:
-            read_submessage_acknack(session, submessage);
-            break;
-
-        case SUBMESSAGE_ID_TIMESTAMP_REPLY:
-            read_submessage_timestamp_reply(session, submessage);
-            break;
-
-#ifdef PERFORMANCE_TESTING
-        case SUBMESSAGE_ID_PERFORMANCE:
-            read_submessage_performance(session, submessage, length);
-            break;
-#endif
-
-        default:
-            break;
+        reader(session, submessage, stream_id, length, flags);
+    }
+    else
+    {
+        skip_submessage(submessage, length);
     }
 }
 
-void read_submessage_status(uxrSession* session, ucdrBuffer* submessage)
+void read_submessage_status_agent(uxrSession* session, ucdrBuffer* submessage,
+                                  uxrStreamId stream_id, uint16_t length, uint8_t flags)
 {
-    STATUS_Payload payload;
-    uxr_deserialize_STATUS_Payload(submessage, &payload);
+    (void) flags;
+    if(stream_id.type == UXR_NONE_STREAM)
+    {
+        uxr_read_create_session_status(&session->info, submessage);
+    }
+    else
+    {
+        skip_submessage(submessage, length);
+    }
+}
 
-    uxrObjectId object_id; uint16_t request_id;
-    uxr_parse_base_object_request(&payload.base.related_request, &object_id, &request_id);
+void read_submessage_status(uxrSession* session, ucdrBuffer* submessage,
+                            uxrStreamId stream_id, uint16_t length, uint8_t flags)
+{
+    (void) length; (void) flags;
+    if(stream_id.type == UXR_NONE_STREAM)
+    {
+        uxr_read_delete_session_status(&session->info, submessage);
+    }
+    else
+    {
+        STATUS_Payload payload;
+        if(uxr_read_STATUS_Payload(submessage, &payload))
+        {
+            uxrObjectId object_id; uint16_t request_id;
+            uxr_parse_base_object_request(&payload.base.related_request, &object_id, &request_id);
 
-    uint8_t status = payload.base.result.status;
-    process_status(session, object_id, request_id, status);
+            uint8_t status = payload.base.result.status;
+            process_status(session, object_id, request_id, status);
+        }
+    }
 }
 
 
 extern void read_submessage_format(uxrSession* session, ucdrBuffer* data, uint16_t length, uint8_t format,
                                    uxrStreamId stream_id, uxrObjectId object_id, uint16_t request_id);
 
-void read_submessage_data(uxrSession* session, ucdrBuffer* submessage, uint16_t length, uxrStreamId stream_id, uint8_t format)
+void read_submessage_data(uxrSession* session, ucdrBuffer* submessage,
+                          uxrStreamId stream_id, uint16_t length, uint8_t flags)
 {
     BaseObjectRequest base;
-    uxr_deserialize_BaseObjectRequest(submessage, &base);
-    length = (uint16_t)(length - 4); //CHANGE: by a future size_of_BaseObjectRequest
+    if(uxr_read_BaseObjectRequest(submessage, &base))
+    {
+        length = (uint16_t)(length - 4); //CHANGE: by a future size_of_BaseObjectRequest
 
-    uxrObjectId object_id; uint16_t request_id;
-    uxr_parse_base_object_request(&base, &object_id, &request_id);
+        uxrObjectId object_id; uint16_t request_id;
+        uxr_parse_base_object_request(&base, &object_id, &request_id);
 
-    process_status(session, object_id, request_id, UXR_STATUS_OK);
+        process_status(session, object_id, request_id, UXR_STATUS_OK);
 
-    if(session->on_topic != NULL)
-    {
-        read_submessage_format(session, submessage, length, format, stream_id, object_id, request_id);
+        if(session->on_topic != NULL)
+        {
+            read_submessage_format(session, submessage, length, flags & FORMAT_MASK, stream_id, object_id, request_id);
+        }
     }
 }
 
-void read_submessage_heartbeat(uxrSession* session, ucdrBuffer* submessage)
+void read_submessage_heartbeat(uxrSession* session, ucdrBuffer* submessage,
+                               uxrStreamId stream_id, uint16_t length, uint8_t flags)
 {
-    HEARTBEAT_Payload heartbeat;
-    uxr_deserialize_HEARTBEAT_Payload(submessage, &heartbeat);
+    (void) stream_id; (void) length; (void) flags;
+    HEARTBEAT_Payload heartbeat = {0};
+    bool read = uxr_read_HEARTBEAT_Payload(submessage, &heartbeat);
     uxrStreamId id = uxr_stream_id_from_raw(heartbeat.stream_id, UXR_INPUT_STREAM);
 
-    uxrInputReliableStream* stream = uxr_get_input_reliable_stream(&session->streams, id.index);
+    uxrInputReliableStream* stream = read ? uxr_get_input_reliable_stream(&session->streams, id.index) : NULL;
     if(stream)
     {
+        UXR_STATS_INC(session, heartbeats_received);
         uxr_process_heartbeat(stream, heartbeat.first_unacked_seq_nr, heartbeat.last_unacked_seq_nr);
-        write_submessage_acknack(session, id);
+        stream->acknack_pending = true;
     }
 }
 
-void read_submessage_acknack(uxrSession* session, ucdrBuffer* submessage)
+void read_submessage_acknack(uxrSession* session, ucdrBuffer* submessage,
+                             uxrStreamId stream_id, uint16_t length, uint8_t flags)
 {
-    ACKNACK_Payload acknack;
-    uxr_deserialize_ACKNACK_Payload(submessage, &acknack);
+    (void) stream_id; (void) length; (void) flags;
+    ACKNACK_Payload acknack = {0};
+    bool read = uxr_read_ACKNACK_Payload(submessage, &acknack);
     uxrStreamId id = uxr_stream_id_from_raw(acknack.stream_id, UXR_INPUT_STREAM);
 
-    uxrOutputReliableStream* stream = uxr_get_output_reliable_stream(&session->streams, id.index);
+    uxrOutputReliableStream* stream = read ? uxr_get_output_reliable_stream(&session->streams, id.index) : NULL;
     if(stream)
     {
         uint16_t nack_bitmap = (uint16_t)(((uint16_t)acknack.nack_bitmap[0] << 8) + acknack.nack_bitmap[1]);
+        UXR_STATS_INC(session, acknacks_received);
+        UXR_FLIGHT_EVENT(session, UXR_EVENT_ACKNACK_RECEIVED, id.raw, acknack.first_unacked_seq_num, nack_bitmap, 0);
+        uxrSeqNum last_acknown = stream->last_acknown;
+        bool send_lost = stream->send_lost;
         uxr_process_acknack(stream, nack_bitmap, acknack.first_unacked_seq_num);
+        if(send_lost != stream->send_lost)
+        {
+            UXR_FLIGHT_EVENT(session, UXR_EVENT_SEND_LOST, id.raw, stream->last_acknown, stream->send_lost, 0);
+            send_lost = stream->send_lost;
+        }
+        if(NULL != stream->latency)
+        {
+            uxr_register_output_reliable_acks(stream, last_acknown, uxr_nanos());
+        }
+        UXR_TRACE4(output_window, id.raw, stream->last_acknown, stream->last_sent, stream->last_written);
 
-        uint8_t* buffer; size_t length;
+        /* The retransmissions wait for the data of the more urgent streams. */
+        if(0 != nack_bitmap)
+        {
+            uxrStreamId output_id = uxr_stream_id(id.index, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+            flash_output_streams(session, &output_id);
+        }
+
+        /* The retransmissions held back by the shapers wait for the ACKNACK of the next heartbeat. */
+        int64_t timestamp = uxr_millis();
+        uint8_t* buffer; size_t buffer_length;
         uxrSeqNum seq_num_it = uxr_begin_output_nack_buffer_it(stream);
-        while (uxr_next_reliable_nack_buffer_to_send(stream, &buffer, &length, &seq_num_it))
+        while (uxr_next_reliable_nack_buffer_to_send(stream, &buffer, &buffer_length, &seq_num_it)
+               && !is_shaped(session, stream->shaper, buffer_length, timestamp)
+               && !is_shaped(session, session->shaper, buffer_length, timestamp))
         {
-            send_message(session, buffer, length);
+            /* Stamped again: a message recovered from a durable history keeps the header of the previous session. */
+            uxr_stamp_session_header(&session->info, id.raw, seq_num_it, buffer);
+            send_message(session, buffer, buffer_length);
+            if(NULL != stream->shaper)
+            {
+                uxr_take_tokens(stream->shaper, buffer_length, timestamp);
+            }
+            UXR_STATS_INC(session, retransmissions);
+            if(NULL != stream->latency)
+            {
+                uxr_register_output_reliable_retransmission(stream, seq_num_it);
+            }
+        }
+        if(send_lost != stream->send_lost)
+        {
+            UXR_FLIGHT_EVENT(session, UXR_EVENT_SEND_LOST, id.raw, stream->last_acknown, stream->send_lost, 0);
+        }
+
+        /* The messages held back by the congestion window go as soon as the session is run again. */
+        if(stream->congestion_control && uxr_has_pending_reliable_buffer(stream) && timestamp < session->next_flash)
+        {
+            session->next_flash = timestamp;
         }
     }
 }
 
-void read_submessage_timestamp_reply(uxrSession* session, ucdrBuffer* submessage)
+void read_submessage_timestamp_reply(uxrSession* session, ucdrBuffer* submessage,
+                                     uxrStreamId stream_id, uint16_t length, uint8_t flags)
 {
+    (void) stream_id; (void) length; (void) flags;
     TIMESTAMP_REPLY_Payload timestamp_reply;
     uxr_deserialize_TIMESTAMP_REPLY_Payload(submessage, &timestamp_reply);
 
@@ -673,14 +1357,27 @@ void read_submessage_timestamp_reply(uxrSession* session, ucdrBuffer* submessage
 }
 
 #ifdef PERFORMANCE_TESTING
-void read_submessage_performance(uxrSession* session, ucdrBuffer* submessage, uint16_t length)
+void read_submessage_performance(uxrSession* session, ucdrBuffer* submessage,
+                                 uxrStreamId stream_id, uint16_t length, uint8_t flags)
 {
-    ucdrBuffer mb_performance;
-    ucdr_init_buffer(&mb_performance, submessage->iterator, length);
-    session->on_performance(session, &mb_performance, session->on_performance_args);
+    (void) stream_id; (void) flags;
+    if(NULL != session->on_performance)
+    {
+        ucdrBuffer mb_performance;
+        ucdr_init_buffer(&mb_performance, submessage->iterator, length);
+        session->on_performance(session, &mb_performance, session->on_performance_args);
+    }
+    submessage->iterator += length;
 }
 #endif
 
+void skip_submessage(ucdrBuffer* submessage, uint16_t length)
+{
+    /* Skipped whole, so the next subheader is read where it is. */
+    size_t remaining = ucdr_buffer_remaining(submessage);
+    submessage->iterator += (length < remaining) ? length : remaining;
+}
+
 void process_status(uxrSession* session, uxrObjectId object_id, uint16_t request_id, uint8_t status)
 {
     if(session->on_status != NULL)
@@ -700,27 +1397,31 @@ void process_status(uxrSession* session, uxrObjectId object_id, uint16_t request
 
 void process_timestamp_reply(uxrSession* session, TIMESTAMP_REPLY_Payload* timestamp)
 {
+    int64_t t3 = uxr_message_timestamp(session);
+    int64_t t0 = uxr_convert_to_nanos(timestamp->originate_timestamp.seconds,
+                                      timestamp->originate_timestamp.nanoseconds);
+    int64_t t1 = uxr_convert_to_nanos(timestamp->receive_timestamp.seconds,
+                                      timestamp->receive_timestamp.nanoseconds);
+    int64_t t2 = uxr_convert_to_nanos(timestamp->transmit_timestamp.seconds,
+                                      timestamp->transmit_timestamp.nanoseconds);
+    if(t0 == session->time_sync.request_timestamp && 0 != session->time_sync.request_sent)
+    {
+        t0 = session->time_sync.request_sent;
+    }
+
     if(session->on_time != NULL)
     {
-        session->on_time(session,
-            uxr_nanos(),
-            uxr_convert_to_nanos(timestamp->receive_timestamp.seconds, timestamp->receive_timestamp.nanoseconds),
-            uxr_convert_to_nanos(timestamp->transmit_timestamp.seconds, timestamp->transmit_timestamp.nanoseconds),
-            uxr_convert_to_nanos(timestamp->originate_timestamp.seconds, timestamp->originate_timestamp.nanoseconds),
-            session->on_time_args);
+        session->on_time(session, t3, t1, t2, t0, session->on_time_args);
+        session->synchronized = true;
     }
     else
     {
-        int64_t t3 = uxr_nanos();
-        int64_t t0 = uxr_convert_to_nanos(timestamp->originate_timestamp.seconds,
-                                          timestamp->originate_timestamp.nanoseconds);
-        int64_t t1 = uxr_convert_to_nanos(timestamp->receive_timestamp.seconds,
-                                          timestamp->receive_timestamp.nanoseconds);
-        int64_t t2 = uxr_convert_to_nanos(timestamp->transmit_timestamp.seconds,
-                                          timestamp->transmit_timestamp.nanoseconds);
-        session->time_offset = ((t0 + t3) - (t1 + t2)) / 2;
+        if(uxr_add_time_sync_sample(&session->time_sync, t0, t1, t2, t3, t3 / 1000000))
+        {
+            session->time_offset = session->time_sync.offset;
+            session->synchronized = true;
+        }
     }
-    session->synchronized = true;
 }
 
 bool uxr_prepare_stream_to_write_submessage(uxrSession* session, uxrStreamId stream_id, size_t payload_size, ucdrBuffer* ub, uint8_t submessage_id, uint8_t mode)
@@ -740,6 +1441,11 @@ bool uxr_prepare_stream_to_write_submessage(uxrSession* session, uxrStreamId str
         {
             uxrOutputReliableStream* stream = uxr_get_output_reliable_stream(&session->streams, stream_id.index);
             available = stream && uxr_prepare_reliable_buffer_to_write(stream, submessage_size, SUBHEADER_SIZE, ub);
+            if(stream && !available)
+            {
+                UXR_FLIGHT_EVENT(session, UXR_EVENT_PREPARE_FAILED, stream_id.raw, stream->last_written,
+                                 (uint16_t)((UINT16_MAX < submessage_size) ? UINT16_MAX : submessage_size), 0);
+            }
             break;
         }
         default:
@@ -750,24 +1456,68 @@ bool uxr_prepare_stream_to_write_submessage(uxrSession* session, uxrStreamId str
     {
         (void) uxr_buffer_submessage_header(ub, submessage_id, (uint16_t)payload_size, mode);
     }
+    else
+    {
+        UXR_STATS_INC(session, failed_prepares);
+    }
+
+    return available;
+}
+
+bool uxr_prepare_stream_to_write_fragmented_submessage(uxrSession* session, uxrStreamId stream_id, size_t payload_size, ucdrBuffer* ub, uint8_t submessage_id, uint8_t mode, uxrOnBuffersFull flush_callback)
+{
+    bool available = false;
+    size_t submessage_size = SUBHEADER_SIZE + payload_size + uxr_submessage_padding(payload_size);
+
+    uxrOutputReliableStream* stream = (UXR_RELIABLE_STREAM == stream_id.type)
+                                      ? uxr_get_output_reliable_stream(&session->streams, stream_id.index)
+                                      : NULL;
+    if(NULL != stream)
+    {
+        session->on_buffers_full = flush_callback;
+        available = uxr_prepare_reliable_buffer_to_write_streamed(stream, submessage_size, SUBHEADER_SIZE, ub,
+                                                                  (NULL != flush_callback) ? on_full_output_reliable_history : NULL, session);
+        if(!available)
+        {
+            UXR_FLIGHT_EVENT(session, UXR_EVENT_PREPARE_FAILED, stream_id.raw, stream->last_written,
+                             (uint16_t)((UINT16_MAX < submessage_size) ? UINT16_MAX : submessage_size), 0);
+        }
+    }
+
+    if(available)
+    {
+        (void) uxr_buffer_submessage_header(ub, submessage_id, (uint16_t)payload_size, mode);
+    }
+    else
+    {
+        UXR_STATS_INC(session, failed_prepares);
+    }
 
     return available;
 }
 
 void on_new_output_reliable_stream_segment(ucdrBuffer* ub, uxrOutputReliableStream* stream)
 {
+    /* A fragmented message written slot by slot ends when nothing remains to be placed. */
     uint8_t* last_buffer = uxr_get_output_buffer(stream, stream->last_written % stream->history);
-    uint8_t last_fragment_flag = FLAG_LAST_FRAGMENT * (last_buffer == ub->init);
+    uint8_t last_fragment_flag = (last_buffer == ub->init && 0 == stream->fragmented_remaining) ? FLAG_LAST_FRAGMENT : 0;
 
     (void) uxr_buffer_submessage_header(ub, SUBMESSAGE_ID_FRAGMENT, (uint16_t)(ucdr_buffer_remaining(ub) - SUBHEADER_SIZE), last_fragment_flag);
 }
 
+bool on_full_output_reliable_history(uxrOutputReliableStream* stream, void* args)
+{
+    (void) stream;
+    uxrSession* session = (uxrSession*) args;
+    return session->on_buffers_full(session);
+}
+
 FragmentationInfo on_get_fragmentation_info(uint8_t* submessage_header)
 {
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, submessage_header, SUBHEADER_SIZE);
 
-    uint8_t id; uint16_t length; uint8_t flags;
+    uint8_t id = 0; uint16_t length; uint8_t flags = 0;
     uxr_read_submessage_header(&ub, &id, &length, &flags);
 
     FragmentationInfo fragmentation_info;
@@ -29,6 +29,11 @@ void uxr_init_session_info(uxrSessionInfo* info, uint8_t id, uint32_t key)
     info->key[3] = (uint8_t)((key << 24) >> 24);
     info->last_request_id = RESERVED_REQUESTS_ID;
     info->last_requested_status = UXR_STATUS_NONE;
+
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, info->header, MAX_HEADER_SIZE);
+    uxr_serialize_message_header(&ub, info->id, 0, 0, info->key);
+    info->header_size = (uint8_t)ucdr_buffer_length(&ub);
 }
 
 void uxr_buffer_create_session(uxrSessionInfo* info, ucdrBuffer* ub, uint16_t mtu)
@@ -93,10 +98,11 @@ void uxr_stamp_create_session_header(const uxrSessionInfo* info, uint8_t* buffer
 
 void uxr_stamp_session_header(const uxrSessionInfo* info, uint8_t stream_id_raw, uxrSeqNum seq_num, uint8_t* buffer)
 {
-    ucdrBuffer ub;
-    ucdr_init_buffer(&ub, buffer, MAX_HEADER_SIZE);
-
-    uxr_serialize_message_header(&ub, info->id, stream_id_raw, seq_num, info->key);
+    /* Only the stream id and the sequence number (little endian) change between messages. */
+    memcpy(buffer, info->header, info->header_size);
+    buffer[HEADER_STREAM_ID_OFFSET] = stream_id_raw;
+    buffer[HEADER_SEQ_NUM_OFFSET] = (uint8_t)seq_num;
+    buffer[HEADER_SEQ_NUM_OFFSET + 1] = (uint8_t)(seq_num >> 8);
 }
 
 bool uxr_read_session_header(const uxrSessionInfo* info, ucdrBuffer* ub, uint8_t* stream_id_raw, uxrSeqNum* seq_num)
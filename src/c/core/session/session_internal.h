@@ -31,6 +31,14 @@ bool uxr_prepare_stream_to_write_submessage(uxrSession* session,
                                             uint8_t submessage_id,
                                             uint8_t mode);
 
+bool uxr_prepare_stream_to_write_fragmented_submessage(uxrSession* session,
+                                                       uxrStreamId stream_id,
+                                                       size_t payload_size,
+                                                       struct ucdrBuffer* ub,
+                                                       uint8_t submessage_id,
+                                                       uint8_t mode,
+                                                       uxrOnBuffersFull flush_callback);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,22 +5,49 @@
 
 #include <string.h>
 
+#define NACK_BITMAP_SIZE 16
+#define BITMAP_WORD_BITS 32
+
 static bool check_last_fragment(uxrInputReliableStream* stream, uxrSeqNum* last);
+static void set_last_handled(uxrInputReliableStream* stream, uxrSeqNum last_handled);
+static bool reassemble_fragments(uxrInputReliableStream* stream);
+static void append_fragment(uxrInputReliableStream* stream, const uint8_t* buffer, size_t length, FragmentationInfo fragmentation_info);
+static bool take_reassembled_sample(uxrInputReliableStream* stream, ucdrBuffer* ub);
 static uxrSeqNum uxr_get_first_unacked(const uxrInputReliableStream* stream);
 static bool on_full_input_buffer(ucdrBuffer* ub, void* args);
 
+static void store_slot(uxrInputReliableStream* stream, uint16_t slot, const uint8_t* buffer, size_t length);
+static void release_slot(uxrInputReliableStream* stream, uint16_t slot);
+static void forget_slot(uxrInputReliableStream* stream, uint16_t slot);
+static bool is_slot_received(const uxrInputReliableStream* stream, uint16_t slot);
+static uint16_t count_received_slots(const uxrInputReliableStream* stream, uint16_t slot);
+static uint32_t get_received_slots(const uxrInputReliableStream* stream, uint16_t slot, uint16_t count);
+static uint16_t lowest_bit(uint32_t word);
+
 //==================================================================
 //                             PUBLIC
 //==================================================================
-void uxr_init_input_reliable_stream(uxrInputReliableStream* stream, uint8_t* buffer, size_t size, uint16_t history, OnGetFragmentationInfo on_get_fragmentation_info)
+bool uxr_init_input_reliable_stream(uxrInputReliableStream* stream, uint8_t* buffer, size_t size, uint16_t history, OnGetFragmentationInfo on_get_fragmentation_info)
 {
+    /* The received slots bitmap bounds the history. */
+    if(UXR_CONFIG_MAX_INPUT_RELIABLE_HISTORY < history)
+    {
+        return false;
+    }
+
     // assert for history (must be 2^)
     stream->buffer = buffer;
     stream->size = size;
     stream->history = history;
     stream->on_get_fragmentation_info = on_get_fragmentation_info;
+    stream->reassembly.buffer = NULL;
+    stream->reassembly.size = 0;
+    stream->reassembly.fragment_offset = 0;
+    stream->acknack_messages = 1;
+    stream->acknack_delay = 0;
 
     uxr_reset_input_reliable_stream(stream);
+    return true;
 }
 
 void uxr_reset_input_reliable_stream(uxrInputReliableStream* stream)
@@ -30,9 +57,26 @@ void uxr_reset_input_reliable_stream(uxrInputReliableStream* stream)
         uint8_t* internal_buffer = uxr_get_input_buffer(stream, i);
         uxr_set_reliable_buffer_length(internal_buffer, 0);
     }
+    memset(stream->received, 0, sizeof(stream->received));
 
-    stream->last_handled = SEQ_NUM_MAX;
+    set_last_handled(stream, SEQ_NUM_MAX);
     stream->last_announced = SEQ_NUM_MAX;
+    stream->acknack_pending = false;
+    uxr_reset_input_stream_acknack(stream);
+
+    stream->reassembly.length = 0;
+    stream->reassembly.complete = false;
+    stream->reassembly.overflow = false;
+}
+
+void uxr_set_input_reliable_stream_reassembly(uxrInputReliableStream* stream, uint8_t* buffer, size_t size, size_t fragment_offset)
+{
+    stream->reassembly.buffer = buffer;
+    stream->reassembly.size = size;
+    stream->reassembly.fragment_offset = fragment_offset;
+    stream->reassembly.length = 0;
+    stream->reassembly.complete = false;
+    stream->reassembly.overflow = false;
 }
 
 bool uxr_receive_reliable_message(uxrInputReliableStream* stream, uint16_t seq_num, uint8_t* buffer, size_t length, bool* message_stored)
@@ -49,21 +93,32 @@ bool uxr_receive_reliable_message(uxrInputReliableStream* stream, uint16_t seq_n
 
         if((NO_FRAGMENTED == fragmentation_info) && (seq_num == next))
         {
-            stream->last_handled = next;
+            set_last_handled(stream, next);
             ready_to_read = true;
             *message_stored = false;
         }
+        else if((NULL != stream->reassembly.buffer) && (NO_FRAGMENTED != fragmentation_info)
+                && (seq_num == next) && !stream->reassembly.complete)
+        {
+            /* In order: straight to the reassembly buffer, with the fragments stored after it. */
+            append_fragment(stream, buffer, length, fragmentation_info);
+            *message_stored = true;
+            ready_to_read = reassemble_fragments(stream);
+        }
         else
         {
             /* Check if the message received is not already received */
-            uint8_t* internal_buffer = uxr_get_input_buffer(stream, seq_num % stream->history);
-            if(0 == uxr_get_reliable_buffer_length(internal_buffer))
+            uint16_t slot = (uint16_t)(seq_num % stream->history);
+            if(!is_slot_received(stream, slot))
             {
-                memcpy(internal_buffer, buffer, length);
-                uxr_set_reliable_buffer_length(internal_buffer, length);
+                store_slot(stream, slot, buffer, length);
                 *message_stored = true;
 
-                if(NO_FRAGMENTED != fragmentation_info)
+                if(NULL != stream->reassembly.buffer && NO_FRAGMENTED != fragmentation_info)
+                {
+                    ready_to_read = reassemble_fragments(stream);
+                }
+                else if(NO_FRAGMENTED != fragmentation_info)
                 {
                     uxrSeqNum last;
                     if(check_last_fragment(stream, &last))
@@ -85,29 +140,46 @@ bool uxr_receive_reliable_message(uxrInputReliableStream* stream, uint16_t seq_n
 
 bool uxr_next_input_reliable_buffer_available(uxrInputReliableStream* stream, ucdrBuffer* ub, size_t fragment_offset)
 {
-    uxrSeqNum next = uxr_seq_num_add(stream->last_handled, 1);
-    uint8_t* internal_buffer = uxr_get_input_buffer(stream, next % stream->history);
-    size_t length = uxr_get_reliable_buffer_length(internal_buffer);
-    bool available_to_read = 0 != length;
-    if(available_to_read)
+    bool available_to_read = (NULL != stream->reassembly.buffer) && take_reassembled_sample(stream, ub);
+    if(!available_to_read)
     {
-        FragmentationInfo fragmentation_info = stream->on_get_fragmentation_info(internal_buffer);
-        if(NO_FRAGMENTED == fragmentation_info)
-        {
-            ucdr_init_buffer(ub, internal_buffer, (uint32_t)length);
-            uxr_set_reliable_buffer_length(internal_buffer, 0);
-            stream->last_handled = next;
-        }
-        else
+        uxrSeqNum next = uxr_seq_num_add(stream->last_handled, 1);
+        uint16_t slot = (uint16_t)(next % stream->history);
+        available_to_read = is_slot_received(stream, slot);
+        if(available_to_read)
         {
-            uxrSeqNum last;
-            available_to_read = check_last_fragment(stream, &last);
-            if(available_to_read)
+            uint8_t* internal_buffer = uxr_get_input_buffer(stream, slot);
+            size_t length = uxr_get_reliable_buffer_length(internal_buffer);
+            FragmentationInfo fragmentation_info = stream->on_get_fragmentation_info(internal_buffer);
+            if(NO_FRAGMENTED == fragmentation_info)
+            {
+                ucdr_init_buffer(ub, internal_buffer, (uint32_t)length);
+                release_slot(stream, slot);
+                set_last_handled(stream, next);
+            }
+            else if(NULL != stream->reassembly.buffer)
             {
-                uxr_set_reliable_buffer_length(internal_buffer, 0);
-                ucdr_init_buffer(ub, internal_buffer + fragment_offset, (uint32_t)(length - fragment_offset));
-                ucdr_set_on_full_buffer_callback(ub, on_full_input_buffer, stream);
-                stream->last_handled = last;
+                /* With a reassembly buffer, the fragments are only read from it. */
+                available_to_read = false;
+            }
+            else
+            {
+                uxrSeqNum last;
+                available_to_read = check_last_fragment(stream, &last);
+                if(available_to_read)
+                {
+                    release_slot(stream, slot);
+                    ucdr_init_buffer(ub, internal_buffer + fragment_offset, (uint32_t)(length - fragment_offset));
+                    ucdr_set_on_full_buffer_callback(ub, on_full_input_buffer, stream);
+
+                    /* The next fragments are read in place, their lengths kept for on_full_input_buffer,
+                     * but their slots are free for the next messages even if the sample is not read whole. */
+                    for(uxrSeqNum seq_num = uxr_seq_num_add(next, 1); seq_num != uxr_seq_num_add(last, 1); seq_num = uxr_seq_num_add(seq_num, 1))
+                    {
+                        forget_slot(stream, (uint16_t)(seq_num % stream->history));
+                    }
+                    set_last_handled(stream, last);
+                }
             }
         }
     }
@@ -135,19 +207,49 @@ uint16_t uxr_compute_acknack(const uxrInputReliableStream* stream, uxrSeqNum* fr
 {
     *from = uxr_get_first_unacked(stream);
     uint16_t buffers_to_ack = uxr_seq_num_sub(stream->last_announced, uxr_seq_num_sub(*from, 1));
-    uint16_t nack_bitmap = 0;
 
-    for(size_t i = 0; i < buffers_to_ack; ++i)
+    /* Only the first buffers fit in the bitmap. */
+    uint16_t count = (NACK_BITMAP_SIZE < buffers_to_ack) ? NACK_BITMAP_SIZE : buffers_to_ack;
+    uint32_t received = get_received_slots(stream, (uint16_t)(*from % stream->history), count);
+    uint32_t mask = ((uint32_t)1 << count) - 1;
+
+    return (uint16_t)(~received & mask);
+}
+
+void uxr_set_input_reliable_stream_acknack_delay(uxrInputReliableStream* stream, uint16_t messages, int64_t delay)
+{
+    stream->acknack_messages = messages;
+    stream->acknack_delay = delay;
+}
+
+bool uxr_register_input_reliable_message(uxrInputReliableStream* stream, bool duplicated, int64_t current_timestamp)
+{
+    /* A gap or a retransmission already received is reported at once, the Agent is waiting for it. */
+    uxrSeqNum first_unacked;
+    bool must_acknack = duplicated || 0 != uxr_compute_acknack(stream, &first_unacked);
+
+    stream->unacked_messages++;
+    if(stream->unacked_messages >= stream->acknack_messages || 0 >= stream->acknack_delay)
     {
-        uxrSeqNum seq_num = uxr_seq_num_add(*from, (uxrSeqNum)i);
-        uint8_t* internal_buffer = uxr_get_input_buffer(stream, seq_num % stream->history);
-        if(0 == uxr_get_reliable_buffer_length(internal_buffer))
-        {
-            nack_bitmap = (uint16_t)(nack_bitmap | (1 << i));
-        }
+        must_acknack = true;
+    }
+    else if(INT64_MAX == stream->next_acknack_timestamp)
+    {
+        stream->next_acknack_timestamp = current_timestamp + stream->acknack_delay;
     }
 
-    return nack_bitmap;
+    return must_acknack;
+}
+
+bool uxr_is_input_acknack_due(const uxrInputReliableStream* stream, int64_t current_timestamp)
+{
+    return stream->next_acknack_timestamp <= current_timestamp;
+}
+
+void uxr_reset_input_stream_acknack(uxrInputReliableStream* stream)
+{
+    stream->unacked_messages = 0;
+    stream->next_acknack_timestamp = INT64_MAX;
 }
 
 uint8_t* uxr_get_input_buffer(const uxrInputReliableStream* stream, size_t history_pos)
@@ -165,46 +267,104 @@ size_t uxr_get_input_buffer_size(const uxrInputReliableStream* stream)
 //==================================================================
 bool check_last_fragment(uxrInputReliableStream* stream, uxrSeqNum* last_fragment)
 {
-    uxrSeqNum next = stream->last_handled;
-    bool more_messages;
-    bool found = false;
-    do
+    /* Resumes where the previous check stopped: every fragment header is read once per message. */
+    while(!stream->last_fragment_found
+          && stream->history > uxr_seq_num_sub(stream->last_contiguous, stream->last_handled))
     {
-        next = uxr_seq_num_add(next, 1);
-        uint8_t* next_buffer = uxr_get_input_buffer(stream, next % stream->history);
-        more_messages = 0 != uxr_get_reliable_buffer_length(next_buffer);
-        if(more_messages)
+        uxrSeqNum next = uxr_seq_num_add(stream->last_contiguous, 1);
+        uint16_t slot = (uint16_t)(next % stream->history);
+        if(!is_slot_received(stream, slot))
         {
-            FragmentationInfo next_fragmentation_info = stream->on_get_fragmentation_info(next_buffer);
-            more_messages = INTERMEDIATE_FRAGMENT == next_fragmentation_info;
-            if(LAST_FRAGMENT == next_fragmentation_info)
-            {
-                found = true;
-                break;
-            }
+            break;
         }
+
+        FragmentationInfo fragmentation_info = stream->on_get_fragmentation_info(uxr_get_input_buffer(stream, slot));
+        if(NO_FRAGMENTED == fragmentation_info)
+        {
+            break;
+        }
+        stream->last_contiguous = next;
+        stream->last_fragment_found = LAST_FRAGMENT == fragmentation_info;
     }
-    while(more_messages);
 
-    *last_fragment = next;
-    return found;
+    *last_fragment = stream->last_contiguous;
+    return stream->last_fragment_found;
 }
 
-uxrSeqNum uxr_get_first_unacked(const uxrInputReliableStream* stream)
+void set_last_handled(uxrInputReliableStream* stream, uxrSeqNum last_handled)
 {
-    uxrSeqNum first_unknown = stream->last_handled;
-    for(size_t i = 0; i < stream->history; ++i)
+    stream->last_handled = last_handled;
+    stream->last_contiguous = last_handled;
+    stream->last_fragment_found = false;
+}
+
+bool reassemble_fragments(uxrInputReliableStream* stream)
+{
+    /* Moves the stored fragments following last_handled to the reassembly buffer, up to the last one. */
+    while(!stream->reassembly.complete)
     {
-        uxrSeqNum seq_num = uxr_seq_num_add(stream->last_handled, (uint16_t)(i + 1));
-        uint8_t* buffer = uxr_get_input_buffer(stream, seq_num % stream->history);
-        if(0 == uxr_get_reliable_buffer_length(buffer))
+        uint16_t slot = (uint16_t)(uxr_seq_num_add(stream->last_handled, 1) % stream->history);
+        if(!is_slot_received(stream, slot))
+        {
+            break;
+        }
+
+        uint8_t* internal_buffer = uxr_get_input_buffer(stream, slot);
+        FragmentationInfo fragmentation_info = stream->on_get_fragmentation_info(internal_buffer);
+        if(NO_FRAGMENTED == fragmentation_info)
         {
-            first_unknown = seq_num;
             break;
         }
+        append_fragment(stream, internal_buffer, uxr_get_reliable_buffer_length(internal_buffer), fragmentation_info);
+        release_slot(stream, slot);
+    }
+
+    return stream->reassembly.complete;
+}
+
+void append_fragment(uxrInputReliableStream* stream, const uint8_t* buffer, size_t length, FragmentationInfo fragmentation_info)
+{
+    uxrInputReliableReassembly* reassembly = &stream->reassembly;
+    size_t fragment_length = (reassembly->fragment_offset < length) ? length - reassembly->fragment_offset : 0;
+    if(!reassembly->overflow && reassembly->size - reassembly->length >= fragment_length)
+    {
+        memcpy(reassembly->buffer + reassembly->length, buffer + reassembly->fragment_offset, fragment_length);
+        reassembly->length += fragment_length;
+    }
+    else
+    {
+        reassembly->overflow = true;
     }
+    set_last_handled(stream, uxr_seq_num_add(stream->last_handled, 1));
 
-    return first_unknown;
+    if(LAST_FRAGMENT == fragmentation_info)
+    {
+        /* A sample which does not fit is dropped whole. */
+        reassembly->complete = !reassembly->overflow;
+        reassembly->length = reassembly->overflow ? 0 : reassembly->length;
+        reassembly->overflow = false;
+    }
+}
+
+bool take_reassembled_sample(uxrInputReliableStream* stream, ucdrBuffer* ub)
+{
+    bool available_to_read = reassemble_fragments(stream);
+    if(available_to_read)
+    {
+        ucdr_init_buffer(ub, stream->reassembly.buffer, (uint32_t)stream->reassembly.length);
+        stream->reassembly.length = 0;
+        stream->reassembly.complete = false;
+    }
+    return available_to_read;
+}
+
+uxrSeqNum uxr_get_first_unacked(const uxrInputReliableStream* stream)
+{
+    uxrSeqNum next = uxr_seq_num_add(stream->last_handled, 1);
+    uint16_t received = count_received_slots(stream, (uint16_t)(next % stream->history));
+
+    /* With the whole history received there is nothing unknown yet. */
+    return (received < stream->history) ? uxr_seq_num_add(next, received) : stream->last_handled;
 }
 
 bool on_full_input_buffer(ucdrBuffer* ub, void* args)
@@ -212,13 +372,14 @@ bool on_full_input_buffer(ucdrBuffer* ub, void* args)
     uxrInputReliableStream* stream = (uxrInputReliableStream*) args;
 
     size_t slot_pos = (size_t)(ub->init - stream->buffer) / (stream->size / stream->history);
+    uint16_t next_slot = (uint16_t)((slot_pos + 1) % stream->history);
     uint8_t* buffer = uxr_get_input_buffer(stream, slot_pos % stream->history);
-    uint8_t* next_buffer = uxr_get_input_buffer(stream, (slot_pos + 1) % stream->history);
+    uint8_t* next_buffer = uxr_get_input_buffer(stream, next_slot);
     size_t offset = (size_t)(ub->init - buffer);
 
     uint8_t* next_init = next_buffer + offset;
     size_t next_length = uxr_get_reliable_buffer_length(next_buffer) - offset;
-    uxr_set_reliable_buffer_length(next_buffer, 0);
+    release_slot(stream, next_slot);
 
     ucdr_init_buffer(ub, next_init, (uint32_t)next_length);
     ucdr_set_on_full_buffer_callback(ub, on_full_input_buffer, stream);
@@ -226,3 +387,88 @@ bool on_full_input_buffer(ucdrBuffer* ub, void* args)
     return false;
 }
 
+void store_slot(uxrInputReliableStream* stream, uint16_t slot, const uint8_t* buffer, size_t length)
+{
+    uint8_t* internal_buffer = uxr_get_input_buffer(stream, slot);
+    memcpy(internal_buffer, buffer, length);
+    uxr_set_reliable_buffer_length(internal_buffer, length);
+    stream->received[slot / BITMAP_WORD_BITS] |= (uint32_t)1 << (slot % BITMAP_WORD_BITS);
+}
+
+void release_slot(uxrInputReliableStream* stream, uint16_t slot)
+{
+    uxr_set_reliable_buffer_length(uxr_get_input_buffer(stream, slot), 0);
+    forget_slot(stream, slot);
+}
+
+void forget_slot(uxrInputReliableStream* stream, uint16_t slot)
+{
+    stream->received[slot / BITMAP_WORD_BITS] &= ~((uint32_t)1 << (slot % BITMAP_WORD_BITS));
+}
+
+bool is_slot_received(const uxrInputReliableStream* stream, uint16_t slot)
+{
+    return 0 != (stream->received[slot / BITMAP_WORD_BITS] & ((uint32_t)1 << (slot % BITMAP_WORD_BITS)));
+}
+
+uint16_t count_received_slots(const uxrInputReliableStream* stream, uint16_t slot)
+{
+    /* Consecutive received slots from `slot` on, wrapping around the history, a word at a time. */
+    uint16_t count = 0;
+    while(count < stream->history)
+    {
+        uint16_t bit = slot % BITMAP_WORD_BITS;
+        uint16_t word_bits = (uint16_t)(BITMAP_WORD_BITS - bit);
+        uint16_t available = (uint16_t)(stream->history - slot);
+        available = (word_bits < available) ? word_bits : available;
+
+        uint32_t missing = ~stream->received[slot / BITMAP_WORD_BITS] >> bit;
+        if(0 != missing && lowest_bit(missing) < available)
+        {
+            count = (uint16_t)(count + lowest_bit(missing));
+            break;
+        }
+        count = (uint16_t)(count + available);
+        slot = (uint16_t)((slot + available) % stream->history);
+    }
+
+    return (count < stream->history) ? count : stream->history;
+}
+
+uint32_t get_received_slots(const uxrInputReliableStream* stream, uint16_t slot, uint16_t count)
+{
+    /* `count` bits (up to NACK_BITMAP_SIZE) from `slot` on, wrapping around the history. */
+    uint32_t bits = 0;
+    uint16_t taken = 0;
+    while(taken < count)
+    {
+        uint16_t bit = slot % BITMAP_WORD_BITS;
+        uint16_t available = (uint16_t)(BITMAP_WORD_BITS - bit);
+        available = ((uint16_t)(stream->history - slot) < available) ? (uint16_t)(stream->history - slot) : available;
+        available = ((uint16_t)(count - taken) < available) ? (uint16_t)(count - taken) : available;
+
+        uint32_t word = stream->received[slot / BITMAP_WORD_BITS] >> bit;
+        uint32_t mask = (BITMAP_WORD_BITS > available) ? ((uint32_t)1 << available) - 1 : ~(uint32_t)0;
+        bits |= (word & mask) << taken;
+
+        taken = (uint16_t)(taken + available);
+        slot = (uint16_t)((slot + available) % stream->history);
+    }
+
+    return bits;
+}
+
+uint16_t lowest_bit(uint32_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint16_t)__builtin_ctz(word);
+#else
+    uint16_t position = 0;
+    while(0 == (word & 1))
+    {
+        word >>= 1;
+        ++position;
+    }
+    return position;
+#endif
+}
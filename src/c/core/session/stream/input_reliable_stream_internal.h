@@ -30,12 +30,17 @@ extern "C"
 
 struct ucdrBuffer;
 
-void uxr_init_input_reliable_stream(uxrInputReliableStream* stream, uint8_t* buffer, size_t size, uint16_t history, OnGetFragmentationInfo on_get_fragmentation_info);
+bool uxr_init_input_reliable_stream(uxrInputReliableStream* stream, uint8_t* buffer, size_t size, uint16_t history, OnGetFragmentationInfo on_get_fragmentation_info);
 void uxr_reset_input_reliable_stream(uxrInputReliableStream* stream);
+void uxr_set_input_reliable_stream_reassembly(uxrInputReliableStream* stream, uint8_t* buffer, size_t size, size_t fragment_offset);
 bool uxr_receive_reliable_message(uxrInputReliableStream* stream, uint16_t seq_num, uint8_t* buffer, size_t length, bool* message_stored);
 bool uxr_next_input_reliable_buffer_available(uxrInputReliableStream* stream, struct ucdrBuffer* ub, size_t fragment_offset);
 
 uint16_t uxr_compute_acknack(const uxrInputReliableStream* stream, uxrSeqNum* from);
+void uxr_set_input_reliable_stream_acknack_delay(uxrInputReliableStream* stream, uint16_t messages, int64_t delay);
+bool uxr_register_input_reliable_message(uxrInputReliableStream* stream, bool duplicated, int64_t current_timestamp);
+bool uxr_is_input_acknack_due(const uxrInputReliableStream* stream, int64_t current_timestamp);
+void uxr_reset_input_stream_acknack(uxrInputReliableStream* stream);
 void uxr_process_heartbeat(uxrInputReliableStream* stream, uxrSeqNum first_seq_num, uxrSeqNum last_seq_num);
 
 bool uxr_is_input_up_to_date(const uxrInputReliableStream* stream);
@@ -13,6 +13,8 @@ void uxr_init_output_best_effort_stream(uxrOutputBestEffortStream* stream, uint8
     stream->buffer = buffer;
     stream->offset = offset;
     stream->size = size;
+    stream->priority = 0;
+    stream->shaper = NULL;
 
     uxr_reset_output_best_effort_stream(stream);
 }
@@ -21,6 +23,12 @@ void uxr_reset_output_best_effort_stream(uxrOutputBestEffortStream* stream)
 {
     stream->writer = stream->offset;
     stream->last_send = SEQ_NUM_MAX;
+    stream->deadline = INT64_MAX;
+}
+
+bool uxr_has_pending_best_effort_buffer(const uxrOutputBestEffortStream* stream)
+{
+    return stream->writer > stream->offset;
 }
 
 bool uxr_prepare_best_effort_buffer_to_write(uxrOutputBestEffortStream* stream, size_t size, ucdrBuffer* ub)
@@ -40,7 +48,7 @@ bool uxr_prepare_best_effort_buffer_to_write(uxrOutputBestEffortStream* stream,
 
 bool uxr_prepare_best_effort_buffer_to_send(uxrOutputBestEffortStream* stream, uint8_t** buffer, size_t* length, uint16_t* seq_num)
 {
-    bool data_to_send = stream->writer > stream->offset;
+    bool data_to_send = uxr_has_pending_best_effort_buffer(stream);
     if(data_to_send)
     {
         stream->last_send = uxr_seq_num_add(stream->last_send, 1);
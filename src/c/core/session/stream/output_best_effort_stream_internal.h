@@ -29,6 +29,7 @@ extern "C"
 void uxr_init_output_best_effort_stream(uxrOutputBestEffortStream* stream, uint8_t* buffer, size_t size, uint8_t offset);
 void uxr_reset_output_best_effort_stream(uxrOutputBestEffortStream* stream);
 bool uxr_prepare_best_effort_buffer_to_write(uxrOutputBestEffortStream* stream, size_t size, struct ucdrBuffer* ub);
+bool uxr_has_pending_best_effort_buffer(const uxrOutputBestEffortStream* stream);
 bool uxr_prepare_best_effort_buffer_to_send(uxrOutputBestEffortStream* stream, uint8_t** buffer, size_t* length, uint16_t* seq_num);
 
 #ifdef __cplusplus
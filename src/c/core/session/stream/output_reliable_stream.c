@@ -10,8 +10,28 @@
 
 #define MIN_HEARTBEAT_TIME_INTERVAL ((int64_t) UXR_CONFIG_MIN_HEARTBEAT_TIME_INTERVAL) // ms
 #define MAX_HEARTBEAT_TRIES         (sizeof(int64_t) * 8 - 1)
+#define DURABLE_STREAM_MAGIC        0x55524453 // "URDS"
+#define INITIAL_CONGESTION_WINDOW   2
 
 static bool on_full_output_buffer(ucdrBuffer* ub, void* args);
+static bool on_full_streamed_buffer(ucdrBuffer* ub, void* args);
+static bool claim_fragment_slot(uxrOutputReliableStream* stream, size_t fragment_offset, ucdrBuffer* ub);
+static bool next_fragment_slot(uxrOutputReliableStream* stream, size_t fragment_offset, size_t remaining, uxrSeqNum* seq_num, size_t* length);
+static size_t fragment_size(const uxrOutputReliableStream* stream, size_t length, size_t fragment_offset, size_t remaining);
+static bool room_for_fragments(uxrOutputReliableStream* stream, size_t length, size_t fragment_offset);
+static bool is_in_window(const uxrOutputReliableStream* stream, uxrSeqNum seq_num);
+static bool reserve_message(uxrOutputReliableStream* stream, uxrSeqNum seq_num, size_t length);
+static bool place_packed_message(uxrOutputReliableStream* stream, uxrSeqNum seq_num, size_t length);
+static size_t get_buffer_length(const uxrOutputReliableStream* stream, size_t history_pos);
+static void set_buffer_length(uxrOutputReliableStream* stream, size_t history_pos, size_t length);
+static void clear_stream(uxrOutputReliableStream* stream);
+static void store_cursors(uxrOutputReliableStream* stream);
+static void recover_durable_stream(uxrOutputReliableStream* stream);
+static void rotate_slots(uxrOutputReliableStream* stream, size_t from, size_t to);
+static uint16_t send_window(const uxrOutputReliableStream* stream);
+static void reset_congestion_window(uxrOutputReliableStream* stream);
+static void grow_congestion_window(uxrOutputReliableStream* stream, size_t acknowledged);
+static void shrink_congestion_window(uxrOutputReliableStream* stream, bool timeout);
 
 //==================================================================
 //                             PUBLIC
@@ -25,62 +45,145 @@ void uxr_init_output_reliable_stream(uxrOutputReliableStream* stream, uint8_t* b
     stream->offset = header_offset;
     stream->history = history;
     stream->on_new_fragment = on_new_fragment;
+    stream->on_full_history = NULL;
+    stream->on_full_history_args = NULL;
+    stream->priority = 0;
+    stream->shaper = NULL;
+    stream->congestion_control = false;
+    stream->packed = NULL;
+    stream->max_message_size = 0;
+    stream->durable = NULL;
+    stream->latency = NULL;
 
     uxr_reset_output_reliable_stream(stream);
 }
 
-void uxr_reset_output_reliable_stream(uxrOutputReliableStream* stream)
+bool uxr_init_output_durable_stream(uxrOutputReliableStream* stream, uint8_t* memory, size_t size, uint16_t history, uint8_t header_offset, OnNewFragment on_new_fragment)
 {
-    for(size_t i = 0; i < stream->history; i++)
+    /* The cursors are accessed in place, at the beginning of the memory. */
+    if(UXR_DURABLE_STREAM_OVERHEAD >= size || 0 == history || 0 != (uintptr_t)memory % sizeof(uint32_t))
     {
-        uint8_t* internal_buffer = uxr_get_output_buffer(stream, i);
-        uxr_set_reliable_buffer_length(internal_buffer, stream->offset);
+        return false;
     }
 
-    stream->last_written = 0;
-    stream->last_sent = SEQ_NUM_MAX;
-    stream->last_acknown = SEQ_NUM_MAX;
+    uxrOutputReliableStreamCursors* cursors = (uxrOutputReliableStreamCursors*) memory;
+    size_t history_size = size - UXR_DURABLE_STREAM_OVERHEAD;
 
-    stream->next_heartbeat_timestamp = INT64_MAX;
-    stream->next_heartbeat_tries = 0;
-    stream->send_lost = false;
+    stream->buffer = memory + UXR_DURABLE_STREAM_OVERHEAD;
+    stream->size = history_size;
+    stream->offset = header_offset;
+    stream->history = history;
+    stream->on_new_fragment = on_new_fragment;
+    stream->on_full_history = NULL;
+    stream->on_full_history_args = NULL;
+    stream->priority = 0;
+    stream->shaper = NULL;
+    stream->congestion_control = false;
+    stream->packed = NULL;
+    stream->max_message_size = 0;
+    stream->durable = cursors;
+    stream->latency = NULL;
+
+    /* Only a history written with the same layout could be recovered. */
+    bool recoverable = DURABLE_STREAM_MAGIC == cursors->magic
+                       && history_size == cursors->size
+                       && history == cursors->history
+                       && header_offset == cursors->offset;
+    if(recoverable)
+    {
+        stream->last_written = cursors->last_written;
+        stream->last_sent = cursors->last_sent;
+        stream->last_acknown = cursors->last_acknown;
+        recover_durable_stream(stream);
+    }
+    else
+    {
+        cursors->magic = DURABLE_STREAM_MAGIC;
+        cursors->size = (uint32_t)history_size;
+        cursors->history = history;
+        cursors->offset = header_offset;
+        clear_stream(stream);
+    }
+    return true;
+}
+
+void uxr_init_output_packed_stream(uxrOutputReliableStream* stream, uint8_t* memory, size_t size, uint16_t history, size_t max_message_size, uint8_t header_offset, OnNewFragment on_new_fragment)
+{
+    /* The index goes first, the messages are laid out one after another in the rest of the memory. */
+    size_t packed_size = size - UXR_PACKED_STREAM_OVERHEAD(history);
+
+    stream->packed = (uxrPackedMessage*) memory;
+    stream->buffer = memory + UXR_PACKED_STREAM_OVERHEAD(history);
+    stream->size = (UINT16_MAX < packed_size) ? UINT16_MAX : packed_size;
+    stream->max_message_size = (stream->size < max_message_size) ? stream->size : max_message_size;
+    stream->offset = header_offset;
+    stream->history = history;
+    stream->on_new_fragment = on_new_fragment;
+    stream->on_full_history = NULL;
+    stream->on_full_history_args = NULL;
+    stream->priority = 0;
+    stream->shaper = NULL;
+    stream->congestion_control = false;
+    stream->durable = NULL;
+    stream->latency = NULL;
+
+    clear_stream(stream);
+}
+
+void uxr_reset_output_reliable_stream(uxrOutputReliableStream* stream)
+{
+    if(NULL != stream->durable)
+    {
+        /* A durable stream keeps its unacknowledged messages across sessions. */
+        recover_durable_stream(stream);
+    }
+    else
+    {
+        clear_stream(stream);
+    }
 }
 
 bool uxr_prepare_reliable_buffer_to_write(uxrOutputReliableStream* stream, size_t length, size_t fragment_offset, ucdrBuffer* ub)
 {
     bool available_to_write = false;
     size_t block_size = uxr_get_output_buffer_size(stream);
+    stream->fragmented_remaining = 0;
+    stream->on_full_history = NULL;
 
-    uint8_t* initial_buffer = uxr_get_output_buffer(stream, stream->last_written % stream->history);
-    size_t initial_length = uxr_get_reliable_buffer_length(initial_buffer);
+    size_t initial_length = get_buffer_length(stream, stream->last_written % stream->history);
 
-    /* Check if the message fit in the current buffer */
-    if(initial_length + length <= block_size)
+    /* Check if the message fit in the current buffer, and if there is space in the stream history to write */
+    if(initial_length + length <= block_size
+       && is_in_window(stream, stream->last_written)
+       && reserve_message(stream, stream->last_written, initial_length + length))
     {
-        /* Check if there is space in the stream history to write */
-        uxrSeqNum last_available = uxr_seq_num_add(stream->last_acknown, stream->history);
-        available_to_write = 0 >= uxr_seq_num_cmp(stream->last_written, last_available);
-        if(available_to_write)
-        {
-            size_t future_length = initial_length + length;
-            uxr_set_reliable_buffer_length(initial_buffer, future_length);
-            ucdr_init_buffer_offset(ub, initial_buffer, (uint32_t)future_length, (uint32_t)initial_length);
-        }
+        uint8_t* buffer = uxr_get_output_buffer(stream, stream->last_written % stream->history);
+        ucdr_init_buffer_offset(ub, buffer, (uint32_t)(initial_length + length), (uint32_t)initial_length);
+        available_to_write = true;
     }
     /* Check if the message fit in a new empty buffer */
     else if(stream->offset + length <= block_size)
     {
         /* Check if there is space in the stream history to write */
         uxrSeqNum next = uxr_seq_num_add(stream->last_written, 1);
-        uxrSeqNum last_available = uxr_seq_num_add(stream->last_acknown, stream->history);
-        available_to_write = 0 >= uxr_seq_num_cmp(next, last_available);
+        available_to_write = stream->offset < initial_length
+                             && is_in_window(stream, next)
+                             && reserve_message(stream, next, stream->offset + length);
         if(available_to_write)
         {
             stream->last_written = next;
             uint8_t* buffer = uxr_get_output_buffer(stream, next % stream->history);
-            size_t future_length = stream->offset + length;
-            uxr_set_reliable_buffer_length(buffer, future_length);
-            ucdr_init_buffer_offset(ub, buffer, (uint32_t)future_length, stream->offset);
+            ucdr_init_buffer_offset(ub, buffer, (uint32_t)(stream->offset + length), stream->offset);
+        }
+    }
+    /* Check if the message fit in a fragmented message, placed one fragment at a time in the packed layout */
+    else if(NULL != stream->packed)
+    {
+        available_to_write = room_for_fragments(stream, length, fragment_offset);
+        if(available_to_write)
+        {
+            stream->fragmented_remaining = length;
+            (void) claim_fragment_slot(stream, fragment_offset, ub);
         }
     }
     /* Check if the message fit in a fragmented message */
@@ -88,6 +191,7 @@ bool uxr_prepare_reliable_buffer_to_write(uxrOutputReliableStream* stream, size_
     {
         size_t remaining_blocks = uxr_seq_num_sub(stream->last_acknown, stream->last_written) % stream->history;
         uxrSeqNum init = stream->last_written;
+        uint8_t* initial_buffer = uxr_get_output_buffer(stream, init % stream->history);
 
         /* Check if the current buffer free space is too small */
         if(initial_length + fragment_offset >= block_size)
@@ -124,18 +228,66 @@ bool uxr_prepare_reliable_buffer_to_write(uxrOutputReliableStream* stream, size_
         }
     }
 
+    if(available_to_write)
+    {
+        store_cursors(stream);
+    }
+
+    return available_to_write;
+}
+
+bool uxr_prepare_reliable_buffer_to_write_streamed(uxrOutputReliableStream* stream, size_t length, size_t fragment_offset, ucdrBuffer* ub,
+                                                    OnFullHistory on_full_history, void* args)
+{
+    bool available_to_write = false;
+    if(stream->offset + length <= uxr_get_output_buffer_size(stream))
+    {
+        available_to_write = uxr_prepare_reliable_buffer_to_write(stream, length, fragment_offset, ub)
+                             || (NULL != on_full_history
+                                 && on_full_history(stream, args)
+                                 && uxr_prepare_reliable_buffer_to_write(stream, length, fragment_offset, ub));
+    }
+    else
+    {
+        /* Only one fragment is placed at a time, the next ones are claimed as the ucdrBuffer fills up. */
+        stream->fragmented_remaining = length;
+        stream->on_full_history = on_full_history;
+        stream->on_full_history_args = args;
+        available_to_write = claim_fragment_slot(stream, fragment_offset, ub);
+        if(!available_to_write)
+        {
+            stream->fragmented_remaining = 0;
+        }
+    }
+
     return available_to_write;
 }
 
+bool uxr_has_unsent_reliable_buffer(const uxrOutputReliableStream* stream)
+{
+    uxrSeqNum seq_num = uxr_seq_num_add(stream->last_sent, 1);
+    return 0 >= uxr_seq_num_cmp(seq_num, stream->last_written)
+           && get_buffer_length(stream, seq_num % stream->history) > stream->offset;
+}
+
+size_t uxr_get_next_reliable_buffer_length(const uxrOutputReliableStream* stream)
+{
+    return get_buffer_length(stream, uxr_seq_num_add(stream->last_sent, 1) % stream->history);
+}
+
+bool uxr_has_pending_reliable_buffer(const uxrOutputReliableStream* stream)
+{
+    return uxr_has_unsent_reliable_buffer(stream)
+           && uxr_seq_num_sub(stream->last_sent, stream->last_acknown) < send_window(stream);
+}
+
 bool uxr_prepare_next_reliable_buffer_to_send(uxrOutputReliableStream* stream, uint8_t** buffer, size_t* length, uxrSeqNum* seq_num)
 {
     *seq_num = uxr_seq_num_add(stream->last_sent, 1);
     *buffer = uxr_get_output_buffer(stream, *seq_num % stream->history);
-    *length = uxr_get_reliable_buffer_length(*buffer);
+    *length = get_buffer_length(stream, *seq_num % stream->history);
 
-    bool data_to_send = 0 >= uxr_seq_num_cmp(*seq_num, stream->last_written)
-                        && *length > stream->offset
-                        && uxr_seq_num_sub(stream->last_sent, stream->last_acknown) != stream->history;
+    bool data_to_send = uxr_has_pending_reliable_buffer(stream);
     if(data_to_send)
     {
         stream->last_sent = *seq_num;
@@ -143,6 +295,7 @@ bool uxr_prepare_next_reliable_buffer_to_send(uxrOutputReliableStream* stream, u
         {
             stream->last_written = uxr_seq_num_add(stream->last_written, 1);
         }
+        store_cursors(stream);
     }
 
     return data_to_send;
@@ -163,6 +316,11 @@ bool uxr_update_output_stream_heartbeat_timestamp(uxrOutputReliableStream* strea
             int64_t increment = MIN_HEARTBEAT_TIME_INTERVAL << (stream->next_heartbeat_tries % MAX_HEARTBEAT_TRIES);
             int64_t difference = current_timestamp - stream->next_heartbeat_timestamp;
             stream->next_heartbeat_timestamp += (difference > increment) ? difference : increment;
+            if(1 < stream->next_heartbeat_tries)
+            {
+                /* The previous heartbeat was not answered. */
+                shrink_congestion_window(stream, true);
+            }
             stream->next_heartbeat_tries++;
             must_confirm = true;
         }
@@ -193,7 +351,7 @@ bool uxr_next_reliable_nack_buffer_to_send(uxrOutputReliableStream* stream, uint
             if(check_next_buffer)
             {
                 *buffer = uxr_get_output_buffer(stream, *seq_num_it % stream->history);
-                *length = uxr_get_reliable_buffer_length(*buffer);
+                *length = get_buffer_length(stream, *seq_num_it % stream->history);
                 it_updated = *length != stream->offset;
             }
         }
@@ -210,18 +368,91 @@ bool uxr_next_reliable_nack_buffer_to_send(uxrOutputReliableStream* stream, uint
 void uxr_process_acknack(uxrOutputReliableStream* stream, uint16_t bitmap, uxrSeqNum first_unacked_seq_num)
 {
     uxrSeqNum last_acked_seq_num = uxr_seq_num_sub(first_unacked_seq_num, 1);
-    size_t buffers_to_clean = uxr_seq_num_sub(last_acked_seq_num, stream->last_acknown);
-    for(size_t i = 0; i < buffers_to_clean; i++)
+
+    /* A late or duplicated ACKNACK would move the window backwards, clearing unacknowledged buffers. */
+    if(0 <= uxr_seq_num_cmp(last_acked_seq_num, stream->last_acknown) && 0 >= uxr_seq_num_cmp(last_acked_seq_num, stream->last_sent))
+    {
+        size_t buffers_to_clean = uxr_seq_num_sub(last_acked_seq_num, stream->last_acknown);
+        for(size_t i = 0; i < buffers_to_clean; i++)
+        {
+            stream->last_acknown = uxr_seq_num_add(stream->last_acknown, 1);
+            set_buffer_length(stream, stream->last_acknown % stream->history, stream->offset); /* clear buffer */
+        }
+        store_cursors(stream);
+
+        stream->send_lost = (0 < bitmap);
+        if(stream->send_lost)
+        {
+            shrink_congestion_window(stream, false);
+        }
+        else
+        {
+            grow_congestion_window(stream, buffers_to_clean);
+        }
+
+        /* reset heartbeat interval */
+        stream->next_heartbeat_tries = 0;
+    }
+}
+
+void uxr_set_output_reliable_stream_congestion_control(uxrOutputReliableStream* stream, bool enable)
+{
+    stream->congestion_control = enable;
+    reset_congestion_window(stream);
+}
+
+void uxr_set_output_reliable_stream_latency(uxrOutputReliableStream* stream, uxrOutputReliableStreamLatency* latency, uxrReliableSlotTiming* slots)
+{
+    stream->latency = latency;
+    if(NULL != latency)
     {
-        stream->last_acknown = uxr_seq_num_add(stream->last_acknown, 1);
-        uint8_t* internal_buffer = uxr_get_output_buffer(stream, stream->last_acknown % stream->history);
-        uxr_set_reliable_buffer_length(internal_buffer, stream->offset); /* clear buffer */
+        latency->slots = slots;
+        for(size_t i = 0; i < stream->history; ++i)
+        {
+            slots[i].sent_timestamp = 0;
+            slots[i].retransmissions = 0;
+        }
+        uxr_reset_histogram(&latency->ack_latency);
+        memset(latency->retransmissions, 0, sizeof(latency->retransmissions));
     }
+}
 
-    stream->send_lost = (0 < bitmap);
+void uxr_register_output_reliable_send(uxrOutputReliableStream* stream, uxrSeqNum seq_num, int64_t timestamp)
+{
+    uxrReliableSlotTiming* slot = &stream->latency->slots[seq_num % stream->history];
+    slot->sent_timestamp = timestamp;
+    slot->retransmissions = 0;
+}
 
-    /* reset heartbeat interval */
-    stream->next_heartbeat_tries = 0;
+void uxr_register_output_reliable_retransmission(uxrOutputReliableStream* stream, uxrSeqNum seq_num)
+{
+    uxrReliableSlotTiming* slot = &stream->latency->slots[seq_num % stream->history];
+    if(UINT16_MAX > slot->retransmissions)
+    {
+        slot->retransmissions++;
+    }
+}
+
+void uxr_register_output_reliable_acks(uxrOutputReliableStream* stream, uxrSeqNum last_acknown, int64_t timestamp)
+{
+    /* Registers the messages acknowledged since last_acknown, that is, after processing an acknack. */
+    while(0 > uxr_seq_num_cmp(last_acknown, stream->last_acknown))
+    {
+        last_acknown = uxr_seq_num_add(last_acknown, 1);
+        uxrReliableSlotTiming* slot = &stream->latency->slots[last_acknown % stream->history];
+        if(0 != slot->sent_timestamp)
+        {
+            int64_t latency = (timestamp - slot->sent_timestamp) / 1000;
+            latency = (0 > latency) ? 0 : latency;
+            uxr_record_histogram_value(&stream->latency->ack_latency, (latency > UINT32_MAX) ? UINT32_MAX : (uint32_t)latency);
+
+            size_t retransmissions = (UXR_RETRANSMISSION_HISTOGRAM_SIZE > slot->retransmissions)
+                                     ? slot->retransmissions
+                                     : UXR_RETRANSMISSION_HISTOGRAM_SIZE - 1;
+            stream->latency->retransmissions[retransmissions]++;
+            slot->sent_timestamp = 0;
+        }
+    }
 }
 
 bool uxr_is_output_up_to_date(const uxrOutputReliableStream* stream)
@@ -231,12 +462,16 @@ bool uxr_is_output_up_to_date(const uxrOutputReliableStream* stream)
 
 uint8_t* uxr_get_output_buffer(const uxrOutputReliableStream* stream, size_t history_pos)
 {
-    return uxr_get_reliable_buffer(stream->buffer, stream->size, stream->history, history_pos);
+    return (NULL != stream->packed)
+           ? stream->buffer + stream->packed[history_pos].start
+           : uxr_get_reliable_buffer(stream->buffer, stream->size, stream->history, history_pos);
 }
 
 size_t uxr_get_output_buffer_size(const uxrOutputReliableStream* stream)
 {
-    return uxr_get_reliable_buffer_size(stream->size, stream->history);
+    return (NULL != stream->packed)
+           ? stream->max_message_size
+           : uxr_get_reliable_buffer_size(stream->size, stream->history);
 }
 
 //==================================================================
@@ -258,3 +493,336 @@ bool on_full_output_buffer(ucdrBuffer* ub, void* args)
     return false;
 }
 
+bool on_full_streamed_buffer(ucdrBuffer* ub, void* args)
+{
+    uxrOutputReliableStream* stream = (uxrOutputReliableStream*) args;
+
+    /* Writing past the last fragment is an error. */
+    return 0 == stream->fragmented_remaining || !claim_fragment_slot(stream, stream->fragmented_offset, ub);
+}
+
+bool claim_fragment_slot(uxrOutputReliableStream* stream, size_t fragment_offset, ucdrBuffer* ub)
+{
+    uxrSeqNum seq_num; size_t length;
+    bool available = next_fragment_slot(stream, fragment_offset, stream->fragmented_remaining, &seq_num, &length)
+                     || (NULL != stream->on_full_history
+                         && stream->on_full_history(stream, stream->on_full_history_args)
+                         && next_fragment_slot(stream, fragment_offset, stream->fragmented_remaining, &seq_num, &length));
+    if(available)
+    {
+        uint8_t* buffer = uxr_get_output_buffer(stream, seq_num % stream->history);
+        size_t final_length = get_buffer_length(stream, seq_num % stream->history);
+
+        stream->last_written = seq_num;
+        stream->fragmented_remaining -= final_length - (length + fragment_offset);
+        stream->fragmented_offset = fragment_offset;
+
+        ucdr_init_buffer_offset(ub, buffer, (uint32_t)final_length, (uint32_t)length);
+        ucdr_set_on_full_buffer_callback(ub, on_full_streamed_buffer, stream);
+        stream->on_new_fragment(ub, stream);
+        store_cursors(stream);
+    }
+
+    return available;
+}
+
+bool next_fragment_slot(uxrOutputReliableStream* stream, size_t fragment_offset, size_t remaining, uxrSeqNum* seq_num, size_t* length)
+{
+    /* The last written slot is still open while it has room for a fragment, or it is the next one to fill
+       after being sent. Out of the window, it still holds an unacknowledged message and must be waited for.
+       The slot found is reserved with the length of the fragment, the previous length is returned. */
+    *seq_num = stream->last_written;
+    *length = get_buffer_length(stream, *seq_num % stream->history);
+    bool in_window = is_in_window(stream, *seq_num);
+    bool available = in_window
+                     && *length + fragment_offset < uxr_get_output_buffer_size(stream)
+                     && reserve_message(stream, *seq_num, *length + fragment_offset + fragment_size(stream, *length, fragment_offset, remaining));
+    if(!available && in_window && stream->offset < *length)
+    {
+        *seq_num = uxr_seq_num_add(*seq_num, 1);
+        *length = stream->offset;
+        available = is_in_window(stream, *seq_num)
+                    && reserve_message(stream, *seq_num, *length + fragment_offset + fragment_size(stream, *length, fragment_offset, remaining));
+    }
+
+    return available;
+}
+
+size_t fragment_size(const uxrOutputReliableStream* stream, size_t length, size_t fragment_offset, size_t remaining)
+{
+    size_t size = uxr_get_output_buffer_size(stream) - (length + fragment_offset);
+    return (remaining < size) ? remaining : size;
+}
+
+bool room_for_fragments(uxrOutputReliableStream* stream, size_t length, size_t fragment_offset)
+{
+    /* Reserves every fragment and undoes it, so the message is not left half written on a full history. */
+    uxrSeqNum last_written = stream->last_written;
+    uxrPackedMessage current = stream->packed[last_written % stream->history];
+
+    bool available = true;
+    size_t remaining = length;
+    while(available && 0 < remaining)
+    {
+        uxrSeqNum seq_num; size_t previous_length;
+        available = next_fragment_slot(stream, fragment_offset, remaining, &seq_num, &previous_length);
+        if(available)
+        {
+            remaining -= get_buffer_length(stream, seq_num % stream->history) - (previous_length + fragment_offset);
+            stream->last_written = seq_num;
+        }
+    }
+
+    while(stream->last_written != last_written)
+    {
+        set_buffer_length(stream, stream->last_written % stream->history, stream->offset);
+        stream->last_written = uxr_seq_num_sub(stream->last_written, 1);
+    }
+    stream->packed[last_written % stream->history] = current;
+
+    return available;
+}
+
+bool is_in_window(const uxrOutputReliableStream* stream, uxrSeqNum seq_num)
+{
+    return 0 >= uxr_seq_num_cmp(seq_num, uxr_seq_num_add(stream->last_acknown, stream->history));
+}
+
+bool reserve_message(uxrOutputReliableStream* stream, uxrSeqNum seq_num, size_t length)
+{
+    bool reserved = true;
+    size_t history_pos = seq_num % stream->history;
+    if(NULL == stream->packed)
+    {
+        uxr_set_reliable_buffer_length(uxr_get_output_buffer(stream, history_pos), length);
+    }
+    else if(stream->offset == stream->packed[history_pos].length)
+    {
+        reserved = place_packed_message(stream, seq_num, length);
+    }
+    else
+    {
+        /* A message only grows in place, up to the oldest message kept when they wrap around the buffer. */
+        uxrSeqNum first = uxr_seq_num_add(stream->last_acknown, 1);
+        size_t start = stream->packed[history_pos].start;
+        size_t tail = stream->packed[first % stream->history].start;
+        size_t limit = (0 > uxr_seq_num_cmp(first, seq_num) && start < tail) ? tail : stream->size;
+        reserved = start + length <= limit;
+        if(reserved)
+        {
+            stream->packed[history_pos].length = (uint16_t)length;
+        }
+    }
+
+    return reserved;
+}
+
+bool place_packed_message(uxrOutputReliableStream* stream, uxrSeqNum seq_num, size_t length)
+{
+    /* The messages kept, from the oldest unacknowledged to the previous one, lie one after another
+       and wrap around the end of the buffer at most once. A new message goes after them, 4-byte aligned. */
+    uxrSeqNum first = uxr_seq_num_add(stream->last_acknown, 1);
+    size_t start = 0;
+    bool placed = length <= stream->size;
+    if(0 > uxr_seq_num_cmp(first, seq_num))
+    {
+        const uxrPackedMessage* previous = &stream->packed[uxr_seq_num_sub(seq_num, 1) % stream->history];
+        size_t tail = stream->packed[first % stream->history].start;
+        size_t end = ((size_t)previous->start + previous->length + 3) & ~(size_t)3;
+        if(previous->start < tail)
+        {
+            start = end;
+            placed = end + length <= tail;
+        }
+        else if(end + length <= stream->size)
+        {
+            start = end;
+        }
+        else
+        {
+            placed = length <= tail;
+        }
+    }
+
+    if(placed)
+    {
+        stream->packed[seq_num % stream->history].start = (uint16_t)start;
+        stream->packed[seq_num % stream->history].length = (uint16_t)length;
+    }
+
+    return placed;
+}
+
+size_t get_buffer_length(const uxrOutputReliableStream* stream, size_t history_pos)
+{
+    return (NULL != stream->packed)
+           ? stream->packed[history_pos].length
+           : uxr_get_reliable_buffer_length(uxr_get_output_buffer(stream, history_pos));
+}
+
+void set_buffer_length(uxrOutputReliableStream* stream, size_t history_pos, size_t length)
+{
+    if(NULL != stream->packed)
+    {
+        stream->packed[history_pos].length = (uint16_t)length;
+    }
+    else
+    {
+        uxr_set_reliable_buffer_length(uxr_get_output_buffer(stream, history_pos), length);
+    }
+}
+
+void clear_stream(uxrOutputReliableStream* stream)
+{
+    for(size_t i = 0; i < stream->history; i++)
+    {
+        if(NULL != stream->packed)
+        {
+            stream->packed[i].start = 0;
+        }
+        set_buffer_length(stream, i, stream->offset);
+    }
+
+    stream->last_written = 0;
+    stream->last_sent = SEQ_NUM_MAX;
+    stream->last_acknown = SEQ_NUM_MAX;
+
+    stream->next_heartbeat_timestamp = INT64_MAX;
+    stream->next_heartbeat_tries = 0;
+    stream->send_lost = false;
+    stream->heartbeat_pending = false;
+    stream->deadline = INT64_MAX;
+    reset_congestion_window(stream);
+    stream->fragmented_remaining = 0;
+    stream->fragmented_offset = 0;
+
+    store_cursors(stream);
+}
+
+void store_cursors(uxrOutputReliableStream* stream)
+{
+    if(NULL != stream->durable)
+    {
+        stream->durable->last_written = stream->last_written;
+        stream->durable->last_sent = stream->last_sent;
+        stream->durable->last_acknown = stream->last_acknown;
+    }
+}
+
+void recover_durable_stream(uxrOutputReliableStream* stream)
+{
+    /* Only the messages already flushed are recovered, the unsent ones could be partially serialized. */
+    size_t pending = uxr_seq_num_sub(stream->last_sent, stream->last_acknown);
+    if(pending > stream->history)
+    {
+        pending = 0;
+    }
+
+    /* Renumber the pending messages from the first sequence number, as expected by a new session. */
+    size_t first_slot = uxr_seq_num_add(stream->last_acknown, 1) % stream->history;
+    if(0 < pending && 0 != first_slot)
+    {
+        rotate_slots(stream, 0, first_slot);
+        rotate_slots(stream, first_slot, stream->history);
+        rotate_slots(stream, 0, stream->history);
+    }
+
+    for(size_t i = pending; i < stream->history; i++)
+    {
+        uint8_t* internal_buffer = uxr_get_output_buffer(stream, i);
+        uxr_set_reliable_buffer_length(internal_buffer, stream->offset);
+    }
+
+    /* The send timestamps of the slots moved are not valid anymore. */
+    if(NULL != stream->latency)
+    {
+        for(size_t i = 0; i < stream->history; i++)
+        {
+            stream->latency->slots[i].sent_timestamp = 0;
+        }
+    }
+
+    /* The pending messages are considered sent, so they will be retransmitted by the heartbeat-acknack mechanism. */
+    stream->last_acknown = SEQ_NUM_MAX;
+    stream->last_sent = uxr_seq_num_sub((uxrSeqNum)pending, 1);
+    stream->last_written = (uxrSeqNum)pending;
+
+    stream->next_heartbeat_timestamp = INT64_MAX;
+    stream->next_heartbeat_tries = 0;
+    stream->send_lost = false;
+    stream->heartbeat_pending = false;
+    stream->deadline = INT64_MAX;
+    reset_congestion_window(stream);
+    stream->fragmented_remaining = 0;
+    stream->fragmented_offset = 0;
+
+    store_cursors(stream);
+}
+
+void rotate_slots(uxrOutputReliableStream* stream, size_t from, size_t to)
+{
+    /* Reverses the order of the slots in [from, to). */
+    size_t slot_size = stream->size / stream->history;
+    while(from + 1 < to)
+    {
+        to--;
+        uint8_t* a = stream->buffer + from * slot_size;
+        uint8_t* b = stream->buffer + to * slot_size;
+        for(size_t i = 0; i < slot_size; i++)
+        {
+            uint8_t aux = a[i];
+            a[i] = b[i];
+            b[i] = aux;
+        }
+        from++;
+    }
+}
+
+uint16_t send_window(const uxrOutputReliableStream* stream)
+{
+    return (stream->congestion_control) ? stream->cwnd : stream->history;
+}
+
+void reset_congestion_window(uxrOutputReliableStream* stream)
+{
+    stream->cwnd = (INITIAL_CONGESTION_WINDOW < stream->history) ? INITIAL_CONGESTION_WINDOW : stream->history;
+    stream->ssthresh = stream->history;
+    stream->cwnd_acked = 0;
+    stream->recovery_seq_num = stream->last_acknown;
+}
+
+void grow_congestion_window(uxrOutputReliableStream* stream, size_t acknowledged)
+{
+    /* Slow start up to the threshold, then one more message per window acknowledged. */
+    size_t cwnd = stream->cwnd;
+    if(cwnd < stream->ssthresh)
+    {
+        cwnd += acknowledged;
+    }
+    else
+    {
+        size_t acked = stream->cwnd_acked + acknowledged;
+        stream->cwnd_acked = (uint16_t)(acked % cwnd);
+        cwnd += acked / cwnd;
+    }
+    stream->cwnd = (uint16_t)((cwnd < stream->history) ? cwnd : stream->history);
+}
+
+void shrink_congestion_window(uxrOutputReliableStream* stream, bool timeout)
+{
+    /* The losses of the messages in flight when it shrank are the same congestion event. */
+    if(0 <= uxr_seq_num_cmp(stream->last_acknown, stream->recovery_seq_num))
+    {
+        stream->ssthresh = (1 < stream->cwnd / 2) ? (uint16_t)(stream->cwnd / 2) : 1;
+        stream->cwnd = stream->ssthresh;
+        stream->cwnd_acked = 0;
+        stream->recovery_seq_num = stream->last_sent;
+    }
+
+    /* Nothing is getting through, start again from one message. */
+    if(timeout)
+    {
+        stream->cwnd = 1;
+        stream->cwnd_acked = 0;
+    }
+}
@@ -29,8 +29,15 @@ extern "C"
 #define HEARTBEAT_PAYLOAD_SIZE 5
 
 void uxr_init_output_reliable_stream(uxrOutputReliableStream* stream, uint8_t* buffer, size_t size, uint16_t history, uint8_t header_offset, OnNewFragment on_new_fragment);
+bool uxr_init_output_durable_stream(uxrOutputReliableStream* stream, uint8_t* memory, size_t size, uint16_t history, uint8_t header_offset, OnNewFragment on_new_fragment);
+void uxr_init_output_packed_stream(uxrOutputReliableStream* stream, uint8_t* memory, size_t size, uint16_t history, size_t max_message_size, uint8_t header_offset, OnNewFragment on_new_fragment);
 void uxr_reset_output_reliable_stream(uxrOutputReliableStream* stream);
 bool uxr_prepare_reliable_buffer_to_write(uxrOutputReliableStream* stream, size_t size, size_t fragment_offset, struct ucdrBuffer* ub);
+bool uxr_prepare_reliable_buffer_to_write_streamed(uxrOutputReliableStream* stream, size_t size, size_t fragment_offset, struct ucdrBuffer* ub,
+                                                    OnFullHistory on_full_history, void* args);
+bool uxr_has_unsent_reliable_buffer(const uxrOutputReliableStream* stream);
+size_t uxr_get_next_reliable_buffer_length(const uxrOutputReliableStream* stream);
+bool uxr_has_pending_reliable_buffer(const uxrOutputReliableStream* stream);
 bool uxr_prepare_next_reliable_buffer_to_send(uxrOutputReliableStream* stream, uint8_t** buffer, size_t* length, uxrSeqNum* seq_num);
 
 bool uxr_update_output_stream_heartbeat_timestamp(uxrOutputReliableStream* stream, int64_t current_timestamp);
@@ -38,6 +45,12 @@ uxrSeqNum uxr_begin_output_nack_buffer_it(const uxrOutputReliableStream* stream)
 bool uxr_next_reliable_nack_buffer_to_send(uxrOutputReliableStream* stream, uint8_t** buffer, size_t *length, uxrSeqNum* seq_num_it);
 void uxr_process_acknack(uxrOutputReliableStream* stream, uint16_t bitmap, uxrSeqNum first_unacked_seq_num);
 
+void uxr_set_output_reliable_stream_congestion_control(uxrOutputReliableStream* stream, bool enable);
+void uxr_set_output_reliable_stream_latency(uxrOutputReliableStream* stream, uxrOutputReliableStreamLatency* latency, uxrReliableSlotTiming* slots);
+void uxr_register_output_reliable_send(uxrOutputReliableStream* stream, uxrSeqNum seq_num, int64_t timestamp);
+void uxr_register_output_reliable_retransmission(uxrOutputReliableStream* stream, uxrSeqNum seq_num);
+void uxr_register_output_reliable_acks(uxrOutputReliableStream* stream, uxrSeqNum last_acknown, int64_t timestamp);
+
 bool uxr_is_output_up_to_date(const uxrOutputReliableStream* stream);
 
 uint8_t* uxr_get_output_buffer(const uxrOutputReliableStream* stream, size_t history_pos);
@@ -4,15 +4,83 @@
 #include "output_best_effort_stream_internal.h"
 #include "output_reliable_stream_internal.h"
 
+#include <string.h>
+
+// Best-effort ids go from 1 to 127 and reliable ones from 128 to 255.
+#define MAX_STREAMS_PER_KIND 127
+
+#ifdef PROFILE_SESSION_STATS
+#define RESET_STREAM_STATS(stream) memset(&(stream)->stats, 0, sizeof((stream)->stats))
+#else
+#define RESET_STREAM_STATS(stream) do {} while(0)
+#endif
+
+/* The kinds whose `CONFIG_MAX_*_STREAMS` is 0 have no embedded array, only the caller-provided ones. */
+#if 0 < UXR_CONFIG_MAX_OUTPUT_BEST_EFFORT_STREAMS
+#define DEFAULT_OUTPUT_BEST_EFFORT(storage) ((storage)->default_output_best_effort)
+#else
+#define DEFAULT_OUTPUT_BEST_EFFORT(storage) NULL
+#endif
+#if 0 < UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS
+#define DEFAULT_OUTPUT_RELIABLE(storage) ((storage)->default_output_reliable)
+#else
+#define DEFAULT_OUTPUT_RELIABLE(storage) NULL
+#endif
+#if 0 < UXR_CONFIG_MAX_INPUT_BEST_EFFORT_STREAMS
+#define DEFAULT_INPUT_BEST_EFFORT(storage) ((storage)->default_input_best_effort)
+#else
+#define DEFAULT_INPUT_BEST_EFFORT(storage) NULL
+#endif
+#if 0 < UXR_CONFIG_MAX_INPUT_RELIABLE_STREAMS
+#define DEFAULT_INPUT_RELIABLE(storage) ((storage)->default_input_reliable)
+#else
+#define DEFAULT_INPUT_RELIABLE(storage) NULL
+#endif
+
+static uint8_t stream_capacity(uint8_t capacity);
+
 //==================================================================
 //                             PUBLIC
 //==================================================================
 void uxr_init_stream_storage(uxrStreamStorage* storage)
 {
+    storage->output_best_effort = DEFAULT_OUTPUT_BEST_EFFORT(storage);
     storage->output_best_effort_size = 0;
+    storage->output_best_effort_capacity = UXR_CONFIG_MAX_OUTPUT_BEST_EFFORT_STREAMS;
+    storage->output_reliable = DEFAULT_OUTPUT_RELIABLE(storage);
     storage->output_reliable_size = 0;
+    storage->output_reliable_capacity = UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS;
+    storage->input_best_effort = DEFAULT_INPUT_BEST_EFFORT(storage);
     storage->input_best_effort_size = 0;
+    storage->input_best_effort_capacity = UXR_CONFIG_MAX_INPUT_BEST_EFFORT_STREAMS;
+    storage->input_reliable = DEFAULT_INPUT_RELIABLE(storage);
     storage->input_reliable_size = 0;
+    storage->input_reliable_capacity = UXR_CONFIG_MAX_INPUT_RELIABLE_STREAMS;
+}
+
+void uxr_set_stream_storage_arrays(uxrStreamStorage* storage, const uxrStreamArrays* arrays)
+{
+    uxr_init_stream_storage(storage);
+    if(NULL != arrays->output_best_effort)
+    {
+        storage->output_best_effort = arrays->output_best_effort;
+        storage->output_best_effort_capacity = stream_capacity(arrays->output_best_effort_capacity);
+    }
+    if(NULL != arrays->output_reliable)
+    {
+        storage->output_reliable = arrays->output_reliable;
+        storage->output_reliable_capacity = stream_capacity(arrays->output_reliable_capacity);
+    }
+    if(NULL != arrays->input_best_effort)
+    {
+        storage->input_best_effort = arrays->input_best_effort;
+        storage->input_best_effort_capacity = stream_capacity(arrays->input_best_effort_capacity);
+    }
+    if(NULL != arrays->input_reliable)
+    {
+        storage->input_reliable = arrays->input_reliable;
+        storage->input_reliable_capacity = stream_capacity(arrays->input_reliable_capacity);
+    }
 }
 
 void uxr_reset_stream_storage(uxrStreamStorage* storage)
@@ -38,40 +106,119 @@ void uxr_reset_stream_storage(uxrStreamStorage* storage)
     }
 }
 
+#ifdef PROFILE_SESSION_STATS
+void uxr_reset_stream_storage_stats(uxrStreamStorage* storage)
+{
+    for(unsigned i = 0; i < storage->output_best_effort_size; ++i)
+    {
+        RESET_STREAM_STATS(&storage->output_best_effort[i]);
+    }
+
+    for(unsigned i = 0; i < storage->input_best_effort_size; ++i)
+    {
+        RESET_STREAM_STATS(&storage->input_best_effort[i]);
+    }
+
+    for(unsigned i = 0; i < storage->output_reliable_size; ++i)
+    {
+        RESET_STREAM_STATS(&storage->output_reliable[i]);
+    }
+
+    for(unsigned i = 0; i < storage->input_reliable_size; ++i)
+    {
+        RESET_STREAM_STATS(&storage->input_reliable[i]);
+    }
+}
+#endif
+
 uxrStreamId uxr_add_output_best_effort_buffer(uxrStreamStorage* storage, uint8_t* buffer, size_t size, uint8_t header_offset)
 {
-    uint8_t index = storage->output_best_effort_size++;
-    //TODO: assert for index
-    uxrOutputBestEffortStream* stream = &storage->output_best_effort[index];
-    uxr_init_output_best_effort_stream(stream, buffer, size, header_offset);
-    return uxr_stream_id(index, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
+    uxrStreamId stream_id = uxr_stream_id_from_raw(0, UXR_OUTPUT_STREAM);
+    if(storage->output_best_effort_size < storage->output_best_effort_capacity)
+    {
+        uint8_t index = storage->output_best_effort_size++;
+        uxrOutputBestEffortStream* stream = &storage->output_best_effort[index];
+        RESET_STREAM_STATS(stream);
+        uxr_init_output_best_effort_stream(stream, buffer, size, header_offset);
+        stream_id = uxr_stream_id(index, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
+    }
+    return stream_id;
 }
 
 uxrStreamId uxr_add_output_reliable_buffer(uxrStreamStorage* storage, uint8_t* buffer, size_t size, uint16_t history, uint8_t header_offset, OnNewFragment on_new_fragment)
 {
-    uint8_t index = storage->output_reliable_size++;
-    //TODO: assert for index
-    uxrOutputReliableStream* stream = &storage->output_reliable[index];
-    uxr_init_output_reliable_stream(stream, buffer, size, history, header_offset, on_new_fragment);
-    return uxr_stream_id(index, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    uxrStreamId stream_id = uxr_stream_id_from_raw(0, UXR_OUTPUT_STREAM);
+    if(storage->output_reliable_size < storage->output_reliable_capacity)
+    {
+        uint8_t index = storage->output_reliable_size++;
+        uxrOutputReliableStream* stream = &storage->output_reliable[index];
+        RESET_STREAM_STATS(stream);
+        uxr_init_output_reliable_stream(stream, buffer, size, history, header_offset, on_new_fragment);
+        stream_id = uxr_stream_id(index, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    }
+    return stream_id;
+}
+
+uxrStreamId uxr_add_output_durable_buffer(uxrStreamStorage* storage, uint8_t* memory, size_t size, uint16_t history, uint8_t header_offset, OnNewFragment on_new_fragment)
+{
+    uxrStreamId stream_id = uxr_stream_id_from_raw(0, UXR_OUTPUT_STREAM);
+    if(storage->output_reliable_size < storage->output_reliable_capacity)
+    {
+        uint8_t index = storage->output_reliable_size;
+        uxrOutputReliableStream* stream = &storage->output_reliable[index];
+        RESET_STREAM_STATS(stream);
+        if(uxr_init_output_durable_stream(stream, memory, size, history, header_offset, on_new_fragment))
+        {
+            storage->output_reliable_size++;
+            stream_id = uxr_stream_id(index, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+        }
+    }
+    return stream_id;
+}
+
+uxrStreamId uxr_add_output_packed_buffer(uxrStreamStorage* storage, uint8_t* memory, size_t size, uint16_t history, size_t max_message_size, uint8_t header_offset, OnNewFragment on_new_fragment)
+{
+    uxrStreamId stream_id = uxr_stream_id_from_raw(0, UXR_OUTPUT_STREAM);
+    if(storage->output_reliable_size < storage->output_reliable_capacity)
+    {
+        uint8_t index = storage->output_reliable_size++;
+        uxrOutputReliableStream* stream = &storage->output_reliable[index];
+        RESET_STREAM_STATS(stream);
+        uxr_init_output_packed_stream(stream, memory, size, history, max_message_size, header_offset, on_new_fragment);
+        stream_id = uxr_stream_id(index, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    }
+    return stream_id;
 }
 
 uxrStreamId uxr_add_input_best_effort_buffer(uxrStreamStorage* storage)
 {
-    uint8_t index = storage->input_best_effort_size++;
-    //TODO: assert for index
-    uxrInputBestEffortStream* stream = &storage->input_best_effort[index];
-    uxr_init_input_best_effort_stream(stream);
-    return uxr_stream_id(index, UXR_BEST_EFFORT_STREAM, UXR_INPUT_STREAM);
+    uxrStreamId stream_id = uxr_stream_id_from_raw(0, UXR_INPUT_STREAM);
+    if(storage->input_best_effort_size < storage->input_best_effort_capacity)
+    {
+        uint8_t index = storage->input_best_effort_size++;
+        uxrInputBestEffortStream* stream = &storage->input_best_effort[index];
+        RESET_STREAM_STATS(stream);
+        uxr_init_input_best_effort_stream(stream);
+        stream_id = uxr_stream_id(index, UXR_BEST_EFFORT_STREAM, UXR_INPUT_STREAM);
+    }
+    return stream_id;
 }
 
 uxrStreamId uxr_add_input_reliable_buffer(uxrStreamStorage* storage, uint8_t* buffer, size_t size, uint16_t history, OnGetFragmentationInfo on_get_fragmentation_info)
 {
-    uint8_t index = storage->input_reliable_size++;
-    //TODO: assert for index
-    uxrInputReliableStream* stream = &storage->input_reliable[index];
-    uxr_init_input_reliable_stream(stream, buffer, size, history, on_get_fragmentation_info);
-    return uxr_stream_id(index, UXR_RELIABLE_STREAM, UXR_INPUT_STREAM);
+    uxrStreamId stream_id = uxr_stream_id_from_raw(0, UXR_INPUT_STREAM);
+    if(storage->input_reliable_size < storage->input_reliable_capacity)
+    {
+        uint8_t index = storage->input_reliable_size;
+        uxrInputReliableStream* stream = &storage->input_reliable[index];
+        RESET_STREAM_STATS(stream);
+        if(uxr_init_input_reliable_stream(stream, buffer, size, history, on_get_fragmentation_info))
+        {
+            storage->input_reliable_size++;
+            stream_id = uxr_stream_id(index, UXR_RELIABLE_STREAM, UXR_INPUT_STREAM);
+        }
+    }
+    return stream_id;
 }
 
 uxrOutputBestEffortStream* uxr_get_output_best_effort_stream(uxrStreamStorage* storage, uint8_t index)
@@ -119,3 +266,11 @@ bool uxr_output_streams_confirmed(const uxrStreamStorage* storage)
     }
     return up_to_date;
 }
+
+//==================================================================
+//                             PRIVATE
+//==================================================================
+uint8_t stream_capacity(uint8_t capacity)
+{
+    return (capacity < MAX_STREAMS_PER_KIND) ? capacity : MAX_STREAMS_PER_KIND;
+}
@@ -29,10 +29,16 @@ extern "C"
 #include <uxr/client/config.h>
 
 void uxr_init_stream_storage(uxrStreamStorage* storage);
+void uxr_set_stream_storage_arrays(uxrStreamStorage* storage, const uxrStreamArrays* arrays);
 void uxr_reset_stream_storage(uxrStreamStorage* storage);
+#ifdef PROFILE_SESSION_STATS
+void uxr_reset_stream_storage_stats(uxrStreamStorage* storage);
+#endif
 
 uxrStreamId uxr_add_output_best_effort_buffer(uxrStreamStorage* storage, uint8_t* buffer, size_t size, uint8_t header_offset);
 uxrStreamId uxr_add_output_reliable_buffer(uxrStreamStorage* storage, uint8_t* buffer, size_t size, uint16_t history, uint8_t header_offset, OnNewFragment on_new_fragment);
+uxrStreamId uxr_add_output_durable_buffer(uxrStreamStorage* storage, uint8_t* memory, size_t size, uint16_t history, uint8_t header_offset, OnNewFragment on_new_fragment);
+uxrStreamId uxr_add_output_packed_buffer(uxrStreamStorage* storage, uint8_t* memory, size_t size, uint16_t history, size_t max_message_size, uint8_t header_offset, OnNewFragment on_new_fragment);
 uxrStreamId uxr_add_input_best_effort_buffer(uxrStreamStorage* storage);
 uxrStreamId uxr_add_input_reliable_buffer(uxrStreamStorage* storage, uint8_t* buffer, size_t size, uint16_t history, OnGetFragmentationInfo on_get_fragmentation_info);
 
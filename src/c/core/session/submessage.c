@@ -16,11 +16,22 @@ bool uxr_buffer_submessage_header(ucdrBuffer* ub, uint8_t submessage_id, uint16_
 
 bool uxr_read_submessage_header(ucdrBuffer* ub, uint8_t* submessage_id, uint16_t* length, uint8_t* flags)
 {
-    ucdr_align_to(ub, 4);
-    bool ready_to_read = ucdr_buffer_remaining(ub) >= SUBHEADER_SIZE;
+    /* A submessage rejected by its decoder leaves the iterator within its payload: stop reading there. */
+    bool ready_to_read = !ub->error;
+    if(ready_to_read)
+    {
+        ucdr_align_to(ub, 4);
+        ready_to_read = ucdr_buffer_remaining(ub) >= SUBHEADER_SIZE;
+    }
+
     if(ready_to_read)
     {
-        uxr_deserialize_submessage_header(ub, submessage_id, flags, length);
+        /* Loaded in place: the remaining size is already checked, and only the length is multibyte, always little endian. */
+        *submessage_id = ub->iterator[0];
+        *flags = ub->iterator[1];
+        *length = (uint16_t)(ub->iterator[2] | (ub->iterator[3] << 8));
+        ub->iterator += SUBHEADER_SIZE;
+        ub->last_data_size = sizeof(uint16_t);
 
         uint8_t endiannes_flag = *flags & FLAG_ENDIANNESS;
         *flags = (uint8_t)(*flags & ~endiannes_flag);
@@ -0,0 +1,198 @@
+#include "time_sync_internal.h"
+
+#define REQUEST_TIMEOUT     100 // ms
+#define MAX_REQUESTS        (2 * UXR_CONFIG_TIME_SYNC_SAMPLES)
+#define MIN_SKEW_SPAN       INT64_C(10000000000) // ns, points closer in time make the offset noise look like skew
+#define MAX_SKEW            0.0005 // 500 ppm, beyond the tolerance of any clock crystal
+
+static void finish_burst(uxrTimeSync* sync, int64_t timestamp);
+static uxrTimeSyncSample filter_samples(uxrTimeSync* sync);
+static void estimate_skew(uxrTimeSync* sync);
+
+//==================================================================
+//                             PUBLIC
+//==================================================================
+void uxr_init_time_sync(uxrTimeSync* sync)
+{
+    sync->sample_count = 0;
+    sync->request_count = 0;
+    sync->active = false;
+
+    sync->point_count = 0;
+    sync->last_point = UXR_CONFIG_TIME_SYNC_HISTORY - 1;
+
+    sync->offset = 0;
+    sync->reference = 0;
+    sync->skew = 0.0;
+
+    sync->period = 0;
+    sync->next_request = INT64_MAX;
+    sync->request_timestamp = 0;
+    sync->request_sent = 0;
+}
+
+void uxr_schedule_time_sync(uxrTimeSync* sync, int64_t period, int64_t timestamp)
+{
+    sync->period = period;
+    if(!sync->active)
+    {
+        sync->next_request = (0 < period) ? timestamp + period : INT64_MAX;
+    }
+}
+
+void uxr_start_time_sync(uxrTimeSync* sync, int64_t timestamp)
+{
+    sync->sample_count = 0;
+    sync->request_count = 0;
+    sync->active = true;
+    sync->next_request = timestamp;
+}
+
+bool uxr_update_time_sync_request(uxrTimeSync* sync, int64_t timestamp)
+{
+    bool must_send = false;
+
+    if(timestamp >= sync->next_request)
+    {
+        if(!sync->active)
+        {
+            uxr_start_time_sync(sync, timestamp);
+        }
+
+        if(MAX_REQUESTS > sync->request_count)
+        {
+            sync->request_count++;
+            sync->next_request = timestamp + REQUEST_TIMEOUT;
+            must_send = true;
+        }
+        else
+        {
+            /* Too many replies lost, the burst is discarded and retried in the next period. */
+            sync->active = false;
+            sync->next_request = (0 < sync->period) ? timestamp + sync->period : INT64_MAX;
+        }
+    }
+
+    return must_send;
+}
+
+bool uxr_add_time_sync_sample(uxrTimeSync* sync, int64_t t0, int64_t t1, int64_t t2, int64_t t3, int64_t timestamp)
+{
+    bool finished = false;
+
+    if(sync->active)
+    {
+        uxrTimeSyncSample* sample = &sync->samples[sync->sample_count++];
+        sample->timestamp = t0 + (t3 - t0) / 2;
+        sample->offset = ((t0 + t3) - (t1 + t2)) / 2;
+        sample->delay = (t3 - t0) - (t2 - t1);
+
+        if(UXR_CONFIG_TIME_SYNC_SAMPLES == sync->sample_count)
+        {
+            finish_burst(sync, timestamp);
+            finished = true;
+        }
+        else
+        {
+            /* Requests are sent one by one, so they do not queue behind each other. */
+            sync->next_request = timestamp;
+        }
+    }
+
+    return finished;
+}
+
+int64_t uxr_time_sync_offset(const uxrTimeSync* sync, int64_t offset, int64_t nanos)
+{
+    return offset + (int64_t)(sync->skew * (double)(nanos - sync->reference));
+}
+
+//==================================================================
+//                             PRIVATE
+//==================================================================
+void finish_burst(uxrTimeSync* sync, int64_t timestamp)
+{
+    sync->last_point = (uint8_t)((sync->last_point + 1) % UXR_CONFIG_TIME_SYNC_HISTORY);
+    sync->points[sync->last_point] = filter_samples(sync);
+    if(UXR_CONFIG_TIME_SYNC_HISTORY > sync->point_count)
+    {
+        sync->point_count++;
+    }
+
+    estimate_skew(sync);
+
+    sync->active = false;
+    sync->next_request = (0 < sync->period) ? timestamp + sync->period : INT64_MAX;
+}
+
+uxrTimeSyncSample filter_samples(uxrTimeSync* sync)
+{
+    /* The samples with lower round trip time are the less affected by queuing and asymmetry. */
+    for(uint8_t i = 1; i < sync->sample_count; ++i)
+    {
+        uxrTimeSyncSample sample = sync->samples[i];
+        uint8_t j = i;
+        for(; 0 < j && sync->samples[j - 1].delay > sample.delay; --j)
+        {
+            sync->samples[j] = sync->samples[j - 1];
+        }
+        sync->samples[j] = sample;
+    }
+
+    uint8_t kept = (uint8_t)((sync->sample_count + 3) / 4);
+    uxrTimeSyncSample point = sync->samples[0];
+    int64_t timestamp_sum = 0;
+    int64_t offset_sum = 0;
+    for(uint8_t i = 0; i < kept; ++i)
+    {
+        timestamp_sum += sync->samples[i].timestamp - point.timestamp;
+        offset_sum += sync->samples[i].offset - point.offset;
+    }
+    point.timestamp += timestamp_sum / kept;
+    point.offset += offset_sum / kept;
+
+    return point;
+}
+
+void estimate_skew(uxrTimeSync* sync)
+{
+    /* Least squares fit of the offset along the local time, relative to the last point to keep the precision. */
+    const uxrTimeSyncSample* last = &sync->points[sync->last_point];
+    double mean_timestamp = 0.0;
+    double mean_offset = 0.0;
+    for(uint8_t i = 0; i < sync->point_count; ++i)
+    {
+        mean_timestamp += (double)(sync->points[i].timestamp - last->timestamp);
+        mean_offset += (double)(sync->points[i].offset - last->offset);
+    }
+    mean_timestamp /= sync->point_count;
+    mean_offset /= sync->point_count;
+
+    double covariance = 0.0;
+    double variance = 0.0;
+    int64_t first_timestamp = last->timestamp;
+    for(uint8_t i = 0; i < sync->point_count; ++i)
+    {
+        double dt = (double)(sync->points[i].timestamp - last->timestamp) - mean_timestamp;
+        double doffset = (double)(sync->points[i].offset - last->offset) - mean_offset;
+        covariance += dt * doffset;
+        variance += dt * dt;
+        if(sync->points[i].timestamp < first_timestamp)
+        {
+            first_timestamp = sync->points[i].timestamp;
+        }
+    }
+
+    double skew = (MIN_SKEW_SPAN <= last->timestamp - first_timestamp) ? covariance / variance : 0.0;
+    if(MAX_SKEW < skew)
+    {
+        skew = MAX_SKEW;
+    }
+    else if(-MAX_SKEW > skew)
+    {
+        skew = -MAX_SKEW;
+    }
+    sync->skew = skew;
+    sync->reference = last->timestamp;
+    sync->offset = last->offset + (int64_t)(mean_offset - sync->skew * mean_timestamp);
+}
@@ -0,0 +1,38 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _SRC_C_CORE_SESSION_TIME_SYNC_INTERNAL_H_
+#define _SRC_C_CORE_SESSION_TIME_SYNC_INTERNAL_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <uxr/client/core/session/time_sync.h>
+
+void uxr_init_time_sync(uxrTimeSync* sync);
+void uxr_schedule_time_sync(uxrTimeSync* sync, int64_t period, int64_t timestamp);
+void uxr_start_time_sync(uxrTimeSync* sync, int64_t timestamp);
+
+bool uxr_update_time_sync_request(uxrTimeSync* sync, int64_t timestamp);
+bool uxr_add_time_sync_sample(uxrTimeSync* sync, int64_t t0, int64_t t1, int64_t t2, int64_t t3, int64_t timestamp);
+
+int64_t uxr_time_sync_offset(const uxrTimeSync* sync, int64_t offset, int64_t nanos);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SRC_C_CORE_SESSION_TIME_SYNC_INTERNAL_H_
@@ -7,6 +7,8 @@
 
 #define WRITE_DATA_PAYLOAD_SIZE 4
 
+static void write_data_payload(uxrSession* session, uxrObjectId datawriter_id, ucdrBuffer* ub);
+
 //==================================================================
 //                             PUBLIC
 //==================================================================
@@ -17,13 +19,34 @@ bool uxr_prepare_output_stream(uxrSession* session, uxrStreamId stream_id, uxrOb
     ub->error = !uxr_prepare_stream_to_write_submessage(session, stream_id, payload_size, ub, SUBMESSAGE_ID_WRITE_DATA, FORMAT_DATA);
     if(!ub->error)
     {
-        WRITE_DATA_Payload_Data payload;
-        uxr_init_base_object_request(&session->info, datawriter_id, &payload.base);
-        (void) uxr_serialize_WRITE_DATA_Payload_Data(ub, &payload);
+        write_data_payload(session, datawriter_id, ub);
+    }
+
+    return !ub->error;
+}
 
-        ub->last_data_size = 8; //reset alignment (as if we were created a new ucdrBuffer)
+bool uxr_prepare_output_stream_fragmented(uxrSession* session, uxrStreamId stream_id, uxrObjectId datawriter_id,
+                                          ucdrBuffer* ub, size_t topic_size, uxrOnBuffersFull flush_callback)
+{
+    size_t payload_size = WRITE_DATA_PAYLOAD_SIZE + topic_size;
+    ub->error = !uxr_prepare_stream_to_write_fragmented_submessage(session, stream_id, payload_size, ub, SUBMESSAGE_ID_WRITE_DATA, FORMAT_DATA, flush_callback);
+    if(!ub->error)
+    {
+        write_data_payload(session, datawriter_id, ub);
     }
 
     return !ub->error;
 }
 
+//==================================================================
+//                             PRIVATE
+//==================================================================
+void write_data_payload(uxrSession* session, uxrObjectId datawriter_id, ucdrBuffer* ub)
+{
+    WRITE_DATA_Payload_Data payload;
+    uxr_init_base_object_request(&session->info, datawriter_id, &payload.base);
+    (void) uxr_serialize_WRITE_DATA_Payload_Data(ub, &payload);
+
+    ub->last_data_size = 8; //reset alignment (as if we were created a new ucdrBuffer)
+}
+
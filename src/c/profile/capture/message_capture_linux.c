@@ -0,0 +1,227 @@
+#include <uxr/client/profile/capture/message_capture.h>
+#include <uxr/client/util/time.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+
+#define WRITER_PERIOD_NS        1000000
+#define RECORD_ALIGNMENT        8
+#define PCAPNG_ALIGNMENT        4
+
+#define SHB_TYPE                0x0A0D0D0A
+#define IDB_TYPE                0x00000001
+#define EPB_TYPE                0x00000006
+#define BYTE_ORDER_MAGIC        0x1A2B3C4D
+#define OPTION_END              0
+#define OPTION_IF_TSRESOL       9
+#define OPTION_EPB_FLAGS        2
+#define EPB_HEADER_SIZE         28
+#define EPB_TRAILER_SIZE        16
+
+#define ALIGN_UP(value, alignment) (((value) + (alignment) - 1) & ~((size_t)(alignment) - 1))
+
+typedef struct CaptureRecord
+{
+    uint32_t length;
+    uint32_t flags;
+    int64_t timestamp;
+
+} CaptureRecord;
+
+static void capture_message(uxrSession* session, bool output, const uint8_t* buffer, size_t length, void* args);
+static void* writer_thread(void* args);
+static bool drain_ring(uxrMessageCapture* capture);
+static bool write_packet(uxrMessageCapture* capture, size_t position, const CaptureRecord* record);
+static bool write_file_header(int fd);
+static void write_ring(uxrMessageCapture* capture, size_t position, const void* data, size_t length);
+static void read_ring(const uxrMessageCapture* capture, size_t position, void* data, size_t length);
+
+//==================================================================
+//                             PUBLIC
+//==================================================================
+bool uxr_start_message_capture(uxrMessageCapture* capture, uxrSession* session, const char* path, uint8_t* buffer, size_t size)
+{
+    bool rv = false;
+
+    if (NULL != buffer && 0 != size && 0 == (size & (size - 1)))
+    {
+        capture->buffer = buffer;
+        capture->size = size;
+        capture->head = 0;
+        capture->tail = 0;
+        capture->dropped = 0;
+        capture->running = true;
+
+        capture->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        if (-1 != capture->fd)
+        {
+            if (write_file_header(capture->fd) && 0 == pthread_create(&capture->writer, NULL, writer_thread, capture))
+            {
+                uxr_set_message_callback(session, capture_message, capture);
+                rv = true;
+            }
+            else
+            {
+                close(capture->fd);
+            }
+        }
+    }
+
+    return rv;
+}
+
+bool uxr_stop_message_capture(uxrMessageCapture* capture, uxrSession* session)
+{
+    uxr_set_message_callback(session, NULL, NULL);
+
+    __atomic_store_n(&capture->running, false, __ATOMIC_RELEASE);
+    bool rv = (0 == pthread_join(capture->writer, NULL));
+
+    /* The messages queued after the last drain of the writer thread. */
+    rv = drain_ring(capture) && rv;
+    rv = (0 == close(capture->fd)) && rv;
+
+    return rv;
+}
+
+//==================================================================
+//                             PRIVATE
+//==================================================================
+void capture_message(uxrSession* session, bool output, const uint8_t* buffer, size_t length, void* args)
+{
+    uxrMessageCapture* capture = (uxrMessageCapture*)args;
+
+    CaptureRecord record;
+    record.length = (uint32_t)length;
+    record.flags = (output) ? UXR_CAPTURE_OUTBOUND : UXR_CAPTURE_INBOUND;
+    record.timestamp = (output) ? uxr_nanos() : uxr_message_timestamp(session);
+
+    /* Single producer: only the head is owned by the session, the tail is released by the writer. */
+    size_t record_size = sizeof(CaptureRecord) + ALIGN_UP(length, RECORD_ALIGNMENT);
+    size_t head = capture->head;
+    size_t tail = __atomic_load_n(&capture->tail, __ATOMIC_ACQUIRE);
+    if (capture->size - (head - tail) >= record_size)
+    {
+        write_ring(capture, head, &record, sizeof(CaptureRecord));
+        write_ring(capture, head + sizeof(CaptureRecord), buffer, length);
+        __atomic_store_n(&capture->head, head + record_size, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        __atomic_fetch_add(&capture->dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void* writer_thread(void* args)
+{
+    uxrMessageCapture* capture = (uxrMessageCapture*)args;
+    struct timespec period = {0, WRITER_PERIOD_NS};
+
+    while (__atomic_load_n(&capture->running, __ATOMIC_ACQUIRE))
+    {
+        (void) drain_ring(capture);
+        nanosleep(&period, NULL);
+    }
+
+    return NULL;
+}
+
+bool drain_ring(uxrMessageCapture* capture)
+{
+    bool rv = true;
+
+    size_t tail = capture->tail;
+    size_t head = __atomic_load_n(&capture->head, __ATOMIC_ACQUIRE);
+    while (tail != head)
+    {
+        CaptureRecord record;
+        read_ring(capture, tail, &record, sizeof(CaptureRecord));
+        rv = write_packet(capture, tail + sizeof(CaptureRecord), &record) && rv;
+
+        tail += sizeof(CaptureRecord) + ALIGN_UP(record.length, RECORD_ALIGNMENT);
+        __atomic_store_n(&capture->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    return rv;
+}
+
+bool write_packet(uxrMessageCapture* capture, size_t position, const CaptureRecord* record)
+{
+    size_t padded_length = ALIGN_UP(record->length, PCAPNG_ALIGNMENT);
+    uint32_t block_length = (uint32_t)(EPB_HEADER_SIZE + padded_length + EPB_TRAILER_SIZE);
+
+    uint32_t header[EPB_HEADER_SIZE / sizeof(uint32_t)];
+    header[0] = EPB_TYPE;
+    header[1] = block_length;
+    header[2] = 0; // interface
+    header[3] = (uint32_t)((uint64_t)record->timestamp >> 32);
+    header[4] = (uint32_t)record->timestamp;
+    header[5] = record->length;
+    header[6] = record->length;
+
+    uint8_t trailer[PCAPNG_ALIGNMENT + EPB_TRAILER_SIZE] = {0};
+    size_t padding = padded_length - record->length;
+    uint16_t option_header[2] = {OPTION_EPB_FLAGS, sizeof(uint32_t)};
+    memcpy(trailer + padding, option_header, sizeof(option_header));
+    memcpy(trailer + padding + 4, &record->flags, sizeof(uint32_t));
+    memcpy(trailer + padding + 12, &block_length, sizeof(uint32_t));
+
+    /* The payload is written from the ring, in two pieces when it wraps. */
+    size_t index = position & (capture->size - 1);
+    size_t first = capture->size - index;
+    first = (first < record->length) ? first : record->length;
+
+    struct iovec iov[4];
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = capture->buffer + index;
+    iov[1].iov_len = first;
+    iov[2].iov_base = capture->buffer;
+    iov[2].iov_len = record->length - first;
+    iov[3].iov_base = trailer;
+    iov[3].iov_len = padding + EPB_TRAILER_SIZE;
+
+    return (ssize_t)block_length == writev(capture->fd, iov, 4);
+}
+
+bool write_file_header(int fd)
+{
+    uint32_t section[7] = {SHB_TYPE, 28, BYTE_ORDER_MAGIC, 1, 0xFFFFFFFF, 0xFFFFFFFF, 28};
+    uint16_t version[2] = {1, 0}; // major, minor
+    memcpy(&section[3], version, sizeof(version));
+
+    /* Nanosecond resolution, so the timestamps are written as taken. */
+    uint32_t interface[8] = {IDB_TYPE, 32, 0, 0, 0, 0, OPTION_END, 32};
+    uint16_t link_type[2] = {UXR_CAPTURE_LINKTYPE, 0}; // link type, reserved
+    uint16_t tsresol_option[2] = {OPTION_IF_TSRESOL, 1};
+    uint8_t tsresol = 9;
+    memcpy(&interface[2], link_type, sizeof(link_type));
+    memcpy(&interface[4], tsresol_option, sizeof(tsresol_option));
+    memcpy(&interface[5], &tsresol, sizeof(tsresol));
+
+    return sizeof(section) == write(fd, section, sizeof(section))
+           && sizeof(interface) == write(fd, interface, sizeof(interface));
+}
+
+void write_ring(uxrMessageCapture* capture, size_t position, const void* data, size_t length)
+{
+    size_t index = position & (capture->size - 1);
+    size_t first = capture->size - index;
+    first = (first < length) ? first : length;
+    memcpy(capture->buffer + index, data, first);
+    memcpy(capture->buffer, (const uint8_t*)data + first, length - first);
+}
+
+void read_ring(const uxrMessageCapture* capture, size_t position, void* data, size_t length)
+{
+    size_t index = position & (capture->size - 1);
+    size_t first = capture->size - index;
+    first = (first < length) ? first : length;
+    memcpy(data, capture->buffer + index, first);
+    memcpy((uint8_t*)data + first, capture->buffer, length - first);
+}
@@ -0,0 +1,50 @@
+#include <uxr/client/profile/storage/durable_history.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+bool uxr_open_durable_history(uxrDurableHistory* durable, const char* path, size_t size)
+{
+    bool rv = false;
+
+    durable->fd = open(path, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (-1 != durable->fd)
+    {
+        /* A file with other size is truncated, so its content is discarded as unrecoverable. */
+        struct stat file_stat;
+        bool same_size = (0 == fstat(durable->fd, &file_stat)) && ((off_t)size == file_stat.st_size);
+        if (same_size || (0 == ftruncate(durable->fd, 0) && 0 == ftruncate(durable->fd, (off_t)size)))
+        {
+            void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, durable->fd, 0);
+            if (MAP_FAILED != memory)
+            {
+                durable->memory = (uint8_t*)memory;
+                durable->size = size;
+                rv = true;
+            }
+        }
+
+        if (!rv)
+        {
+            close(durable->fd);
+            durable->fd = -1;
+        }
+    }
+    return rv;
+}
+
+bool uxr_sync_durable_history(uxrDurableHistory* durable)
+{
+    return 0 == msync(durable->memory, durable->size, MS_SYNC);
+}
+
+bool uxr_close_durable_history(uxrDurableHistory* durable)
+{
+    bool rv = (0 == munmap(durable->memory, durable->size));
+    rv = (0 == close(durable->fd)) && rv;
+    durable->fd = -1;
+    return rv;
+}
@@ -109,6 +109,7 @@ bool uxr_init_serial_transport(uxrSerialTransport* transport,
         transport->comm.send_msg = send_serial_msg;
         transport->comm.recv_msg = recv_serial_msg;
         transport->comm.comm_error = get_serial_error;
+        transport->comm.msg_timestamps = NULL;
         transport->comm.mtu = UXR_CONFIG_SERIAL_TRANSPORT_MTU;
 
         rv = true;
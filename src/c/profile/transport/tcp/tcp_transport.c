@@ -295,6 +295,7 @@ bool uxr_init_tcp_transport(uxrTCPTransport* transport, struct uxrTCPPlatform* p
         transport->comm.send_msg = send_tcp_msg;
         transport->comm.recv_msg = recv_tcp_msg;
         transport->comm.comm_error = get_tcp_error;
+        transport->comm.msg_timestamps = NULL;
         transport->comm.mtu = UXR_CONFIG_TCP_TRANSPORT_MTU;
         transport->input_buffer.state = UXR_TCP_BUFFER_EMPTY;
         rv = true;
@@ -2,6 +2,7 @@
 #include "tcp_transport_internal.h"
 
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
@@ -41,6 +42,13 @@ bool uxr_init_tcp_platform(struct uxrTCPPlatform* platform, const char* ip, uint
                                 &platform->remote_addr,
                                 sizeof(platform->remote_addr));
         rv = (0 == connected);
+
+        /* The length goes in its own segment before the message, which Nagle would hold until acknowledged. */
+        if (rv)
+        {
+            int nodelay = 1;
+            (void) setsockopt(platform->poll_fd.fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        }
     }
     return rv;
 }
@@ -33,6 +33,13 @@ bool uxr_init_tcp_platform(struct uxrTCPPlatform* platform, const char* ip, uint
                                 &platform->remote_addr,
                                 sizeof(platform->remote_addr));
         rv = (SOCKET_ERROR != connected);
+
+        /* The length goes in its own segment before the message, which Nagle would hold until acknowledged. */
+        if (rv)
+        {
+            int nodelay = 1;
+            (void) setsockopt(platform->poll_fd.fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+        }
     }
     return rv;
 }
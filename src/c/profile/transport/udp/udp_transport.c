@@ -11,6 +11,7 @@ static uint8_t error_code;
 static bool send_udp_msg(void* instance, const uint8_t* buf, size_t len);
 static bool recv_udp_msg(void* instance, uint8_t** buf, size_t* len, int timeout);
 static uint8_t get_udp_error(void);
+static bool get_udp_timestamps(void* instance, int64_t* sent, int64_t* received);
 
 /*******************************************************************************
  * Private function definitions.
@@ -62,6 +63,12 @@ static uint8_t get_udp_error(void)
     return error_code;
 }
 
+static bool get_udp_timestamps(void* instance, int64_t* sent, int64_t* received)
+{
+    uxrUDPTransport* transport = (uxrUDPTransport*)instance;
+    return uxr_get_udp_timestamps_platform(transport->platform, sent, received);
+}
+
 /*******************************************************************************
  * Public function definitions.
  *******************************************************************************/
@@ -79,12 +86,23 @@ bool uxr_init_udp_transport(uxrUDPTransport* transport, struct uxrUDPPlatform* p
         transport->comm.send_msg = send_udp_msg;
         transport->comm.recv_msg = recv_udp_msg;
         transport->comm.comm_error = get_udp_error;
+        transport->comm.msg_timestamps = NULL;
         transport->comm.mtu = UXR_CONFIG_UDP_TRANSPORT_MTU;
         rv = true;
     }
     return rv;
 }
 
+bool uxr_enable_udp_timestamping(uxrUDPTransport* transport, bool hardware)
+{
+    bool rv = uxr_enable_udp_timestamping_platform(transport->platform, hardware);
+    if (rv)
+    {
+        transport->comm.msg_timestamps = get_udp_timestamps;
+    }
+    return rv;
+}
+
 bool uxr_close_udp_transport(uxrUDPTransport* transport)
 {
     return uxr_close_udp_platform(transport->platform);
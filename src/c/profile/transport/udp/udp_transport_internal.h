@@ -25,6 +25,9 @@ extern "C"
 bool uxr_init_udp_platform(struct uxrUDPPlatform* platform, const char* ip, uint16_t port);
 bool uxr_close_udp_platform(struct uxrUDPPlatform* platform);
 
+bool uxr_enable_udp_timestamping_platform(struct uxrUDPPlatform* platform, bool hardware);
+bool uxr_get_udp_timestamps_platform(struct uxrUDPPlatform* platform, int64_t* sent, int64_t* received);
+
 size_t uxr_write_udp_data_platform(struct uxrUDPPlatform* platform,
                                    const uint8_t* buf,
                                    size_t len,
@@ -1,15 +1,32 @@
 #include <uxr/client/profile/transport/udp/udp_transport_linux.h>
 #include "udp_transport_internal.h"
+#include <uxr/client/util/time.h>
 
 #include <arpa/inet.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
+
+#define TIMESTAMPING_NONE       0
+#define TIMESTAMPING_SOFTWARE   1
+#define TIMESTAMPING_HARDWARE   2
+
+#define TIMESTAMPING_CONTROL_SIZE 256
+
+static int64_t read_timestamp(struct msghdr* msg, uint8_t timestamping);
+static void read_sent_timestamp(uxrUDPPlatform* platform);
 
 bool uxr_init_udp_platform(uxrUDPPlatform* platform, const char* ip, uint16_t port)
 {
     bool rv = false;
 
+    platform->timestamping = TIMESTAMPING_NONE;
+    platform->sent_timestamp = 0;
+    platform->received_timestamp = 0;
+
     /* Socket initialization */
     platform->poll_fd.fd = socket(PF_INET, SOCK_DGRAM, 0);
     if (-1 != platform->poll_fd.fd)
@@ -36,14 +53,54 @@ bool uxr_close_udp_platform(uxrUDPPlatform* platform)
     return (-1 == platform->poll_fd.fd) ? true : (0 == close(platform->poll_fd.fd));
 }
 
+bool uxr_enable_udp_timestamping_platform(uxrUDPPlatform* platform, bool hardware)
+{
+    /* The hardware timestamps are only meaningful if the NIC clock is synchronized with the system clock. */
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE
+              | SOF_TIMESTAMPING_TX_SOFTWARE
+              | SOF_TIMESTAMPING_SOFTWARE
+              | SOF_TIMESTAMPING_OPT_TSONLY;
+    if (hardware)
+    {
+        flags |= SOF_TIMESTAMPING_RX_HARDWARE
+               | SOF_TIMESTAMPING_TX_HARDWARE
+               | SOF_TIMESTAMPING_RAW_HARDWARE;
+    }
+
+    bool rv = (0 == setsockopt(platform->poll_fd.fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)));
+    if (rv)
+    {
+        platform->timestamping = hardware ? TIMESTAMPING_HARDWARE : TIMESTAMPING_SOFTWARE;
+    }
+    return rv;
+}
+
+bool uxr_get_udp_timestamps_platform(uxrUDPPlatform* platform, int64_t* sent, int64_t* received)
+{
+    *sent = platform->sent_timestamp;
+    *received = platform->received_timestamp;
+    return TIMESTAMPING_NONE != platform->timestamping;
+}
+
 size_t uxr_write_udp_data_platform(uxrUDPPlatform* platform, const uint8_t* buf, size_t len, uint8_t* errcode)
 {
     size_t rv = 0;
+    if (TIMESTAMPING_NONE != platform->timestamping)
+    {
+        /* Discards the timestamps of previous messages, so the next one belongs to this message. */
+        read_sent_timestamp(platform);
+        platform->sent_timestamp = 0;
+    }
+
     ssize_t bytes_sent = send(platform->poll_fd.fd, (void*)buf, len, 0);
     if (-1 != bytes_sent)
     {
         rv = (size_t)bytes_sent;
         *errcode = 0;
+        if (TIMESTAMPING_NONE != platform->timestamping)
+        {
+            read_sent_timestamp(platform);
+        }
     }
     else
     {
@@ -55,10 +112,45 @@ size_t uxr_write_udp_data_platform(uxrUDPPlatform* platform, const uint8_t* buf,
 size_t uxr_read_udp_data_platform(uxrUDPPlatform* platform, uint8_t* buf, size_t len, int timeout, uint8_t* errcode)
 {
     size_t rv = 0;
+    int64_t deadline = uxr_millis() + timeout;
     int poll_rv = poll(&platform->poll_fd, 1, timeout);
+    while (TIMESTAMPING_NONE != platform->timestamping && 0 < poll_rv && !(POLLIN & platform->poll_fd.revents))
+    {
+        /* A pending sent timestamp wakes up the poll, it is consumed and the poll resumed for the remaining time. */
+        read_sent_timestamp(platform);
+        if (0 > timeout)
+        {
+            poll_rv = poll(&platform->poll_fd, 1, timeout);
+        }
+        else
+        {
+            int64_t remaining = deadline - uxr_millis();
+            poll_rv = (0 < remaining) ? poll(&platform->poll_fd, 1, (int)remaining) : 0;
+        }
+    }
+
     if (0 < poll_rv)
     {
-        ssize_t bytes_received = recv(platform->poll_fd.fd, (void*)buf, len, 0);
+        ssize_t bytes_received;
+        if (TIMESTAMPING_NONE != platform->timestamping)
+        {
+            uint8_t control[TIMESTAMPING_CONTROL_SIZE];
+            struct iovec iov = {(void*)buf, len};
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+
+            bytes_received = recvmsg(platform->poll_fd.fd, &msg, MSG_DONTWAIT);
+            platform->received_timestamp = (-1 != bytes_received) ? read_timestamp(&msg, platform->timestamping) : 0;
+        }
+        else
+        {
+            bytes_received = recv(platform->poll_fd.fd, (void*)buf, len, 0);
+        }
+
         if (-1 != bytes_received)
         {
             rv = (size_t)bytes_received;
@@ -66,7 +158,8 @@ size_t uxr_read_udp_data_platform(uxrUDPPlatform* platform, uint8_t* buf, size_t
         }
         else
         {
-            *errcode = 1;
+            /* Nothing to read is not an error, but a timeout. */
+            *errcode = (EAGAIN == errno || EWOULDBLOCK == errno) ? 0 : 1;
         }
     }
     else
@@ -75,3 +168,46 @@ size_t uxr_read_udp_data_platform(uxrUDPPlatform* platform, uint8_t* buf, size_t
     }
     return rv;
 }
+
+int64_t read_timestamp(struct msghdr* msg, uint8_t timestamping)
+{
+    int64_t rv = 0;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg); NULL != cmsg; cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+        if (SOL_SOCKET == cmsg->cmsg_level && SO_TIMESTAMPING == cmsg->cmsg_type)
+        {
+            /* The first timestamp is the software one and the third one the raw hardware one. */
+            struct timespec ts[3];
+            memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+            struct timespec* chosen = (TIMESTAMPING_HARDWARE == timestamping && (0 != ts[2].tv_sec || 0 != ts[2].tv_nsec))
+                                    ? &ts[2]
+                                    : &ts[0];
+            rv = (int64_t)chosen->tv_sec * 1000000000 + chosen->tv_nsec;
+        }
+    }
+    return rv;
+}
+
+void read_sent_timestamp(uxrUDPPlatform* platform)
+{
+    uint8_t control[TIMESTAMPING_CONTROL_SIZE];
+    struct msghdr msg;
+    ssize_t received;
+    do
+    {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        received = recvmsg(platform->poll_fd.fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+        if (-1 != received)
+        {
+            int64_t timestamp = read_timestamp(&msg, platform->timestamping);
+            if (0 != timestamp)
+            {
+                platform->sent_timestamp = timestamp;
+            }
+        }
+    }
+    while (-1 != received);
+}
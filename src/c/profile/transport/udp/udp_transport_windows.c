@@ -40,6 +40,20 @@ bool uxr_close_udp_platform(uxrUDPPlatform* platform)
     return (0 == WSACleanup()) && rv;
 }
 
+bool uxr_enable_udp_timestamping_platform(uxrUDPPlatform* platform, bool hardware)
+{
+    (void) platform; (void) hardware;
+    return false;
+}
+
+bool uxr_get_udp_timestamps_platform(uxrUDPPlatform* platform, int64_t* sent, int64_t* received)
+{
+    (void) platform;
+    *sent = 0;
+    *received = 0;
+    return false;
+}
+
 size_t uxr_write_udp_data_platform(uxrUDPPlatform* platform, const uint8_t* buf, size_t len, uint8_t* errcode)
 {
     size_t rv = 0;
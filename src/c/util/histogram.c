@@ -0,0 +1,86 @@
+#include <uxr/client/util/histogram.h>
+
+#include <string.h>
+
+#define SUB_BUCKETS ((uint32_t)1 << UXR_HISTOGRAM_SUB_BUCKET_BITS)
+
+static uint32_t bucket_index(uint32_t value);
+static uint32_t bucket_highest_value(uint32_t index);
+
+//==================================================================
+//                             PUBLIC
+//==================================================================
+void uxr_reset_histogram(uxrHistogram* histogram)
+{
+    memset(histogram->counts, 0, sizeof(histogram->counts));
+    histogram->total = 0;
+    histogram->min = UINT32_MAX;
+    histogram->max = 0;
+}
+
+void uxr_record_histogram_value(uxrHistogram* histogram, uint32_t value)
+{
+    histogram->counts[bucket_index(value)]++;
+    histogram->total++;
+    histogram->min = (value < histogram->min) ? value : histogram->min;
+    histogram->max = (value > histogram->max) ? value : histogram->max;
+}
+
+uint32_t uxr_histogram_percentile(const uxrHistogram* histogram, double percentile)
+{
+    uint32_t rv = 0;
+    if(0 < histogram->total)
+    {
+        double rank = (percentile / 100.0) * (double)histogram->total;
+        uint32_t count_to_reach = (rank < 1.0) ? 1 : (uint32_t)(rank + 0.5);
+        count_to_reach = (count_to_reach > histogram->total) ? histogram->total : count_to_reach;
+
+        uint32_t count = 0;
+        uint32_t index = 0;
+        for(; index < UXR_HISTOGRAM_SIZE; ++index)
+        {
+            count += histogram->counts[index];
+            if(count >= count_to_reach)
+            {
+                break;
+            }
+        }
+
+        rv = bucket_highest_value(index);
+        rv = (rv > histogram->max) ? histogram->max : rv;
+        rv = (rv < histogram->min) ? histogram->min : rv;
+    }
+    return rv;
+}
+
+//==================================================================
+//                             PRIVATE
+//==================================================================
+uint32_t bucket_index(uint32_t value)
+{
+    uint32_t index = value;
+    if(SUB_BUCKETS <= value)
+    {
+        uint32_t magnitude = 0;
+        for(uint32_t aux = value; 1 < aux; aux >>= 1)
+        {
+            magnitude++;
+        }
+        uint32_t shift = magnitude - UXR_HISTOGRAM_SUB_BUCKET_BITS;
+        index = ((shift + 1) << UXR_HISTOGRAM_SUB_BUCKET_BITS) + ((value >> shift) - SUB_BUCKETS);
+    }
+    return index;
+}
+
+uint32_t bucket_highest_value(uint32_t index)
+{
+    uint32_t value = index;
+    if(SUB_BUCKETS <= index)
+    {
+        uint32_t shift = (index >> UXR_HISTOGRAM_SUB_BUCKET_BITS) - 1;
+        uint64_t lowest = (uint64_t)(SUB_BUCKETS + (index & (SUB_BUCKETS - 1))) << shift;
+        uint64_t highest = lowest + ((uint64_t)1 << shift) - 1;
+        value = (highest > UINT32_MAX) ? UINT32_MAX : (uint32_t)highest;
+    }
+    return value;
+}
@@ -0,0 +1,62 @@
+#include <uxr/client/util/token_bucket.h>
+
+#define TOKENS_PER_BYTE 1000
+
+static void refill(uxrTokenBucket* bucket, int64_t timestamp);
+
+//==================================================================
+//                             PUBLIC
+//==================================================================
+void uxr_init_token_bucket(uxrTokenBucket* bucket, uint32_t rate, uint32_t burst)
+{
+    bucket->rate = rate;
+    bucket->burst = burst;
+    bucket->tokens = (int64_t)burst * TOKENS_PER_BYTE;
+    bucket->timestamp = INT64_MIN;
+}
+
+int64_t uxr_token_bucket_delay(uxrTokenBucket* bucket, size_t size, int64_t timestamp)
+{
+    int64_t delay = 0;
+    if(0 != bucket->rate)
+    {
+        refill(bucket, timestamp);
+
+        /* A message larger than the burst only needs a full bucket, the debt is paid afterwards. */
+        int64_t needed = (int64_t)((size < bucket->burst) ? size : bucket->burst) * TOKENS_PER_BYTE;
+        if(bucket->tokens < needed)
+        {
+            delay = (needed - bucket->tokens + bucket->rate - 1) / bucket->rate;
+        }
+    }
+    return delay;
+}
+
+void uxr_take_tokens(uxrTokenBucket* bucket, size_t size, int64_t timestamp)
+{
+    if(0 != bucket->rate)
+    {
+        refill(bucket, timestamp);
+        bucket->tokens -= (int64_t)size * TOKENS_PER_BYTE;
+    }
+}
+
+//==================================================================
+//                             PRIVATE
+//==================================================================
+void refill(uxrTokenBucket* bucket, int64_t timestamp)
+{
+    int64_t full = (int64_t)bucket->burst * TOKENS_PER_BYTE;
+    if(INT64_MIN == bucket->timestamp)
+    {
+        bucket->timestamp = timestamp;
+    }
+    else if(timestamp > bucket->timestamp)
+    {
+        /* Bounded before multiplying, so a long idle period does not overflow. */
+        int64_t elapsed = timestamp - bucket->timestamp;
+        int64_t missing = full - bucket->tokens;
+        bucket->tokens = (elapsed > missing / bucket->rate) ? full : bucket->tokens + elapsed * bucket->rate;
+        bucket->timestamp = timestamp;
+    }
+}
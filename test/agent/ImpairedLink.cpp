@@ -0,0 +1,191 @@
+#include "ImpairedLink.hpp"
+
+#include <uxr/client/util/time.h>
+
+#include <algorithm>
+
+#define NANOS_PER_MILLI 1000000LL
+#define NANOS_PER_SECOND 1000000000LL
+
+Impairment::Impairment()
+    : loss(0.0)
+    , burst_start(0.0)
+    , burst_end(1.0)
+    , burst_loss(1.0)
+    , delay_ms(0)
+    , jitter_ms(0)
+    , distribution(UNIFORM)
+    , reorder(0.0)
+    , reorder_ms(0)
+    , duplicate(0.0)
+    , bandwidth(0)
+{
+}
+
+ImpairedLink::ImpairedLink(uxrCommunication* inner, const Impairment& output, const Impairment& input, uint32_t seed)
+    : inner_(inner)
+    , output_()
+    , input_()
+    , generator_(seed)
+{
+    comm_.instance = this;
+    comm_.send_msg = send_msg;
+    comm_.recv_msg = recv_msg;
+    comm_.comm_error = comm_error;
+    comm_.msg_timestamps = NULL;
+    comm_.mtu = inner->mtu;
+
+    output_.impairment = output;
+    output_.burst = false;
+    output_.drop_next = false;
+    output_.busy_until = 0;
+    input_.impairment = input;
+    input_.burst = false;
+    input_.drop_next = false;
+    input_.busy_until = 0;
+}
+
+bool ImpairedLink::send_msg(void* instance, const uint8_t* buf, size_t len)
+{
+    ImpairedLink* link = static_cast<ImpairedLink*>(instance);
+    int64_t now = uxr_nanos();
+
+    /* A lost message is sent as far as the session knows. */
+    link->impair(link->output_, buf, len, now);
+    return link->flush_output(now);
+}
+
+bool ImpairedLink::recv_msg(void* instance, uint8_t** buf, size_t* len, int timeout)
+{
+    ImpairedLink* link = static_cast<ImpairedLink*>(instance);
+    int64_t now = uxr_nanos();
+    int64_t deadline = now + timeout * NANOS_PER_MILLI;
+
+    bool received = false;
+    do
+    {
+        (void) link->flush_output(now);
+
+        std::multimap<int64_t, std::vector<uint8_t>>::iterator next = link->input_.queue.begin();
+        if(link->input_.queue.end() != next && now >= next->first)
+        {
+            link->buffer_.swap(next->second);
+            link->input_.queue.erase(next);
+            link->input_.statistics.delivered++;
+            *buf = link->buffer_.data();
+            *len = link->buffer_.size();
+            received = true;
+        }
+        else
+        {
+            /* Waits on the inner transport until the deadline or the next message due, whatever comes first. */
+            int64_t wake_up = deadline;
+            if(!link->input_.queue.empty())
+            {
+                wake_up = std::min(wake_up, link->input_.queue.begin()->first);
+            }
+            if(!link->output_.queue.empty())
+            {
+                wake_up = std::min(wake_up, link->output_.queue.begin()->first);
+            }
+            int wait = int(std::max<int64_t>(0, (wake_up - now + NANOS_PER_MILLI - 1) / NANOS_PER_MILLI));
+
+            uint8_t* inner_buf; size_t inner_len;
+            if(link->inner_->recv_msg(link->inner_->instance, &inner_buf, &inner_len, wait))
+            {
+                link->impair(link->input_, inner_buf, inner_len, uxr_nanos());
+            }
+            now = uxr_nanos();
+        }
+    }
+    while(!received && now < deadline);
+
+    return received;
+}
+
+uint8_t ImpairedLink::comm_error(void)
+{
+    return 0;
+}
+
+void ImpairedLink::impair(Direction& direction, const uint8_t* buf, size_t len, int64_t now)
+{
+    const Impairment& impairment = direction.impairment;
+    direction.statistics.messages++;
+
+    /* Gilbert-Elliott: the state changes before the message is judged. */
+    direction.burst = (direction.burst) ? !happens(impairment.burst_end) : happens(impairment.burst_start);
+    bool lost = happens((direction.burst) ? impairment.burst_loss : impairment.loss);
+    if(lost || direction.drop_next)
+    {
+        direction.drop_next = false;
+        direction.statistics.dropped++;
+        return;
+    }
+
+    int copies = 1;
+    if(happens(impairment.duplicate))
+    {
+        direction.statistics.duplicated++;
+        copies = 2;
+    }
+
+    for(int i = 0; i < copies; ++i)
+    {
+        /* The bandwidth cap serializes the messages: each one waits for the previous to leave. */
+        int64_t departure = now;
+        if(0 != impairment.bandwidth)
+        {
+            departure = std::max(now, direction.busy_until) + int64_t(len) * NANOS_PER_SECOND / impairment.bandwidth;
+            direction.busy_until = departure;
+        }
+
+        int64_t arrival = departure + delay(impairment);
+        if(happens(impairment.reorder))
+        {
+            direction.statistics.reordered++;
+            arrival += impairment.reorder_ms * NANOS_PER_MILLI;
+        }
+        direction.queue.insert(std::make_pair(arrival, std::vector<uint8_t>(buf, buf + len)));
+    }
+}
+
+int64_t ImpairedLink::delay(const Impairment& impairment)
+{
+    double delay_ms = impairment.delay_ms;
+    if(0 != impairment.jitter_ms)
+    {
+        switch(impairment.distribution)
+        {
+            case Impairment::UNIFORM:
+                delay_ms += std::uniform_real_distribution<double>(-double(impairment.jitter_ms), double(impairment.jitter_ms))(generator_);
+                break;
+            case Impairment::NORMAL:
+                delay_ms = std::normal_distribution<double>(delay_ms, impairment.jitter_ms)(generator_);
+                break;
+            case Impairment::EXPONENTIAL:
+                delay_ms += std::exponential_distribution<double>(1.0 / impairment.jitter_ms)(generator_);
+                break;
+        }
+    }
+    return int64_t(std::max(0.0, delay_ms) * NANOS_PER_MILLI);
+}
+
+bool ImpairedLink::happens(double probability)
+{
+    return 0.0 < probability && std::uniform_real_distribution<double>(0.0, 1.0)(generator_) < probability;
+}
+
+bool ImpairedLink::flush_output(int64_t now)
+{
+    bool rv = true;
+    std::multimap<int64_t, std::vector<uint8_t>>::iterator next = output_.queue.begin();
+    while(output_.queue.end() != next && now >= next->first)
+    {
+        rv = inner_->send_msg(inner_->instance, next->second.data(), next->second.size()) && rv;
+        output_.statistics.delivered++;
+        output_.queue.erase(next);
+        next = output_.queue.begin();
+    }
+    return rv;
+}
@@ -0,0 +1,114 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _TEST_AGENT_IMPAIREDLINK_HPP_
+#define _TEST_AGENT_IMPAIREDLINK_HPP_
+
+#include <uxr/client/core/communication/communication.h>
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+/*
+ * Impairments of one direction of the link. Losses follow a Gilbert-Elliott model:
+ * a good and a bad state with their own loss rate, `burst_start` and `burst_end` being the
+ * probabilities of moving between them per message (a burst_start of 0 leaves only the random loss).
+ */
+struct Impairment
+{
+    enum Distribution
+    {
+        UNIFORM,     // delay +- jitter
+        NORMAL,      // mean delay, jitter as standard deviation
+        EXPONENTIAL  // delay plus an exponential tail of mean jitter
+    };
+
+    double loss;
+    double burst_start;
+    double burst_end;
+    double burst_loss;
+
+    uint32_t delay_ms;
+    uint32_t jitter_ms;
+    Distribution distribution;
+
+    double reorder;        // Probability of holding a message for reorder_ms, so the next ones overtake it.
+    uint32_t reorder_ms;
+    double duplicate;
+    uint32_t bandwidth;    // Bytes per second, 0 for unlimited.
+
+    Impairment();
+};
+
+/*
+ * uxrCommunication wrapping another one, between the session and a real transport (or an InMemoryLink),
+ * which impairs the messages in both directions. The messages delayed are kept in the link and delivered
+ * when the session sends or receives, so the session must be run for them to leave.
+ * Every random decision comes from a single generator seeded at construction, so runs are repeatable
+ * when the traffic is.
+ */
+class ImpairedLink
+{
+public:
+    struct Statistics
+    {
+        size_t messages;
+        size_t dropped;
+        size_t duplicated;
+        size_t reordered;
+        size_t delivered;
+    };
+
+    ImpairedLink(uxrCommunication* inner, const Impairment& output, const Impairment& input, uint32_t seed);
+
+    uxrCommunication* comm() { return &comm_; }
+
+    /* Drops the next message sent by the session, whatever the impairment. */
+    void drop_next_output() { output_.drop_next = true; }
+
+    const Statistics& output_statistics() const { return output_.statistics; }
+    const Statistics& input_statistics() const { return input_.statistics; }
+
+private:
+    struct Direction
+    {
+        Impairment impairment;
+        bool burst;
+        bool drop_next;
+        int64_t busy_until;
+        std::multimap<int64_t, std::vector<uint8_t>> queue;
+        Statistics statistics;
+    };
+
+    static bool send_msg(void* instance, const uint8_t* buf, size_t len);
+    static bool recv_msg(void* instance, uint8_t** buf, size_t* len, int timeout);
+    static uint8_t comm_error(void);
+
+    /* Decides the fate of a message, queueing its copies by delivery time. */
+    void impair(Direction& direction, const uint8_t* buf, size_t len, int64_t now);
+    int64_t delay(const Impairment& impairment);
+    bool happens(double probability);
+    bool flush_output(int64_t now);
+
+    uxrCommunication comm_;
+    uxrCommunication* inner_;
+    Direction output_;
+    Direction input_;
+    std::mt19937_64 generator_;
+    std::vector<uint8_t> buffer_;
+};
+
+#endif //_TEST_AGENT_IMPAIREDLINK_HPP_
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include "ImpairedLink.hpp"
+
+#include <uxr/client/util/time.h>
+
+#define MESSAGES 10000
+
+class ImpairedLinkTest : public testing::Test
+{
+public:
+    ImpairedLinkTest()
+        : sent_(0)
+    {
+        sink_.instance = this;
+        sink_.send_msg = send_msg;
+        sink_.recv_msg = recv_msg;
+        sink_.comm_error = NULL;
+        sink_.msg_timestamps = NULL;
+        sink_.mtu = 512;
+    }
+
+    size_t send_all(ImpairedLink& link)
+    {
+        uint8_t message[16] = {0};
+        for(size_t i = 0; i < MESSAGES; ++i)
+        {
+            link.comm()->send_msg(link.comm()->instance, message, sizeof(message));
+        }
+        return sent_;
+    }
+
+protected:
+    static bool send_msg(void* instance, const uint8_t* buf, size_t len)
+    {
+        (void) buf; (void) len;
+        static_cast<ImpairedLinkTest*>(instance)->sent_++;
+        return true;
+    }
+
+    static bool recv_msg(void* instance, uint8_t** buf, size_t* len, int timeout)
+    {
+        (void) instance; (void) buf; (void) len; (void) timeout;
+        return false;
+    }
+
+    uxrCommunication sink_;
+    size_t sent_;
+};
+
+TEST_F(ImpairedLinkTest, Transparent)
+{
+    ImpairedLink link(&sink_, Impairment(), Impairment(), 1);
+    ASSERT_EQ(size_t(MESSAGES), send_all(link));
+    ASSERT_EQ(0u, link.output_statistics().dropped);
+}
+
+TEST_F(ImpairedLinkTest, RandomLoss)
+{
+    Impairment output;
+    output.loss = 0.1;
+    output.duplicate = 0.05;
+    ImpairedLink link(&sink_, output, Impairment(), 1);
+
+    size_t sent = send_all(link);
+    const ImpairedLink::Statistics& statistics = link.output_statistics();
+    ASSERT_EQ(size_t(MESSAGES), statistics.messages);
+    ASSERT_EQ(MESSAGES - statistics.dropped + statistics.duplicated, sent);
+    ASSERT_NEAR(0.1, double(statistics.dropped) / MESSAGES, 0.02);
+}
+
+TEST_F(ImpairedLinkTest, BurstLoss)
+{
+    /* Mean burst of 1 / burst_end messages, entered every 1 / burst_start. */
+    Impairment output;
+    output.burst_start = 0.01;
+    output.burst_end = 0.25;
+    output.burst_loss = 1.0;
+    ImpairedLink link(&sink_, output, Impairment(), 7);
+
+    (void) send_all(link);
+    double expected = output.burst_start / (output.burst_start + output.burst_end);
+    ASSERT_NEAR(expected, double(link.output_statistics().dropped) / MESSAGES, 0.02);
+}
+
+TEST_F(ImpairedLinkTest, Repeatable)
+{
+    Impairment output;
+    output.loss = 0.2;
+    output.burst_start = 0.05;
+    output.burst_end = 0.5;
+    output.duplicate = 0.1;
+
+    ImpairedLink first(&sink_, output, Impairment(), 42);
+    size_t first_sent = send_all(first);
+    sent_ = 0;
+    ImpairedLink second(&sink_, output, Impairment(), 42);
+    size_t second_sent = send_all(second);
+
+    ASSERT_EQ(first_sent, second_sent);
+    ASSERT_EQ(first.output_statistics().dropped, second.output_statistics().dropped);
+    ASSERT_EQ(first.output_statistics().duplicated, second.output_statistics().duplicated);
+}
+
+TEST_F(ImpairedLinkTest, Delay)
+{
+    Impairment output;
+    output.delay_ms = 20;
+    ImpairedLink link(&sink_, output, Impairment(), 1);
+
+    uint8_t message[16] = {0};
+    int64_t start = uxr_millis();
+    ASSERT_TRUE(link.comm()->send_msg(link.comm()->instance, message, sizeof(message)));
+    ASSERT_EQ(0u, sent_);
+
+    /* The delayed messages leave while the session waits for input. */
+    uint8_t* buf; size_t len;
+    while(0 == sent_ && 1000 > uxr_millis() - start)
+    {
+        (void) link.comm()->recv_msg(link.comm()->instance, &buf, &len, 5);
+    }
+    ASSERT_EQ(1u, sent_);
+    ASSERT_LE(20, uxr_millis() - start);
+}
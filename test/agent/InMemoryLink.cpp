@@ -0,0 +1,42 @@
+#include "InMemoryLink.hpp"
+
+#include <uxr/client/util/time.h>
+
+InMemoryLink::InMemoryLink(StandInAgent& agent, uint16_t mtu)
+    : agent_(agent)
+{
+    comm_.instance = this;
+    comm_.send_msg = send_msg;
+    comm_.recv_msg = recv_msg;
+    comm_.comm_error = comm_error;
+    comm_.msg_timestamps = NULL;
+    comm_.mtu = mtu;
+}
+
+bool InMemoryLink::send_msg(void* instance, const uint8_t* buf, size_t len)
+{
+    InMemoryLink* link = static_cast<InMemoryLink*>(instance);
+    link->agent_.receive(buf, len);
+    return true;
+}
+
+bool InMemoryLink::recv_msg(void* instance, uint8_t** buf, size_t* len, int timeout)
+{
+    static_cast<void>(timeout);
+    InMemoryLink* link = static_cast<InMemoryLink*>(instance);
+
+    /* The buffer is kept until the next call, as the transports do with their own. */
+    link->agent_.update(uxr_millis());
+    bool rv = link->agent_.take_output(link->input_);
+    if(rv)
+    {
+        *buf = link->input_.data();
+        *len = link->input_.size();
+    }
+    return rv;
+}
+
+uint8_t InMemoryLink::comm_error(void)
+{
+    return 0;
+}
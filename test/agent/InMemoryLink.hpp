@@ -0,0 +1,43 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _TEST_AGENT_INMEMORYLINK_HPP_
+#define _TEST_AGENT_INMEMORYLINK_HPP_
+
+#include "StandInAgent.hpp"
+
+/*
+ * uxrCommunication connected directly to a StandInAgent, in the same thread.
+ * Sending a message processes it in the agent, receiving takes the next agent message without waiting,
+ * so a session runs deterministically, without sockets nor threads.
+ */
+class InMemoryLink
+{
+public:
+    explicit InMemoryLink(StandInAgent& agent, uint16_t mtu = 512);
+
+    uxrCommunication* comm() { return &comm_; }
+    StandInAgent& agent() { return agent_; }
+
+private:
+    static bool send_msg(void* instance, const uint8_t* buf, size_t len);
+    static bool recv_msg(void* instance, uint8_t** buf, size_t* len, int timeout);
+    static uint8_t comm_error(void);
+
+    uxrCommunication comm_;
+    StandInAgent& agent_;
+    std::vector<uint8_t> input_;
+};
+
+#endif //_TEST_AGENT_INMEMORYLINK_HPP_
@@ -0,0 +1,242 @@
+#include "SocketAgent.hpp"
+
+#include <uxr/client/util/time.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define POLL_PERIOD_MS 1
+#define MAX_MESSAGE_SIZE 0xFFFF
+
+SocketAgent::SocketAgent(Protocol protocol, uint16_t window)
+    : protocol_(protocol)
+    , agent_(window)
+    , socket_(-1)
+    , port_(0)
+    , serial_slave_(-1)
+    , running_(false)
+{
+}
+
+SocketAgent::~SocketAgent()
+{
+    stop();
+}
+
+bool SocketAgent::start()
+{
+    if(SERIAL == protocol_)
+    {
+        bool rv = open_serial();
+        if(rv)
+        {
+            running_ = true;
+            thread_ = std::thread(&SocketAgent::run_serial, this);
+        }
+        return rv;
+    }
+
+    socket_ = socket(AF_INET, (UDP == protocol_) ? SOCK_DGRAM : SOCK_STREAM, 0);
+    if(-1 == socket_)
+    {
+        return false;
+    }
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    socklen_t address_length = sizeof(address);
+    bool rv = 0 == bind(socket_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address))
+           && 0 == getsockname(socket_, reinterpret_cast<struct sockaddr*>(&address), &address_length)
+           && (UDP == protocol_ || 0 == listen(socket_, 1));
+    if(rv)
+    {
+        port_ = ntohs(address.sin_port);
+        running_ = true;
+        thread_ = std::thread((UDP == protocol_) ? &SocketAgent::run_udp : &SocketAgent::run_tcp, this);
+    }
+    else
+    {
+        close(socket_);
+        socket_ = -1;
+    }
+    return rv;
+}
+
+void SocketAgent::stop()
+{
+    running_ = false;
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+    if(-1 != socket_)
+    {
+        close(socket_);
+        socket_ = -1;
+    }
+    if(-1 != serial_slave_)
+    {
+        (void) uxr_close_serial_transport(&serial_);
+        close(serial_slave_);
+        serial_slave_ = -1;
+    }
+}
+
+void SocketAgent::run_udp()
+{
+    std::vector<uint8_t> buffer(MAX_MESSAGE_SIZE);
+    struct sockaddr_in client = {};
+    socklen_t client_length = 0;
+
+    struct pollfd poll_fd = {socket_, POLLIN, 0};
+    while(running_)
+    {
+        if(0 < poll(&poll_fd, 1, POLL_PERIOD_MS))
+        {
+            client_length = sizeof(client);
+            ssize_t length = recvfrom(socket_, buffer.data(), buffer.size(), 0,
+                                      reinterpret_cast<struct sockaddr*>(&client), &client_length);
+            if(0 < length)
+            {
+                agent_.receive(buffer.data(), size_t(length));
+            }
+        }
+
+        agent_.update(uxr_millis());
+        std::vector<uint8_t> message;
+        while(0 != client_length && agent_.take_output(message))
+        {
+            (void) sendto(socket_, message.data(), message.size(), 0,
+                          reinterpret_cast<struct sockaddr*>(&client), client_length);
+        }
+    }
+}
+
+void SocketAgent::run_tcp()
+{
+    int connection = -1;
+    struct pollfd poll_fd = {socket_, POLLIN, 0};
+    while(running_ && -1 == connection)
+    {
+        if(0 < poll(&poll_fd, 1, POLL_PERIOD_MS))
+        {
+            connection = accept(socket_, NULL, NULL);
+        }
+    }
+    if(-1 == connection)
+    {
+        return;
+    }
+
+    int nodelay = 1;
+    (void) setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    std::vector<uint8_t> buffer(MAX_MESSAGE_SIZE);
+    bool connected = true;
+    poll_fd.fd = connection;
+    while(running_ && connected)
+    {
+        if(0 < poll(&poll_fd, 1, POLL_PERIOD_MS))
+        {
+            uint8_t length_buffer[2];
+            connected = read_tcp(connection, length_buffer, sizeof(length_buffer));
+            size_t length = size_t(length_buffer[0]) | size_t(length_buffer[1] << 8);
+            connected = connected && read_tcp(connection, buffer.data(), length);
+            if(connected)
+            {
+                agent_.receive(buffer.data(), length);
+            }
+        }
+
+        agent_.update(uxr_millis());
+        std::vector<uint8_t> message;
+        while(connected && agent_.take_output(message))
+        {
+            uint8_t length_buffer[2] = {uint8_t(message.size() & 0xFF), uint8_t(message.size() >> 8)};
+            connected = sizeof(length_buffer) == send(connection, length_buffer, sizeof(length_buffer), MSG_NOSIGNAL)
+                     && ssize_t(message.size()) == send(connection, message.data(), message.size(), MSG_NOSIGNAL);
+        }
+    }
+
+    close(connection);
+}
+
+bool SocketAgent::open_serial()
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(-1 == master)
+    {
+        return false;
+    }
+
+    /* The slave is kept open, so the terminal survives the Client closing and keeps its raw mode. */
+    bool rv = 0 == grantpt(master) && 0 == unlockpt(master) && NULL != ptsname(master);
+    if(rv)
+    {
+        device_ = ptsname(master);
+        serial_slave_ = open(device_.c_str(), O_RDWR | O_NOCTTY);
+        struct termios attributes;
+        rv = -1 != serial_slave_ && 0 == tcgetattr(serial_slave_, &attributes);
+        if(rv)
+        {
+            cfmakeraw(&attributes);
+            rv = 0 == tcsetattr(serial_slave_, TCSANOW, &attributes)
+                 && uxr_init_serial_transport(&serial_, &serial_platform_, master, SERIAL_CLIENT_ADDR, SERIAL_AGENT_ADDR);
+        }
+    }
+
+    if(!rv)
+    {
+        close(master);
+        if(-1 != serial_slave_)
+        {
+            close(serial_slave_);
+            serial_slave_ = -1;
+        }
+    }
+    return rv;
+}
+
+void SocketAgent::run_serial()
+{
+    uxrCommunication* comm = &serial_.comm;
+    while(running_)
+    {
+        uint8_t* buffer; size_t length;
+        if(comm->recv_msg(comm->instance, &buffer, &length, POLL_PERIOD_MS))
+        {
+            agent_.receive(buffer, length);
+        }
+
+        agent_.update(uxr_millis());
+        std::vector<uint8_t> message;
+        while(agent_.take_output(message))
+        {
+            (void) comm->send_msg(comm->instance, message.data(), message.size());
+        }
+    }
+}
+
+bool SocketAgent::read_tcp(int fd, uint8_t* buffer, size_t length)
+{
+    size_t position = 0;
+    while(position < length)
+    {
+        ssize_t received = recv(fd, buffer + position, length - position, 0);
+        if(0 >= received)
+        {
+            return false;
+        }
+        position += size_t(received);
+    }
+    return true;
+}
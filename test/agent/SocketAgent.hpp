@@ -0,0 +1,76 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _TEST_AGENT_SOCKETAGENT_HPP_
+#define _TEST_AGENT_SOCKETAGENT_HPP_
+
+#include "StandInAgent.hpp"
+
+#include <uxr/client/client.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/*
+ * StandInAgent served on a loopback socket by its own thread, to exercise the real UDP and TCP transports.
+ * The port is chosen by the system and known after `start`. TCP accepts a single connection,
+ * framed as the Client TCP transport does: two bytes of length, little endian, before each message.
+ * SERIAL serves a pseudo-terminal in raw mode, the Client opening the `device` to use the serial transport
+ * with the addresses SERIAL_CLIENT_ADDR and SERIAL_AGENT_ADDR.
+ * The agent must not be accessed while running.
+ */
+class SocketAgent
+{
+public:
+    enum Protocol
+    {
+        UDP,
+        TCP,
+        SERIAL
+    };
+
+    static const uint8_t SERIAL_CLIENT_ADDR = 0x00;
+    static const uint8_t SERIAL_AGENT_ADDR = 0x01;
+
+    explicit SocketAgent(Protocol protocol, uint16_t window = 16);
+    ~SocketAgent();
+
+    bool start();
+    void stop();
+
+    uint16_t port() const { return port_; }
+    const std::string& device() const { return device_; }
+    const StandInAgent& agent() const { return agent_; }
+
+private:
+    void run_udp();
+    void run_tcp();
+    void run_serial();
+    bool open_serial();
+    bool read_tcp(int fd, uint8_t* buffer, size_t length);
+
+    Protocol protocol_;
+    StandInAgent agent_;
+    int socket_;
+    uint16_t port_;
+    std::string device_;
+    int serial_slave_;
+    uxrSerialTransport serial_;
+    uxrSerialPlatform serial_platform_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+};
+
+#endif //_TEST_AGENT_SOCKETAGENT_HPP_
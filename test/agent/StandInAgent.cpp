@@ -0,0 +1,613 @@
+#include "StandInAgent.hpp"
+
+#include <c/core/serialization/xrce_protocol_internal.h>
+#include <c/core/serialization/xrce_header_internal.h>
+#include <c/core/session/session_info_internal.h>
+#include <c/core/session/submessage_internal.h>
+#include <c/core/session/stream/seq_num_internal.h>
+#include <uxr/client/util/time.h>
+
+#include <algorithm>
+#include <cstring>
+
+#define OBJECTID_CLIENT_0 0xFF
+#define OBJECTID_CLIENT_1 0xFE
+#define HEARTBEAT_PERIOD_MS 100
+#define NACK_BITMAP_SIZE 16
+
+#define STATUS_AGENT_PAYLOAD_SIZE 32
+#define STATUS_PAYLOAD_SIZE 6
+#define ACKNACK_PAYLOAD_SIZE 5
+#define HEARTBEAT_PAYLOAD_SIZE 5
+#define TIMESTAMP_PAYLOAD_SIZE 8
+#define TIMESTAMP_REPLY_PAYLOAD_SIZE 24
+
+namespace {
+
+void begin_submessage(std::vector<uint8_t>& submessage, ucdrBuffer* ub, uint8_t id, uint8_t flags, size_t max_payload)
+{
+    submessage.resize(SUBHEADER_SIZE + max_payload);
+    ucdr_init_buffer(ub, submessage.data(), uint32_t(submessage.size()));
+    uxr_buffer_submessage_header(ub, id, 0, flags);
+}
+
+void end_submessage(std::vector<uint8_t>& submessage, ucdrBuffer* ub)
+{
+    /* The length is only known once the payload has been serialized. */
+    uint16_t length = uint16_t(ucdr_buffer_length(ub) - SUBHEADER_SIZE);
+    submessage.resize(ucdr_buffer_length(ub));
+    submessage[2] = uint8_t(length & 0xFF);
+    submessage[3] = uint8_t(length >> 8);
+}
+
+Time_t to_time(int64_t nanos)
+{
+    Time_t time;
+    time.seconds = int32_t(nanos / 1000000000);
+    time.nanoseconds = uint32_t(nanos % 1000000000);
+    return time;
+}
+
+} // namespace
+
+StandInAgent::StandInAgent(uint16_t window)
+    : window_(window)
+    , session_created_(false)
+    , session_id_(0)
+    , client_key_{0, 0, 0, 0}
+    , mtu_(0)
+    , received_timestamp_(0)
+    , last_heartbeat_(0)
+    , statistics_()
+{
+}
+
+void StandInAgent::receive(const uint8_t* buffer, size_t length)
+{
+    statistics_.messages_received++;
+    received_timestamp_ = uxr_nanos();
+
+    if(MIN_HEADER_SIZE > length)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> message(buffer, buffer + length);
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, message.data(), uint32_t(message.size()));
+
+    uint8_t session_id; uint8_t stream_id; uint16_t seq_num; uint8_t key[CLIENT_KEY_SIZE];
+    uxr_deserialize_message_header(&ub, &session_id, &stream_id, &seq_num, key);
+
+    const uint8_t* payload = ub.iterator;
+    size_t payload_length = ucdr_buffer_remaining(&ub);
+    if(0 == stream_id)
+    {
+        read_submessages(stream_id, payload, payload_length);
+    }
+    else if(0x80 > stream_id)
+    {
+        /* Best-effort: the old and repeated messages are discarded. */
+        std::map<uint8_t, uint16_t>::iterator it = input_best_effort_.find(stream_id);
+        if(input_best_effort_.end() == it || 0 < uxr_seq_num_cmp(seq_num, it->second))
+        {
+            input_best_effort_[stream_id] = seq_num;
+            read_submessages(stream_id, payload, payload_length);
+        }
+    }
+    else
+    {
+        read_reliable_message(stream_id, seq_num, payload, payload_length);
+    }
+}
+
+void StandInAgent::update(int64_t timestamp_ms)
+{
+    if(HEARTBEAT_PERIOD_MS > timestamp_ms - last_heartbeat_)
+    {
+        return;
+    }
+
+    last_heartbeat_ = timestamp_ms;
+    for(std::map<uint8_t, OutputReliableStream>::iterator it = output_reliable_.begin(); it != output_reliable_.end(); ++it)
+    {
+        if(!it->second.unacked.empty())
+        {
+            send_heartbeat(it->first);
+        }
+    }
+}
+
+bool StandInAgent::take_output(std::vector<uint8_t>& message)
+{
+    bool available = !output_.empty();
+    if(available)
+    {
+        message.swap(output_.front());
+        output_.pop_front();
+    }
+    return available;
+}
+
+bool StandInAgent::has_output() const
+{
+    return !output_.empty();
+}
+
+void StandInAgent::reset()
+{
+    input_best_effort_.clear();
+    input_reliable_.clear();
+    output_best_effort_.clear();
+    output_reliable_.clear();
+    read_requests_.clear();
+    output_.clear();
+}
+
+void StandInAgent::read_reliable_message(uint8_t stream_id, uint16_t seq_num, const uint8_t* payload, size_t length)
+{
+    std::map<uint8_t, InputReliableStream>::iterator it = input_reliable_.find(stream_id);
+    if(input_reliable_.end() == it)
+    {
+        InputReliableStream stream;
+        stream.last_handled = SEQ_NUM_MAX;
+        stream.last_announced = SEQ_NUM_MAX;
+        it = input_reliable_.insert(std::make_pair(stream_id, stream)).first;
+    }
+    InputReliableStream& stream = it->second;
+
+    if(0 < uxr_seq_num_cmp(seq_num, stream.last_handled))
+    {
+        stream.pending.insert(std::make_pair(seq_num, std::vector<uint8_t>(payload, payload + length)));
+        if(0 < uxr_seq_num_cmp(seq_num, stream.last_announced))
+        {
+            stream.last_announced = seq_num;
+        }
+    }
+
+    /* Messages are delivered in order, the FRAGMENT submessages are joined by `read_fragment`. */
+    std::map<uint16_t, std::vector<uint8_t>>::iterator message = stream.pending.find(uxr_seq_num_add(stream.last_handled, 1));
+    while(stream.pending.end() != message)
+    {
+        std::vector<uint8_t> submessages;
+        submessages.swap(message->second);
+        stream.pending.erase(message);
+        stream.last_handled = uxr_seq_num_add(stream.last_handled, 1);
+
+        read_submessages(stream_id, submessages.data(), submessages.size());
+        message = stream.pending.find(uxr_seq_num_add(stream.last_handled, 1));
+    }
+
+    send_acknack(stream_id);
+}
+
+void StandInAgent::read_submessages(uint8_t stream_id, const uint8_t* payload, size_t length)
+{
+    std::vector<uint8_t> submessages(payload, payload + length);
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, submessages.data(), uint32_t(submessages.size()));
+
+    uint8_t id; uint16_t submessage_length; uint8_t flags;
+    while(uxr_read_submessage_header(&ub, &id, &submessage_length, &flags) && ucdr_buffer_remaining(&ub) >= submessage_length)
+    {
+        /* Each submessage is read on its own, so an unknown one is skipped by its length. */
+        uint8_t* next = ub.iterator + submessage_length;
+        read_submessage(stream_id, id, flags, &ub, submessage_length);
+        ub.iterator = next;
+        ub.error = false;
+    }
+}
+
+void StandInAgent::read_submessage(uint8_t stream_id, uint8_t submessage_id, uint8_t flags, ucdrBuffer* ub, uint16_t length)
+{
+    static_cast<void>(flags);
+    switch(submessage_id)
+    {
+        case SUBMESSAGE_ID_CREATE_CLIENT:
+            read_create_client(ub);
+            break;
+
+        case SUBMESSAGE_ID_CREATE:
+            read_object_request(stream_id, ub, STATUS_LAST_OP_CREATE);
+            break;
+
+        case SUBMESSAGE_ID_DELETE:
+            read_object_request(stream_id, ub, STATUS_LAST_OP_DELETE);
+            break;
+
+        case SUBMESSAGE_ID_WRITE_DATA:
+            read_write_data(ub, length);
+            break;
+
+        case SUBMESSAGE_ID_READ_DATA:
+            read_read_data(ub);
+            break;
+
+        case SUBMESSAGE_ID_HEARTBEAT:
+            read_heartbeat(ub);
+            break;
+
+        case SUBMESSAGE_ID_ACKNACK:
+            read_acknack(ub);
+            break;
+
+        case SUBMESSAGE_ID_FRAGMENT:
+            read_fragment(stream_id, flags, ub, length);
+            break;
+
+        case SUBMESSAGE_ID_TIMESTAMP:
+#ifdef PERFORMANCE_TESTING
+            /* PERFORMANCE shares the identifier, and only the echoed ones are answered. */
+            if(0 != (flags & UXR_ECHO) || TIMESTAMP_PAYLOAD_SIZE != length)
+            {
+                read_performance(stream_id, flags, ub, length);
+                break;
+            }
+#endif
+            read_timestamp(ub);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void StandInAgent::read_create_client(ucdrBuffer* ub)
+{
+    CREATE_CLIENT_Payload payload;
+    if(uxr_deserialize_CREATE_CLIENT_Payload(ub, &payload))
+    {
+        reset();
+        session_created_ = true;
+        session_id_ = payload.client_representation.session_id;
+        std::memcpy(client_key_, payload.client_representation.client_key.data, CLIENT_KEY_SIZE);
+        mtu_ = payload.client_representation.mtu;
+
+        STATUS_AGENT_Payload status;
+        status.result.status = UXR_STATUS_OK;
+        status.result.implementation_status = 0;
+        status.agent_info.xrce_cookie.data[0] = 'X';
+        status.agent_info.xrce_cookie.data[1] = 'R';
+        status.agent_info.xrce_cookie.data[2] = 'C';
+        status.agent_info.xrce_cookie.data[3] = 'E';
+        status.agent_info.xrce_version.data[0] = XRCE_VERSION_MAJOR;
+        status.agent_info.xrce_version.data[1] = XRCE_VERSION_MINOR;
+        status.agent_info.xrce_vendor_id.data[0] = 0x01;
+        status.agent_info.xrce_vendor_id.data[1] = 0x0F;
+        status.agent_info.optional_properties = false;
+
+        std::vector<uint8_t> submessage;
+        ucdrBuffer mb;
+        begin_submessage(submessage, &mb, SUBMESSAGE_ID_STATUS_AGENT, 0, STATUS_AGENT_PAYLOAD_SIZE);
+        (void) uxr_serialize_STATUS_AGENT_Payload(&mb, &status);
+        end_submessage(submessage, &mb);
+        send_submessage(0, submessage);
+    }
+}
+
+void StandInAgent::read_object_request(uint8_t stream_id, ucdrBuffer* ub, uint8_t status_operation)
+{
+    /* Only the base is needed: every entity is accepted as it comes. */
+    BaseObjectRequest request;
+    if(uxr_deserialize_BaseObjectRequest(ub, &request))
+    {
+        bool logout = OBJECTID_CLIENT_0 == request.object_id.data[0] && OBJECTID_CLIENT_1 == request.object_id.data[1];
+        if(logout)
+        {
+            session_created_ = false;
+        }
+        else
+        {
+            for(std::vector<ReadRequest>::iterator it = read_requests_.begin(); it != read_requests_.end();)
+            {
+                bool deleted = STATUS_LAST_OP_DELETE == status_operation && 0 == std::memcmp(it->object_id, request.object_id.data, 2);
+                it = (deleted) ? read_requests_.erase(it) : it + 1;
+            }
+        }
+        send_status((logout) ? 0 : stream_id, request.request_id.data, request.object_id.data, UXR_STATUS_OK);
+    }
+}
+
+void StandInAgent::read_write_data(ucdrBuffer* ub, uint16_t length)
+{
+    BaseObjectRequest request;
+    if(uxr_deserialize_BaseObjectRequest(ub, &request) && 4 <= length)
+    {
+        last_sample_.assign(ub->iterator, ub->iterator + (length - 4));
+        statistics_.samples_written++;
+        statistics_.bytes_written += last_sample_.size();
+
+        for(std::vector<ReadRequest>::const_iterator it = read_requests_.begin(); it != read_requests_.end(); ++it)
+        {
+            std::vector<uint8_t> submessage;
+            ucdrBuffer mb;
+            begin_submessage(submessage, &mb, SUBMESSAGE_ID_DATA, FLAG_FORMAT_DATA, 4 + last_sample_.size());
+
+            BaseObjectRequest base;
+            std::memcpy(base.request_id.data, it->request_id, 2);
+            std::memcpy(base.object_id.data, it->object_id, 2);
+            (void) uxr_serialize_BaseObjectRequest(&mb, &base);
+            (void) ucdr_serialize_array_uint8_t(&mb, last_sample_.data(), uint32_t(last_sample_.size()));
+            end_submessage(submessage, &mb);
+
+            send_submessage(it->stream_id, submessage);
+            statistics_.samples_delivered++;
+        }
+    }
+}
+
+void StandInAgent::read_read_data(ucdrBuffer* ub)
+{
+    READ_DATA_Payload payload;
+    if(uxr_deserialize_READ_DATA_Payload(ub, &payload))
+    {
+        /* A new request on the same reader replaces the previous one. */
+        ReadRequest request;
+        std::memcpy(request.request_id, payload.base.request_id.data, 2);
+        std::memcpy(request.object_id, payload.base.object_id.data, 2);
+        request.stream_id = payload.read_specification.preferred_stream_id;
+
+        std::vector<ReadRequest>::iterator it = read_requests_.begin();
+        while(it != read_requests_.end() && 0 != std::memcmp(it->object_id, request.object_id, 2))
+        {
+            ++it;
+        }
+        if(it == read_requests_.end())
+        {
+            read_requests_.push_back(request);
+        }
+        else
+        {
+            *it = request;
+        }
+    }
+}
+
+void StandInAgent::read_heartbeat(ucdrBuffer* ub)
+{
+    HEARTBEAT_Payload payload;
+    if(uxr_deserialize_HEARTBEAT_Payload(ub, &payload))
+    {
+        std::map<uint8_t, InputReliableStream>::iterator it = input_reliable_.find(payload.stream_id);
+        if(input_reliable_.end() == it)
+        {
+            InputReliableStream stream;
+            stream.last_handled = SEQ_NUM_MAX;
+            stream.last_announced = SEQ_NUM_MAX;
+            it = input_reliable_.insert(std::make_pair(payload.stream_id, stream)).first;
+        }
+        if(0 < uxr_seq_num_cmp(payload.last_unacked_seq_nr, it->second.last_announced))
+        {
+            it->second.last_announced = payload.last_unacked_seq_nr;
+        }
+        send_acknack(payload.stream_id);
+    }
+}
+
+void StandInAgent::read_acknack(ucdrBuffer* ub)
+{
+    ACKNACK_Payload payload;
+    if(uxr_deserialize_ACKNACK_Payload(ub, &payload))
+    {
+        std::map<uint8_t, OutputReliableStream>::iterator it = output_reliable_.find(payload.stream_id);
+        if(output_reliable_.end() != it)
+        {
+            OutputReliableStream& stream = it->second;
+            uint16_t last_acked = uxr_seq_num_sub(payload.first_unacked_seq_num, 1);
+            while(0 < uxr_seq_num_cmp(last_acked, stream.last_acknown) && 0 >= uxr_seq_num_cmp(last_acked, stream.last_sent))
+            {
+                stream.last_acknown = uxr_seq_num_add(stream.last_acknown, 1);
+                stream.unacked.erase(stream.last_acknown);
+            }
+
+            uint16_t nack_bitmap = uint16_t((payload.nack_bitmap[0] << 8) | payload.nack_bitmap[1]);
+            for(uint16_t i = 0; i < NACK_BITMAP_SIZE; ++i)
+            {
+                if(0 != (nack_bitmap & (1 << i)))
+                {
+                    uint16_t seq_num = uxr_seq_num_add(payload.first_unacked_seq_num, i);
+                    std::map<uint16_t, std::vector<uint8_t>>::const_iterator message = stream.unacked.find(seq_num);
+                    if(stream.unacked.end() != message)
+                    {
+                        push_message(payload.stream_id, seq_num, message->second);
+                        statistics_.retransmissions++;
+                    }
+                }
+            }
+
+            flush_reliable_backlog(payload.stream_id);
+        }
+    }
+}
+
+void StandInAgent::read_fragment(uint8_t stream_id, uint8_t flags, ucdrBuffer* ub, uint16_t length)
+{
+    std::map<uint8_t, InputReliableStream>::iterator it = input_reliable_.find(stream_id);
+    if(input_reliable_.end() != it)
+    {
+        std::vector<uint8_t>& fragments = it->second.fragments;
+        fragments.insert(fragments.end(), ub->iterator, ub->iterator + length);
+        if(0 != (flags & FLAG_LAST_FRAGMENT))
+        {
+            std::vector<uint8_t> submessages;
+            submessages.swap(fragments);
+            read_submessages(stream_id, submessages.data(), submessages.size());
+        }
+    }
+}
+
+void StandInAgent::read_timestamp(ucdrBuffer* ub)
+{
+    TIMESTAMP_Payload payload;
+    if(uxr_deserialize_TIMESTAMP_Payload(ub, &payload))
+    {
+        TIMESTAMP_REPLY_Payload reply;
+        reply.originate_timestamp = payload.transmit_timestamp;
+        reply.receive_timestamp = to_time(received_timestamp_);
+        reply.transmit_timestamp = to_time(uxr_nanos());
+
+        std::vector<uint8_t> submessage;
+        ucdrBuffer mb;
+        begin_submessage(submessage, &mb, SUBMESSAGE_ID_TIMESTAMP_REPLY, 0, TIMESTAMP_REPLY_PAYLOAD_SIZE);
+        (void) uxr_serialize_TIMESTAMP_REPLY_Payload(&mb, &reply);
+        end_submessage(submessage, &mb);
+        send_submessage(0, submessage);
+    }
+}
+
+#ifdef PERFORMANCE_TESTING
+void StandInAgent::read_performance(uint8_t stream_id, uint8_t flags, ucdrBuffer* ub, uint16_t length)
+{
+    statistics_.performance_received++;
+    if(0 != (flags & UXR_ECHO))
+    {
+        /* The payload goes back untouched, the Client measures with its own epoch. */
+        std::vector<uint8_t> submessage;
+        ucdrBuffer mb;
+        begin_submessage(submessage, &mb, SUBMESSAGE_ID_PERFORMANCE, flags, length);
+        (void) ucdr_serialize_array_uint8_t(&mb, ub->iterator, length);
+        end_submessage(submessage, &mb);
+        send_submessage(stream_id, submessage);
+        statistics_.performance_echoes++;
+    }
+}
+#endif
+
+void StandInAgent::send_status(uint8_t stream_id, const uint8_t* request_id, const uint8_t* object_id, uint8_t status)
+{
+    STATUS_Payload payload;
+    std::memcpy(payload.base.related_request.request_id.data, request_id, 2);
+    std::memcpy(payload.base.related_request.object_id.data, object_id, 2);
+    payload.base.result.status = status;
+    payload.base.result.implementation_status = 0;
+
+    std::vector<uint8_t> submessage;
+    ucdrBuffer mb;
+    begin_submessage(submessage, &mb, SUBMESSAGE_ID_STATUS, 0, STATUS_PAYLOAD_SIZE);
+    (void) uxr_serialize_STATUS_Payload(&mb, &payload);
+    end_submessage(submessage, &mb);
+    send_submessage(stream_id, submessage);
+}
+
+void StandInAgent::send_acknack(uint8_t stream_id)
+{
+    InputReliableStream& stream = input_reliable_[stream_id];
+
+    ACKNACK_Payload payload;
+    payload.first_unacked_seq_num = uxr_seq_num_add(stream.last_handled, 1);
+    payload.stream_id = stream_id;
+
+    uint16_t nack_bitmap = 0;
+    uint16_t to_ack = uxr_seq_num_sub(stream.last_announced, stream.last_handled);
+    for(uint16_t i = 0; i < to_ack && i < NACK_BITMAP_SIZE; ++i)
+    {
+        if(stream.pending.end() == stream.pending.find(uxr_seq_num_add(payload.first_unacked_seq_num, i)))
+        {
+            nack_bitmap = uint16_t(nack_bitmap | (1 << i));
+        }
+    }
+    payload.nack_bitmap[0] = uint8_t(nack_bitmap >> 8);
+    payload.nack_bitmap[1] = uint8_t(nack_bitmap & 0xFF);
+
+    std::vector<uint8_t> submessage;
+    ucdrBuffer mb;
+    begin_submessage(submessage, &mb, SUBMESSAGE_ID_ACKNACK, 0, ACKNACK_PAYLOAD_SIZE);
+    (void) uxr_serialize_ACKNACK_Payload(&mb, &payload);
+    end_submessage(submessage, &mb);
+    send_submessage(0, submessage);
+    statistics_.acknacks_sent++;
+}
+
+void StandInAgent::send_heartbeat(uint8_t stream_id)
+{
+    const OutputReliableStream& stream = output_reliable_[stream_id];
+
+    HEARTBEAT_Payload payload;
+    payload.first_unacked_seq_nr = uxr_seq_num_add(stream.last_acknown, 1);
+    payload.last_unacked_seq_nr = stream.last_sent;
+    payload.stream_id = stream_id;
+
+    std::vector<uint8_t> submessage;
+    ucdrBuffer mb;
+    begin_submessage(submessage, &mb, SUBMESSAGE_ID_HEARTBEAT, 0, HEARTBEAT_PAYLOAD_SIZE);
+    (void) uxr_serialize_HEARTBEAT_Payload(&mb, &payload);
+    end_submessage(submessage, &mb);
+    send_submessage(0, submessage);
+    statistics_.heartbeats_sent++;
+}
+
+void StandInAgent::send_submessage(uint8_t stream_id, const std::vector<uint8_t>& submessage)
+{
+    if(0 == stream_id)
+    {
+        push_message(stream_id, 0, submessage);
+    }
+    else if(0x80 > stream_id)
+    {
+        uint16_t& last_sent = output_best_effort_[stream_id];
+        push_message(stream_id, last_sent, submessage);
+        last_sent = uxr_seq_num_add(last_sent, 1);
+    }
+    else
+    {
+        std::map<uint8_t, OutputReliableStream>::iterator it = output_reliable_.find(stream_id);
+        if(output_reliable_.end() == it)
+        {
+            OutputReliableStream stream;
+            stream.last_sent = SEQ_NUM_MAX;
+            stream.last_acknown = SEQ_NUM_MAX;
+            it = output_reliable_.insert(std::make_pair(stream_id, stream)).first;
+        }
+
+        /* Larger than the Client MTU: split in FRAGMENT submessages, one per message. */
+        size_t header_size = (SESSION_ID_WITHOUT_CLIENT_KEY > session_id_) ? MAX_HEADER_SIZE : MIN_HEADER_SIZE;
+        if(0 == mtu_ || header_size + submessage.size() <= mtu_)
+        {
+            it->second.backlog.push_back(submessage);
+        }
+        else
+        {
+            size_t fragment_size = mtu_ - header_size - SUBHEADER_SIZE;
+            for(size_t offset = 0; offset < submessage.size(); offset += fragment_size)
+            {
+                size_t size = std::min(fragment_size, submessage.size() - offset);
+                bool last = offset + size == submessage.size();
+
+                std::vector<uint8_t> fragment;
+                ucdrBuffer mb;
+                begin_submessage(fragment, &mb, SUBMESSAGE_ID_FRAGMENT, (last) ? FLAG_LAST_FRAGMENT : 0, size);
+                (void) ucdr_serialize_array_uint8_t(&mb, submessage.data() + offset, uint32_t(size));
+                end_submessage(fragment, &mb);
+                it->second.backlog.push_back(fragment);
+            }
+        }
+        flush_reliable_backlog(stream_id);
+    }
+}
+
+void StandInAgent::flush_reliable_backlog(uint8_t stream_id)
+{
+    OutputReliableStream& stream = output_reliable_[stream_id];
+    while(!stream.backlog.empty() && window_ > stream.unacked.size())
+    {
+        stream.last_sent = uxr_seq_num_add(stream.last_sent, 1);
+        std::vector<uint8_t>& message = stream.unacked[stream.last_sent];
+        message.swap(stream.backlog.front());
+        stream.backlog.pop_front();
+        push_message(stream_id, stream.last_sent, message);
+    }
+}
+
+void StandInAgent::push_message(uint8_t stream_id, uint16_t seq_num, const std::vector<uint8_t>& submessages)
+{
+    std::vector<uint8_t> message(MAX_HEADER_SIZE + submessages.size());
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, message.data(), uint32_t(message.size()));
+    uxr_serialize_message_header(&ub, session_id_, stream_id, seq_num, client_key_);
+
+    std::memcpy(ub.iterator, submessages.data(), submessages.size());
+    message.resize(ucdr_buffer_length(&ub) + submessages.size());
+
+    output_.push_back(message);
+    statistics_.messages_sent++;
+}
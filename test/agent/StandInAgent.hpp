@@ -0,0 +1,136 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _TEST_AGENT_STANDINAGENT_HPP_
+#define _TEST_AGENT_STANDINAGENT_HPP_
+
+#include <uxr/client/client.h>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+/*
+ * In-process replacement of the Agent, speaking enough XRCE for tests and benchmarks.
+ * It serves a single session: it accepts CREATE_CLIENT, CREATE, DELETE, WRITE_DATA and READ_DATA,
+ * keeps the reliable streams in both directions (ACKNACK, HEARTBEAT, retransmission and fragmentation),
+ * answers TIMESTAMP and echoes PERFORMANCE. Entities are not validated: every creation succeeds,
+ * and every sample written is delivered to the active READ_DATA requests.
+ * It is transport agnostic: messages are pushed with `receive` and pulled with `take_output`.
+ */
+class StandInAgent
+{
+public:
+    struct Statistics
+    {
+        size_t messages_received;
+        size_t messages_sent;
+        size_t samples_written;
+        size_t bytes_written;
+        size_t samples_delivered;
+        size_t performance_received;
+        size_t performance_echoes;
+        size_t retransmissions;
+        size_t heartbeats_sent;
+        size_t acknacks_sent;
+    };
+
+    explicit StandInAgent(uint16_t window = 16);
+
+    /* Processes a message sent by the Client. */
+    void receive(const uint8_t* buffer, size_t length);
+
+    /* Sends the heartbeats of the reliable streams with unacknowledged messages. */
+    void update(int64_t timestamp_ms);
+
+    /* Takes the next message to be sent to the Client. */
+    bool take_output(std::vector<uint8_t>& message);
+    bool has_output() const;
+
+    bool session_created() const { return session_created_; }
+    const Statistics& statistics() const { return statistics_; }
+    const std::vector<uint8_t>& last_sample() const { return last_sample_; }
+
+private:
+    struct InputReliableStream
+    {
+        uint16_t last_handled;
+        uint16_t last_announced;
+        std::map<uint16_t, std::vector<uint8_t>> pending;
+        std::vector<uint8_t> fragments;
+    };
+
+    struct OutputReliableStream
+    {
+        uint16_t last_sent;
+        uint16_t last_acknown;
+        std::map<uint16_t, std::vector<uint8_t>> unacked;
+        std::deque<std::vector<uint8_t>> backlog;
+    };
+
+    struct ReadRequest
+    {
+        uint8_t request_id[2];
+        uint8_t object_id[2];
+        uint8_t stream_id;
+    };
+
+    void reset();
+
+    void read_reliable_message(uint8_t stream_id, uint16_t seq_num, const uint8_t* payload, size_t length);
+    void read_submessages(uint8_t stream_id, const uint8_t* payload, size_t length);
+    void read_submessage(uint8_t stream_id, uint8_t submessage_id, uint8_t flags, ucdrBuffer* ub, uint16_t length);
+
+    void read_create_client(ucdrBuffer* ub);
+    void read_object_request(uint8_t stream_id, ucdrBuffer* ub, uint8_t status_operation);
+    void read_write_data(ucdrBuffer* ub, uint16_t length);
+    void read_read_data(ucdrBuffer* ub);
+    void read_heartbeat(ucdrBuffer* ub);
+    void read_acknack(ucdrBuffer* ub);
+    void read_fragment(uint8_t stream_id, uint8_t flags, ucdrBuffer* ub, uint16_t length);
+    void read_timestamp(ucdrBuffer* ub);
+#ifdef PERFORMANCE_TESTING
+    void read_performance(uint8_t stream_id, uint8_t flags, ucdrBuffer* ub, uint16_t length);
+#endif
+
+    void send_status(uint8_t stream_id, const uint8_t* request_id, const uint8_t* object_id, uint8_t status);
+    void send_acknack(uint8_t stream_id);
+    void send_heartbeat(uint8_t stream_id);
+
+    /* Sends a submessage (subheader included) through one of the Agent output streams. */
+    void send_submessage(uint8_t stream_id, const std::vector<uint8_t>& submessage);
+    void flush_reliable_backlog(uint8_t stream_id);
+    void push_message(uint8_t stream_id, uint16_t seq_num, const std::vector<uint8_t>& submessages);
+
+    uint16_t window_;
+    bool session_created_;
+    uint8_t session_id_;
+    uint8_t client_key_[4];
+    size_t mtu_;
+    int64_t received_timestamp_;
+    int64_t last_heartbeat_;
+
+    std::map<uint8_t, uint16_t> input_best_effort_;
+    std::map<uint8_t, InputReliableStream> input_reliable_;
+    std::map<uint8_t, uint16_t> output_best_effort_;
+    std::map<uint8_t, OutputReliableStream> output_reliable_;
+    std::vector<ReadRequest> read_requests_;
+
+    std::deque<std::vector<uint8_t>> output_;
+    std::vector<uint8_t> last_sample_;
+    Statistics statistics_;
+};
+
+#endif //_TEST_AGENT_STANDINAGENT_HPP_
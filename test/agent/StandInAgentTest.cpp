@@ -0,0 +1,357 @@
+#include <gtest/gtest.h>
+
+#include "ImpairedLink.hpp"
+#include "InMemoryLink.hpp"
+#include "SocketAgent.hpp"
+
+#include <uxr/client/client.h>
+#include <ucdr/microcdr.h>
+
+#include <fcntl.h>
+
+#define HISTORY 8
+#define MTU 128
+#define TIMEOUT 1000
+
+class StandInAgentTest : public testing::Test
+{
+public:
+    StandInAgentTest()
+        : link_(agent_, MTU)
+        , received_(0)
+        , topic_size_(0)
+    {
+    }
+
+    void init_session(uxrCommunication* comm, bool packed = false)
+    {
+        uxr_init_session(&session_, comm, 0xAAAABBBB);
+        uxr_set_topic_callback(&session_, on_topic, this);
+        ASSERT_TRUE(uxr_create_session(&session_));
+
+        reliable_out_ = (packed)
+                        ? uxr_create_output_packed_stream(&session_, packed_buffer_, sizeof(packed_buffer_), HISTORY * 4, MTU)
+                        : uxr_create_output_reliable_stream(&session_, output_buffer_, sizeof(output_buffer_), HISTORY);
+        reliable_in_ = uxr_create_input_reliable_stream(&session_, input_buffer_, sizeof(input_buffer_), HISTORY);
+    }
+
+    void create_entities()
+    {
+        participant_id_ = uxr_object_id(0x01, UXR_PARTICIPANT_ID);
+        topic_id_ = uxr_object_id(0x01, UXR_TOPIC_ID);
+        publisher_id_ = uxr_object_id(0x01, UXR_PUBLISHER_ID);
+        datawriter_id_ = uxr_object_id(0x01, UXR_DATAWRITER_ID);
+        subscriber_id_ = uxr_object_id(0x01, UXR_SUBSCRIBER_ID);
+        datareader_id_ = uxr_object_id(0x01, UXR_DATAREADER_ID);
+
+        uint16_t requests[6];
+        requests[0] = uxr_buffer_create_participant_ref(&session_, reliable_out_, participant_id_, 0, "participant", UXR_REPLACE);
+        requests[1] = uxr_buffer_create_topic_ref(&session_, reliable_out_, topic_id_, participant_id_, "topic", UXR_REPLACE);
+        requests[2] = uxr_buffer_create_publisher_xml(&session_, reliable_out_, publisher_id_, participant_id_, "", UXR_REPLACE);
+        requests[3] = uxr_buffer_create_datawriter_ref(&session_, reliable_out_, datawriter_id_, publisher_id_, "datawriter", UXR_REPLACE);
+        requests[4] = uxr_buffer_create_subscriber_xml(&session_, reliable_out_, subscriber_id_, participant_id_, "", UXR_REPLACE);
+        requests[5] = uxr_buffer_create_datareader_ref(&session_, reliable_out_, datareader_id_, subscriber_id_, "datareader", UXR_REPLACE);
+
+        uint8_t status[6];
+        ASSERT_TRUE(uxr_run_session_until_all_status(&session_, TIMEOUT, requests, status, 6));
+        for(size_t i = 0; i < 6; ++i)
+        {
+            ASSERT_EQ(UXR_STATUS_OK, status[i]);
+        }
+
+        (void) uxr_buffer_request_data(&session_, reliable_out_, datareader_id_, reliable_in_, NULL);
+    }
+
+    void write_and_read(size_t size)
+    {
+        std::vector<uint8_t> sample(size);
+        for(size_t i = 0; i < size; ++i)
+        {
+            sample[i] = uint8_t(i);
+        }
+
+        ucdrBuffer ub;
+        ASSERT_TRUE(uxr_prepare_output_stream(&session_, reliable_out_, datawriter_id_, &ub, uint32_t(size)));
+        ASSERT_TRUE(ucdr_serialize_array_uint8_t(&ub, sample.data(), uint32_t(size)));
+
+        received_ = 0;
+        topic_size_ = size;
+        for(int i = 0; i < 100 && 0 == received_; ++i)
+        {
+            (void) uxr_run_session_time(&session_, 10);
+        }
+        ASSERT_EQ(1u, received_);
+        ASSERT_EQ(sample, topic_);
+    }
+
+protected:
+    static void on_topic(uxrSession* session, uxrObjectId object_id, uint16_t request_id, uxrStreamId stream_id, ucdrBuffer* ub, void* args)
+    {
+        (void) session; (void) object_id; (void) request_id; (void) stream_id;
+        StandInAgentTest* test = static_cast<StandInAgentTest*>(args);
+        /* The topic of a fragmented message continues in the next buffers of the stream. */
+        test->topic_.resize(test->topic_size_);
+        (void) ucdr_deserialize_array_uint8_t(ub, test->topic_.data(), uint32_t(test->topic_size_));
+        test->received_++;
+    }
+
+    StandInAgent agent_;
+    InMemoryLink link_;
+    uxrSession session_;
+    uxrStreamId reliable_out_;
+    uxrStreamId reliable_in_;
+    uint8_t output_buffer_[MTU * HISTORY];
+    alignas(uxrPackedMessage) uint8_t packed_buffer_[UXR_PACKED_STREAM_OVERHEAD(HISTORY * 4) + MTU * HISTORY];
+    uint8_t input_buffer_[MTU * HISTORY];
+
+    uxrObjectId participant_id_;
+    uxrObjectId topic_id_;
+    uxrObjectId publisher_id_;
+    uxrObjectId datawriter_id_;
+    uxrObjectId subscriber_id_;
+    uxrObjectId datareader_id_;
+
+    size_t received_;
+    size_t topic_size_;
+    std::vector<uint8_t> topic_;
+};
+
+TEST_F(StandInAgentTest, CreateSession)
+{
+    init_session(link_.comm());
+    ASSERT_TRUE(agent_.session_created());
+
+    ASSERT_TRUE(uxr_delete_session(&session_));
+    ASSERT_FALSE(agent_.session_created());
+}
+
+TEST_F(StandInAgentTest, WriteRead)
+{
+    init_session(link_.comm());
+    create_entities();
+
+    write_and_read(16);
+    ASSERT_EQ(1u, agent_.statistics().samples_written);
+    ASSERT_EQ(1u, agent_.statistics().samples_delivered);
+    ASSERT_TRUE(uxr_run_session_until_confirm_delivery(&session_, TIMEOUT));
+}
+
+TEST_F(StandInAgentTest, WriteReadFragmented)
+{
+    init_session(link_.comm());
+    create_entities();
+
+    /* Larger than the MTU: fragmented by the Client when written, and by the agent when delivered. */
+    write_and_read(MTU * 2);
+    ASSERT_EQ(size_t(MTU * 2), agent_.last_sample().size());
+    ASSERT_TRUE(uxr_run_session_until_confirm_delivery(&session_, TIMEOUT));
+}
+
+TEST_F(StandInAgentTest, WriteReadPacked)
+{
+    init_session(link_.comm(), true);
+    create_entities();
+
+    write_and_read(16);
+    write_and_read(MTU * 2);
+    ASSERT_EQ(2u, agent_.statistics().samples_written);
+    ASSERT_TRUE(uxr_run_session_until_confirm_delivery(&session_, TIMEOUT));
+}
+
+TEST_F(StandInAgentTest, WriteReadLargerThanHistory)
+{
+    init_session(link_.comm());
+    std::vector<uint8_t> reassembly(MTU * HISTORY * 4);
+    ASSERT_TRUE(uxr_set_input_stream_reassembly(&session_, reliable_in_, reassembly.data(), reassembly.size()));
+    create_entities();
+
+    /* Streamed through the output history, which is flushed each time it fills up. */
+    const size_t size = MTU * HISTORY * 3;
+    std::vector<uint8_t> sample(size);
+    for(size_t i = 0; i < size; ++i)
+    {
+        sample[i] = uint8_t(i * 7);
+    }
+
+    ucdrBuffer ub;
+    ASSERT_TRUE(uxr_prepare_output_stream_fragmented(&session_, reliable_out_, datawriter_id_, &ub, size,
+                                                     [](uxrSession* session) { return uxr_run_session_until_confirm_delivery(session, TIMEOUT); }));
+    ASSERT_TRUE(ucdr_serialize_array_uint8_t(&ub, sample.data(), uint32_t(size)));
+
+    received_ = 0;
+    topic_size_ = size;
+    for(int i = 0; i < 100 && 0 == received_; ++i)
+    {
+        (void) uxr_run_session_time(&session_, 10);
+    }
+    ASSERT_EQ(1u, received_);
+    ASSERT_EQ(sample, topic_);
+    ASSERT_EQ(sample, agent_.last_sample());
+}
+
+TEST_F(StandInAgentTest, SyncSession)
+{
+    init_session(link_.comm());
+    ASSERT_TRUE(uxr_sync_session(&session_, TIMEOUT));
+}
+
+TEST_F(StandInAgentTest, ReliableUnderImpairment)
+{
+    Impairment impairment;
+    impairment.loss = 0.1;
+    impairment.burst_start = 0.02;
+    impairment.burst_end = 0.5;
+    impairment.delay_ms = 1;
+    impairment.jitter_ms = 1;
+    impairment.reorder = 0.1;
+    impairment.reorder_ms = 5;
+    impairment.duplicate = 0.1;
+    ImpairedLink impaired(link_.comm(), impairment, impairment, 3);
+
+    init_session(impaired.comm());
+    create_entities();
+
+    /* Every sample arrives, in order, despite the losses of both directions. */
+    for(size_t i = 1; i <= 20; ++i)
+    {
+        write_and_read(i);
+    }
+    ASSERT_TRUE(uxr_run_session_until_confirm_delivery(&session_, TIMEOUT * 10));
+    ASSERT_LT(0u, impaired.output_statistics().dropped);
+    ASSERT_LT(0u, impaired.input_statistics().dropped);
+}
+
+TEST_F(StandInAgentTest, CongestionControlUnderImpairment)
+{
+    Impairment impairment;
+    impairment.loss = 0.1;
+    impairment.burst_start = 0.02;
+    impairment.burst_end = 0.5;
+    impairment.delay_ms = 1;
+    ImpairedLink impaired(link_.comm(), impairment, impairment, 5);
+
+    init_session(impaired.comm());
+    ASSERT_TRUE(uxr_set_output_stream_congestion_control(&session_, reliable_out_, true));
+    create_entities();
+
+    /* The messages held back by the window are sent as the acknowledgements arrive. */
+    for(size_t i = 1; i <= 20; ++i)
+    {
+        write_and_read(i * 8);
+    }
+    ASSERT_TRUE(uxr_run_session_until_confirm_delivery(&session_, TIMEOUT * 10));
+    ASSERT_LT(0u, impaired.output_statistics().dropped);
+}
+
+TEST_F(StandInAgentTest, ReliableMessageLost)
+{
+    ImpairedLink impaired(link_.comm(), Impairment(), Impairment(), 11);
+    init_session(impaired.comm());
+    create_entities();
+
+    /* The message after the one lost waits in the reorder buffer of the Agent until the heartbeat recovers the loss. */
+    std::vector<uint8_t> sample(16);
+    received_ = 0;
+    topic_size_ = sample.size();
+    for(int i = 0; i < 2; ++i)
+    {
+        ucdrBuffer ub;
+        ASSERT_TRUE(uxr_prepare_output_stream(&session_, reliable_out_, datawriter_id_, &ub, uint32_t(sample.size())));
+        ASSERT_TRUE(ucdr_serialize_array_uint8_t(&ub, sample.data(), uint32_t(sample.size())));
+        if(0 == i)
+        {
+            impaired.drop_next_output();
+        }
+        uxr_flash_output_streams(&session_);
+    }
+
+    for(int i = 0; i < 100 && 2 > received_; ++i)
+    {
+        (void) uxr_run_session_time(&session_, 10);
+    }
+    ASSERT_EQ(2u, received_);
+    ASSERT_TRUE(uxr_run_session_until_confirm_delivery(&session_, TIMEOUT));
+    ASSERT_EQ(1u, impaired.output_statistics().dropped);
+    ASSERT_EQ(2u, agent_.statistics().samples_written);
+}
+
+TEST_F(StandInAgentTest, DelayedAcknack)
+{
+    Impairment impairment;
+    impairment.loss = 0.1;
+    impairment.delay_ms = 1;
+    ImpairedLink impaired(link_.comm(), impairment, impairment, 7);
+
+    init_session(impaired.comm());
+    ASSERT_TRUE(uxr_set_input_stream_acknack_delay(&session_, reliable_in_, HISTORY / 2, 20));
+    create_entities();
+
+    /* The samples of the Agent are acknowledged late, or at once after a loss, but all of them arrive. */
+    for(size_t i = 1; i <= 20; ++i)
+    {
+        write_and_read(i);
+    }
+    ASSERT_TRUE(uxr_run_session_until_confirm_delivery(&session_, TIMEOUT * 10));
+    ASSERT_LT(0u, impaired.input_statistics().dropped);
+}
+
+TEST_F(StandInAgentTest, UDPLoopback)
+{
+    SocketAgent socket_agent(SocketAgent::UDP);
+    ASSERT_TRUE(socket_agent.start());
+
+    uxrUDPTransport transport;
+    uxrUDPPlatform platform;
+    ASSERT_TRUE(uxr_init_udp_transport(&transport, &platform, "127.0.0.1", socket_agent.port()));
+
+    init_session(&transport.comm);
+    create_entities();
+    write_and_read(16);
+    ASSERT_TRUE(uxr_delete_session(&session_));
+    ASSERT_TRUE(uxr_close_udp_transport(&transport));
+
+    socket_agent.stop();
+    ASSERT_EQ(1u, socket_agent.agent().statistics().samples_delivered);
+}
+
+TEST_F(StandInAgentTest, TCPLoopback)
+{
+    SocketAgent socket_agent(SocketAgent::TCP);
+    ASSERT_TRUE(socket_agent.start());
+
+    uxrTCPTransport transport;
+    uxrTCPPlatform platform;
+    ASSERT_TRUE(uxr_init_tcp_transport(&transport, &platform, "127.0.0.1", socket_agent.port()));
+
+    init_session(&transport.comm);
+    create_entities();
+    write_and_read(16);
+    ASSERT_TRUE(uxr_delete_session(&session_));
+    ASSERT_TRUE(uxr_close_tcp_transport(&transport));
+
+    socket_agent.stop();
+    ASSERT_EQ(1u, socket_agent.agent().statistics().samples_delivered);
+}
+
+TEST_F(StandInAgentTest, SerialLoopback)
+{
+    SocketAgent socket_agent(SocketAgent::SERIAL);
+    ASSERT_TRUE(socket_agent.start());
+
+    int fd = open(socket_agent.device().c_str(), O_RDWR | O_NOCTTY);
+    ASSERT_NE(-1, fd);
+
+    uxrSerialTransport transport;
+    uxrSerialPlatform platform;
+    ASSERT_TRUE(uxr_init_serial_transport(&transport, &platform, fd,
+                                          SocketAgent::SERIAL_AGENT_ADDR, SocketAgent::SERIAL_CLIENT_ADDR));
+
+    init_session(&transport.comm);
+    create_entities();
+    write_and_read(16);
+    ASSERT_TRUE(uxr_delete_session(&session_));
+    ASSERT_TRUE(uxr_close_serial_transport(&transport));
+
+    socket_agent.stop();
+    ASSERT_EQ(1u, socket_agent.agent().statistics().samples_delivered);
+}
@@ -0,0 +1,573 @@
+/*
+ * End-to-end benchmark of the Client against the stand-in agent, built on the PERFORMANCE submessage.
+ * For every combination of transport, stream, payload, history and MTU it measures:
+ *   - latency: ping-pong of echoed PERFORMANCE submessages, the round trip measured with the epoch they carry.
+ *   - throughput: PERFORMANCE submessages sent one way as fast as the stream allows, counted by the agent.
+ *     Its time is the one taken to send them, until all are acknowledged on the reliable streams.
+ * The MTU is the size of the stream buffers (per slot in the reliable ones), bounded by the one of the transport.
+ * A fresh agent and session serve every combination.
+ */
+
+#include "SocketAgent.hpp"
+
+#include <uxr/client/client.h>
+#include <uxr/client/util/time.h>
+#include <ucdr/microcdr.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define CLIENT_KEY 0xBEEFCAFE
+#define SESSION_TIMEOUT_MS 1000
+#define BEST_EFFORT_ECHO_TIMEOUT_MS 100
+#define RELIABLE_ECHO_TIMEOUT_MS 1000
+#define DRAIN_MS 100
+
+namespace {
+
+enum Transport
+{
+    UDP,
+    TCP,
+    SERIAL
+};
+
+enum Stream
+{
+    BEST_EFFORT,
+    RELIABLE
+};
+
+struct Options
+{
+    std::vector<Transport> transports;
+    std::vector<Stream> streams;
+    std::vector<uint16_t> payloads;
+    std::vector<uint16_t> histories;
+    std::vector<uint16_t> mtus;
+    size_t iterations;
+    bool json;
+    std::string output;
+};
+
+struct Case
+{
+    Transport transport;
+    Stream stream;
+    uint16_t payload;
+    uint16_t history;
+    uint16_t mtu;
+};
+
+struct Latency
+{
+    size_t completed;
+    size_t lost;
+    double min_us;
+    double p50_us;
+    double p99_us;
+    double max_us;
+    double mean_us;
+};
+
+struct Throughput
+{
+    size_t sent;
+    size_t received;
+    double seconds;
+};
+
+struct Result
+{
+    Case bench_case;
+    Latency latency;
+    Throughput throughput;
+};
+
+const char* transport_name(Transport transport)
+{
+    return (UDP == transport) ? "udp" : (TCP == transport) ? "tcp" : "serial";
+}
+
+const char* stream_name(Stream stream)
+{
+    return (BEST_EFFORT == stream) ? "best_effort" : "reliable";
+}
+
+std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while(std::getline(stream, item, ','))
+    {
+        items.push_back(item);
+    }
+    return items;
+}
+
+bool parse_numbers(const std::string& list, std::vector<uint16_t>& numbers)
+{
+    numbers.clear();
+    for(const std::string& item : split(list))
+    {
+        char* end;
+        unsigned long number = std::strtoul(item.c_str(), &end, 10);
+        if('\0' != *end || 0 == number || UINT16_MAX < number)
+        {
+            return false;
+        }
+        numbers.push_back(uint16_t(number));
+    }
+    return !numbers.empty();
+}
+
+bool parse_options(int argc, char** argv, Options& options)
+{
+    options.transports = {UDP, TCP, SERIAL};
+    options.streams = {BEST_EFFORT, RELIABLE};
+    options.payloads = {16, 128, 400};
+    options.histories = {4, 16};
+    options.mtus = {128, 512};
+    options.iterations = 1000;
+    options.json = false;
+
+    bool rv = true;
+    for(int i = 1; i + 1 < argc && rv; i += 2)
+    {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if("--transports" == option)
+        {
+            options.transports.clear();
+            for(const std::string& item : split(value))
+            {
+                rv = rv && ("udp" == item || "tcp" == item || "serial" == item);
+                options.transports.push_back(("udp" == item) ? UDP : ("tcp" == item) ? TCP : SERIAL);
+            }
+        }
+        else if("--streams" == option)
+        {
+            options.streams.clear();
+            for(const std::string& item : split(value))
+            {
+                rv = rv && ("best_effort" == item || "reliable" == item);
+                options.streams.push_back(("best_effort" == item) ? BEST_EFFORT : RELIABLE);
+            }
+        }
+        else if("--payloads" == option)
+        {
+            /* An 8 bytes PERFORMANCE without echo is taken by the agent as a TIMESTAMP, hence no empty payloads. */
+            rv = parse_numbers(value, options.payloads);
+        }
+        else if("--histories" == option)
+        {
+            rv = parse_numbers(value, options.histories);
+        }
+        else if("--mtus" == option)
+        {
+            rv = parse_numbers(value, options.mtus);
+        }
+        else if("--iterations" == option)
+        {
+            options.iterations = std::strtoul(value.c_str(), NULL, 10);
+            rv = 0 != options.iterations;
+        }
+        else if("--format" == option)
+        {
+            rv = "csv" == value || "json" == value;
+            options.json = "json" == value;
+        }
+        else if("--output" == option)
+        {
+            options.output = value;
+        }
+        else
+        {
+            rv = false;
+        }
+    }
+    return rv && 1 == argc % 2;
+}
+
+uint16_t transport_mtu(Transport transport)
+{
+    uint16_t mtu = UXR_CONFIG_SERIAL_TRANSPORT_MTU;
+    switch(transport)
+    {
+        case UDP:
+            mtu = UXR_CONFIG_UDP_TRANSPORT_MTU;
+            break;
+        case TCP:
+            mtu = UXR_CONFIG_TCP_TRANSPORT_MTU;
+            break;
+        case SERIAL:
+            break;
+    }
+    return mtu;
+}
+
+/*
+ * Client side of a combination: the transport connected to the agent and the session over it.
+ */
+class Client
+{
+public:
+    explicit Client(const Case& bench_case)
+        : bench_case_(bench_case)
+        , comm_(NULL)
+        , session_created_(false)
+        , output_buffer_(size_t(bench_case.mtu) * bench_case.history)
+        , input_buffer_(size_t(bench_case.mtu) * bench_case.history)
+        , pending_epoch_(0)
+        , echoed_(false)
+    {
+    }
+
+    bool open(const SocketAgent& agent)
+    {
+        switch(bench_case_.transport)
+        {
+            case UDP:
+                comm_ = (uxr_init_udp_transport(&udp_, &udp_platform_, "127.0.0.1", agent.port())) ? &udp_.comm : NULL;
+                break;
+            case TCP:
+                comm_ = (uxr_init_tcp_transport(&tcp_, &tcp_platform_, "127.0.0.1", agent.port())) ? &tcp_.comm : NULL;
+                break;
+            case SERIAL:
+            {
+                int fd = ::open(agent.device().c_str(), O_RDWR | O_NOCTTY);
+                comm_ = (-1 != fd && uxr_init_serial_transport(&serial_, &serial_platform_, fd,
+                                                               SocketAgent::SERIAL_AGENT_ADDR,
+                                                               SocketAgent::SERIAL_CLIENT_ADDR)) ? &serial_.comm : NULL;
+                break;
+            }
+        }
+        if(NULL == comm_)
+        {
+            return false;
+        }
+
+        uxr_init_session(&session_, comm_, CLIENT_KEY);
+        uxr_set_performance_callback(&session_, on_performance, this);
+        session_created_ = uxr_create_session(&session_);
+        if(!session_created_)
+        {
+            return false;
+        }
+
+        if(BEST_EFFORT == bench_case_.stream)
+        {
+            output_ = uxr_create_output_best_effort_stream(&session_, output_buffer_.data(), bench_case_.mtu);
+            (void) uxr_create_input_best_effort_stream(&session_);
+        }
+        else
+        {
+            output_ = uxr_create_output_reliable_stream(&session_, output_buffer_.data(), output_buffer_.size(), bench_case_.history);
+            (void) uxr_create_input_reliable_stream(&session_, input_buffer_.data(), input_buffer_.size(), bench_case_.history);
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if(NULL == comm_)
+        {
+            return;
+        }
+        if(session_created_)
+        {
+            (void) uxr_delete_session(&session_);
+        }
+        switch(bench_case_.transport)
+        {
+            case UDP:
+                (void) uxr_close_udp_transport(&udp_);
+                break;
+            case TCP:
+                (void) uxr_close_tcp_transport(&tcp_);
+                break;
+            case SERIAL:
+                (void) uxr_close_serial_transport(&serial_);
+                break;
+        }
+    }
+
+    /* Whether a submessage of the payload fits in a stream buffer, checked on the empty stream. */
+    bool fits()
+    {
+        std::vector<uint8_t> payload(bench_case_.payload, 0x5A);
+        bool rv = uxr_buffer_performance(&session_, output_, 0, payload.data(), bench_case_.payload, true);
+        if(rv)
+        {
+            pending_epoch_ = 0;
+            (void) uxr_run_session_until_timeout(&session_, RELIABLE_ECHO_TIMEOUT_MS);
+        }
+        return rv;
+    }
+
+    Latency run_latency(size_t iterations)
+    {
+        std::vector<uint8_t> payload(bench_case_.payload, 0x5A);
+        int timeout = (BEST_EFFORT == bench_case_.stream) ? BEST_EFFORT_ECHO_TIMEOUT_MS : RELIABLE_ECHO_TIMEOUT_MS;
+        rtts_.clear();
+        rtts_.reserve(iterations);
+
+        for(size_t i = 0; i < iterations; ++i)
+        {
+            pending_epoch_ = uint64_t(uxr_nanos());
+            echoed_ = false;
+            if(!uxr_buffer_performance(&session_, output_, pending_epoch_, payload.data(), bench_case_.payload, true))
+            {
+                /* The reliable history is full of unacknowledged pings. */
+                (void) uxr_run_session_until_confirm_delivery(&session_, timeout);
+                continue;
+            }
+
+            int64_t deadline = uxr_millis() + timeout;
+            int64_t now = uxr_millis();
+            while(!echoed_ && now < deadline)
+            {
+                (void) uxr_run_session_until_timeout(&session_, int(deadline - now));
+                now = uxr_millis();
+            }
+        }
+
+        Latency latency = {};
+        latency.completed = rtts_.size();
+        latency.lost = iterations - rtts_.size();
+        if(!rtts_.empty())
+        {
+            std::sort(rtts_.begin(), rtts_.end());
+            double sum = 0;
+            for(int64_t rtt : rtts_)
+            {
+                sum += double(rtt);
+            }
+            latency.min_us = double(rtts_.front()) / 1000.0;
+            latency.p50_us = double(rtts_[rtts_.size() / 2]) / 1000.0;
+            latency.p99_us = double(rtts_[std::min(rtts_.size() - 1, rtts_.size() * 99 / 100)]) / 1000.0;
+            latency.max_us = double(rtts_.back()) / 1000.0;
+            latency.mean_us = sum / double(rtts_.size()) / 1000.0;
+        }
+        return latency;
+    }
+
+    Throughput run_throughput(size_t iterations)
+    {
+        std::vector<uint8_t> payload(bench_case_.payload, 0x5A);
+        Throughput throughput = {};
+
+        int64_t start = uxr_nanos();
+        for(size_t i = 0; i < iterations; ++i)
+        {
+            /* Every submessage in its own message, waiting for room in the reliable history when full. */
+            int64_t deadline = uxr_millis() + SESSION_TIMEOUT_MS;
+            bool buffered = uxr_buffer_performance(&session_, output_, 0, payload.data(), bench_case_.payload, false);
+            while(!buffered && uxr_millis() < deadline)
+            {
+                (void) uxr_run_session_until_timeout(&session_, 1);
+                buffered = uxr_buffer_performance(&session_, output_, 0, payload.data(), bench_case_.payload, false);
+            }
+            if(!buffered)
+            {
+                break;
+            }
+            uxr_flash_output_streams(&session_);
+            throughput.sent++;
+        }
+        if(RELIABLE == bench_case_.stream)
+        {
+            (void) uxr_run_session_until_confirm_delivery(&session_, SESSION_TIMEOUT_MS);
+        }
+        throughput.seconds = double(uxr_nanos() - start) / 1e9;
+
+        /* The agent may still be reading what was sent. */
+        (void) uxr_run_session_time(&session_, DRAIN_MS);
+        return throughput;
+    }
+
+private:
+    static void on_performance(uxrSession* session, ucdrBuffer* mb, void* args)
+    {
+        (void) session;
+        Client* client = static_cast<Client*>(args);
+
+        uint32_t epoch_lsb, epoch_msb;
+        (void) ucdr_deserialize_uint32_t(mb, &epoch_lsb);
+        (void) ucdr_deserialize_uint32_t(mb, &epoch_msb);
+        uint64_t epoch = (uint64_t(epoch_msb) << 32) | epoch_lsb;
+
+        /* Echoes arriving after their timeout are lost already. */
+        if(0 != client->pending_epoch_ && epoch == client->pending_epoch_ && !client->echoed_)
+        {
+            client->rtts_.push_back(uxr_nanos() - int64_t(epoch));
+            client->echoed_ = true;
+        }
+    }
+
+    Case bench_case_;
+    uxrCommunication* comm_;
+    bool session_created_;
+    uxrUDPTransport udp_;
+    uxrUDPPlatform udp_platform_;
+    uxrTCPTransport tcp_;
+    uxrTCPPlatform tcp_platform_;
+    uxrSerialTransport serial_;
+    uxrSerialPlatform serial_platform_;
+    uxrSession session_;
+    uxrStreamId output_;
+    std::vector<uint8_t> output_buffer_;
+    std::vector<uint8_t> input_buffer_;
+    uint64_t pending_epoch_;
+    bool echoed_;
+    std::vector<int64_t> rtts_;
+};
+
+bool run_case(const Case& bench_case, size_t iterations, Result& result)
+{
+    SocketAgent agent((UDP == bench_case.transport) ? SocketAgent::UDP
+                      : (TCP == bench_case.transport) ? SocketAgent::TCP
+                      : SocketAgent::SERIAL);
+    if(!agent.start())
+    {
+        return false;
+    }
+
+    Client client(bench_case);
+    bool rv = client.open(agent) && client.fits();
+    if(rv)
+    {
+        result.bench_case = bench_case;
+        result.latency = client.run_latency(iterations);
+        result.throughput = client.run_throughput(iterations);
+    }
+    client.close();
+
+    agent.stop();
+    if(rv)
+    {
+        /* The echoed ones, the one checking the size included, are not part of the throughput. */
+        result.throughput.received = agent.agent().statistics().performance_received
+                                   - agent.agent().statistics().performance_echoes;
+    }
+    return rv;
+}
+
+void write_csv(std::ostream& out, const std::vector<Result>& results)
+{
+    out << "transport,stream,payload,history,mtu,"
+        << "echoes,lost_echoes,rtt_min_us,rtt_p50_us,rtt_p99_us,rtt_max_us,rtt_mean_us,"
+        << "sent,received,msgs_per_s,bytes_per_s\n";
+    for(const Result& result : results)
+    {
+        const Case& c = result.bench_case;
+        const Latency& l = result.latency;
+        const Throughput& t = result.throughput;
+        out << transport_name(c.transport) << ',' << stream_name(c.stream) << ','
+            << c.payload << ',' << c.history << ',' << c.mtu << ','
+            << l.completed << ',' << l.lost << ',' << l.min_us << ',' << l.p50_us << ','
+            << l.p99_us << ',' << l.max_us << ',' << l.mean_us << ','
+            << t.sent << ',' << t.received << ',' << double(t.received) / t.seconds << ','
+            << double(t.received) * c.payload / t.seconds << '\n';
+    }
+}
+
+void write_json(std::ostream& out, const std::vector<Result>& results)
+{
+    out << "[\n";
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        const Case& c = results[i].bench_case;
+        const Latency& l = results[i].latency;
+        const Throughput& t = results[i].throughput;
+        out << "  {\"transport\": \"" << transport_name(c.transport) << "\", \"stream\": \"" << stream_name(c.stream)
+            << "\", \"payload\": " << c.payload << ", \"history\": " << c.history << ", \"mtu\": " << c.mtu
+            << ",\n   \"latency\": {\"echoes\": " << l.completed << ", \"lost\": " << l.lost
+            << ", \"min_us\": " << l.min_us << ", \"p50_us\": " << l.p50_us << ", \"p99_us\": " << l.p99_us
+            << ", \"max_us\": " << l.max_us << ", \"mean_us\": " << l.mean_us << "}"
+            << ",\n   \"throughput\": {\"sent\": " << t.sent << ", \"received\": " << t.received
+            << ", \"msgs_per_s\": " << double(t.received) / t.seconds
+            << ", \"bytes_per_s\": " << double(t.received) * c.payload / t.seconds << "}}"
+            << ((i + 1 < results.size()) ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if(!parse_options(argc, argv, options))
+    {
+        std::cerr << "usage: " << argv[0]
+                  << " [--transports udp,tcp,serial] [--streams best_effort,reliable]"
+                  << " [--payloads 16,128,400] [--histories 4,16] [--mtus 128,512]"
+                  << " [--iterations 1000] [--format csv|json] [--output <file>]" << std::endl;
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for(Transport transport : options.transports)
+    {
+        for(Stream stream : options.streams)
+        {
+            /* The history only applies to the reliable streams. */
+            std::vector<uint16_t> histories = (RELIABLE == stream) ? options.histories : std::vector<uint16_t>(1, 1);
+            for(uint16_t history : histories)
+            {
+                for(uint16_t mtu : options.mtus)
+                {
+                    for(uint16_t payload : options.payloads)
+                    {
+                        Case bench_case = {transport, stream, payload, history, mtu};
+                        std::cerr << transport_name(transport) << ' ' << stream_name(stream)
+                                  << " payload " << payload << " history " << history << " mtu " << mtu;
+
+                        Result result;
+                        if(mtu > transport_mtu(transport))
+                        {
+                            std::cerr << ": skipped, over the transport MTU" << std::endl;
+                        }
+                        else if(!run_case(bench_case, options.iterations, result))
+                        {
+                            std::cerr << ": skipped, no session or the payload does not fit" << std::endl;
+                        }
+                        else
+                        {
+                            std::cerr << std::endl;
+                            results.push_back(result);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::ofstream file;
+    if(!options.output.empty())
+    {
+        file.open(options.output);
+    }
+    std::ostream& out = (file.is_open()) ? file : std::cout;
+    if(options.json)
+    {
+        write_json(out, results);
+    }
+    else
+    {
+        write_csv(out, results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * Microbenchmarks of the per message serialization: the session header, the subheaders and
+ * the xrce_protocol payloads sent and received on every message.
+ * The `Serialized` header benchmarks go field by field through Micro-CDR, as the session did
+ * before stamping its header template and loading the subheaders in place, for comparison;
+ * likewise `Deserialize` against the fixed-size `Read` of the control submessages.
+ */
+
+#include <benchmark/benchmark.h>
+
+extern "C"
+{
+#include <c/core/serialization/xrce_protocol.c>
+#include <c/core/serialization/xrce_header.c>
+#include <c/core/serialization/xrce_subheader.c>
+#include <c/core/session/object_id.c>
+#include <c/core/session/submessage.c>
+#include <c/core/session/session_info.c>
+}
+
+#define BUFFER_SIZE     size_t(512)
+#define SESSION_KEY     0xAABBCCDD
+#define SUBMESSAGES     16
+
+namespace {
+
+/* The argument is the session id, with (0x01) or without (0x81) client key. */
+void BM_SessionHeaderSerialized(benchmark::State& state)
+{
+    uxrSessionInfo info;
+    uxr_init_session_info(&info, uint8_t(state.range(0)), SESSION_KEY);
+    uint8_t buffer[BUFFER_SIZE];
+    uxrSeqNum seq_num = 0;
+    for(auto _ : state)
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, buffer, MAX_HEADER_SIZE);
+        uxr_serialize_message_header(&ub, info.id, 0x80, seq_num++, info.key);
+        benchmark::DoNotOptimize(buffer);
+        benchmark::ClobberMemory();
+    }
+}
+
+void BM_StampSessionHeader(benchmark::State& state)
+{
+    uxrSessionInfo info;
+    uxr_init_session_info(&info, uint8_t(state.range(0)), SESSION_KEY);
+    uint8_t buffer[BUFFER_SIZE];
+    uxrSeqNum seq_num = 0;
+    for(auto _ : state)
+    {
+        uxr_stamp_session_header(&info, 0x80, seq_num++, buffer);
+        benchmark::DoNotOptimize(buffer);
+        benchmark::ClobberMemory();
+    }
+}
+
+void BM_ReadSessionHeader(benchmark::State& state)
+{
+    uxrSessionInfo info;
+    uxr_init_session_info(&info, uint8_t(state.range(0)), SESSION_KEY);
+    uint8_t buffer[BUFFER_SIZE] = {0};
+    uxr_stamp_session_header(&info, 0x80, 1, buffer);
+    for(auto _ : state)
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, buffer, BUFFER_SIZE);
+        uint8_t stream_id_raw; uxrSeqNum seq_num;
+        benchmark::DoNotOptimize(uxr_read_session_header(&info, &ub, &stream_id_raw, &seq_num));
+    }
+}
+
+/* A message of SUBMESSAGES submessages with unaligned payloads, its subheaders read one after another. */
+void fill_submessages(uint8_t* buffer)
+{
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, buffer, BUFFER_SIZE);
+    for(int i = 0; i < SUBMESSAGES; ++i)
+    {
+        uint16_t length = uint16_t(1 + i % 4);
+        (void) uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_DATA, length, 0);
+        ub.iterator += length;
+    }
+}
+
+void BM_SubmessageHeadersSerialized(benchmark::State& state)
+{
+    uint8_t buffer[BUFFER_SIZE];
+    fill_submessages(buffer);
+    for(auto _ : state)
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, buffer, BUFFER_SIZE);
+        for(int i = 0; i < SUBMESSAGES; ++i)
+        {
+            uint8_t id; uint16_t length; uint8_t flags;
+            ucdr_align_to(&ub, 4);
+            uxr_deserialize_submessage_header(&ub, &id, &flags, &length);
+            ub.iterator += length;
+            benchmark::DoNotOptimize(id);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * SUBMESSAGES);
+}
+
+void BM_ReadSubmessageHeaders(benchmark::State& state)
+{
+    uint8_t buffer[BUFFER_SIZE];
+    fill_submessages(buffer);
+    for(auto _ : state)
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, buffer, BUFFER_SIZE);
+        for(int i = 0; i < SUBMESSAGES; ++i)
+        {
+            uint8_t id = 0; uint16_t length = 0; uint8_t flags;
+            (void) uxr_read_submessage_header(&ub, &id, &length, &flags);
+            ub.iterator += length;
+            benchmark::DoNotOptimize(id);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * SUBMESSAGES);
+}
+
+void BM_BufferSubmessageHeader(benchmark::State& state)
+{
+    uint8_t buffer[BUFFER_SIZE];
+    for(auto _ : state)
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, buffer, BUFFER_SIZE);
+        benchmark::DoNotOptimize(uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_WRITE_DATA, 8, 0));
+    }
+}
+
+//==================================================================
+//                             PAYLOADS
+//==================================================================
+template<typename Payload>
+void BM_Serialize(benchmark::State& state, Payload payload, bool (*serialize)(ucdrBuffer*, const Payload*))
+{
+    uint8_t buffer[BUFFER_SIZE];
+    for(auto _ : state)
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, buffer, BUFFER_SIZE);
+        benchmark::DoNotOptimize(serialize(&ub, &payload));
+    }
+}
+
+template<typename Payload>
+void BM_Deserialize(benchmark::State& state, Payload payload,
+                    bool (*serialize)(ucdrBuffer*, const Payload*), bool (*deserialize)(ucdrBuffer*, Payload*))
+{
+    uint8_t buffer[BUFFER_SIZE];
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, buffer, BUFFER_SIZE);
+    (void) serialize(&ub, &payload);
+    for(auto _ : state)
+    {
+        ucdr_init_buffer(&ub, buffer, BUFFER_SIZE);
+        benchmark::DoNotOptimize(deserialize(&ub, &payload));
+    }
+}
+
+/* The fixed-size decoders, against the same buffers. */
+template<typename Payload>
+void BM_Read(benchmark::State& state, Payload payload,
+             bool (*serialize)(ucdrBuffer*, const Payload*), bool (*read)(ucdrBuffer*, Payload*))
+{
+    BM_Deserialize(state, payload, serialize, read);
+}
+
+HEARTBEAT_Payload heartbeat()
+{
+    HEARTBEAT_Payload payload = {1, 10, 0x80};
+    return payload;
+}
+
+ACKNACK_Payload acknack()
+{
+    ACKNACK_Payload payload = {1, {0x00, 0x05}, 0x80};
+    return payload;
+}
+
+WRITE_DATA_Payload_Data write_data()
+{
+    WRITE_DATA_Payload_Data payload = {{{{0x00, 0x0A}}, {{0x00, 0x15}}}};
+    return payload;
+}
+
+READ_DATA_Payload read_data()
+{
+    READ_DATA_Payload payload = {};
+    payload.base = write_data().base;
+    payload.read_specification.preferred_stream_id = 0x80;
+    payload.read_specification.data_format = FORMAT_DATA;
+    return payload;
+}
+
+STATUS_Payload status()
+{
+    STATUS_Payload payload = {};
+    payload.base.related_request = write_data().base;
+    return payload;
+}
+
+TIMESTAMP_REPLY_Payload timestamp_reply()
+{
+    TIMESTAMP_REPLY_Payload payload = {{1, 2}, {3, 4}, {5, 6}};
+    return payload;
+}
+
+} // namespace
+
+BENCHMARK(BM_SessionHeaderSerialized)->Arg(0x01)->Arg(0x81);
+BENCHMARK(BM_StampSessionHeader)->Arg(0x01)->Arg(0x81);
+BENCHMARK(BM_ReadSessionHeader)->Arg(0x01)->Arg(0x81);
+BENCHMARK(BM_SubmessageHeadersSerialized);
+BENCHMARK(BM_ReadSubmessageHeaders);
+BENCHMARK(BM_BufferSubmessageHeader);
+
+BENCHMARK_CAPTURE(BM_Serialize, HEARTBEAT, heartbeat(), uxr_serialize_HEARTBEAT_Payload);
+BENCHMARK_CAPTURE(BM_Deserialize, HEARTBEAT, heartbeat(), uxr_serialize_HEARTBEAT_Payload, uxr_deserialize_HEARTBEAT_Payload);
+BENCHMARK_CAPTURE(BM_Read, HEARTBEAT, heartbeat(), uxr_serialize_HEARTBEAT_Payload, uxr_read_HEARTBEAT_Payload);
+BENCHMARK_CAPTURE(BM_Serialize, ACKNACK, acknack(), uxr_serialize_ACKNACK_Payload);
+BENCHMARK_CAPTURE(BM_Deserialize, ACKNACK, acknack(), uxr_serialize_ACKNACK_Payload, uxr_deserialize_ACKNACK_Payload);
+BENCHMARK_CAPTURE(BM_Read, ACKNACK, acknack(), uxr_serialize_ACKNACK_Payload, uxr_read_ACKNACK_Payload);
+BENCHMARK_CAPTURE(BM_Serialize, WRITE_DATA, write_data(), uxr_serialize_WRITE_DATA_Payload_Data);
+BENCHMARK_CAPTURE(BM_Serialize, READ_DATA, read_data(), uxr_serialize_READ_DATA_Payload);
+BENCHMARK_CAPTURE(BM_Deserialize, STATUS, status(), uxr_serialize_STATUS_Payload, uxr_deserialize_STATUS_Payload);
+BENCHMARK_CAPTURE(BM_Read, STATUS, status(), uxr_serialize_STATUS_Payload, uxr_read_STATUS_Payload);
+BENCHMARK_CAPTURE(BM_Deserialize, TIMESTAMP_REPLY, timestamp_reply(), uxr_serialize_TIMESTAMP_REPLY_Payload, uxr_deserialize_TIMESTAMP_REPLY_Payload);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,435 @@
+/*
+ * Microbenchmarks of the reliable stream algorithms, driven directly without session nor transport.
+ * Every benchmark takes the history as argument. The output ones report the cost of each call,
+ * the patterns (in-order, out-of-order, fragmented, lossy) report it per message through the `message` rate.
+ * Slots are of SLOT_SIZE bytes, and every message fills one of them.
+ */
+
+#include <benchmark/benchmark.h>
+
+extern "C"
+{
+#include <c/core/session/stream/seq_num.c>
+#include <c/core/session/stream/input_reliable_stream.c>
+#include <c/core/session/stream/output_reliable_stream.c>
+#include <c/util/histogram.c>
+}
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define SLOT_SIZE           size_t(64)
+#define OFFSET              uint8_t(8)
+#define FRAGMENT_OFFSET     size_t(4)
+#define MESSAGE_SIZE        (SLOT_SIZE - INTERNAL_RELIABLE_BUFFER_OFFSET)
+#define SUBMESSAGE_SIZE     (MESSAGE_SIZE - OFFSET)
+#define MAX_FRAGMENTS       size_t(4)
+#define LOSS_RATE           0.1
+#define SEED                42
+
+namespace {
+
+size_t fragmentation_parses = 0;
+
+/* The first byte of every message carries its FragmentationInfo. */
+FragmentationInfo on_get_fragmentation_info(uint8_t* buffer)
+{
+    ++fragmentation_parses;
+    return FragmentationInfo(buffer[0]);
+}
+
+void on_new_fragment(ucdrBuffer* ub, uxrOutputReliableStream* stream)
+{
+    (void) ub; (void) stream;
+}
+
+class OutputStream
+{
+public:
+    explicit OutputStream(uint16_t history)
+        : buffer_(SLOT_SIZE * history)
+    {
+        uxr_init_output_reliable_stream(&stream, buffer_.data(), buffer_.size(), history, OFFSET, on_new_fragment);
+    }
+
+    /* Writes a message filling a slot and sends it. */
+    void write_and_send()
+    {
+        ucdrBuffer ub;
+        (void) uxr_prepare_reliable_buffer_to_write(&stream, SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub);
+        uint8_t* buffer; size_t length; uxrSeqNum seq_num;
+        (void) uxr_prepare_next_reliable_buffer_to_send(&stream, &buffer, &length, &seq_num);
+    }
+
+    /* Acknowledges everything sent. */
+    void acknowledge()
+    {
+        uxr_process_acknack(&stream, 0, uxr_seq_num_add(stream.last_sent, 1));
+    }
+
+    uxrOutputReliableStream stream;
+
+private:
+    std::vector<uint8_t> buffer_;
+};
+
+class InputStream
+{
+public:
+    explicit InputStream(uint16_t history)
+        : buffer_(SLOT_SIZE * history)
+        , next_(0)
+    {
+        created = uxr_init_input_reliable_stream(&stream, buffer_.data(), buffer_.size(), history, on_get_fragmentation_info);
+        message_[0] = NO_FRAGMENTED;
+    }
+
+    /* Skips the benchmark when the history is above CONFIG_MAX_INPUT_RELIABLE_HISTORY. */
+    bool rejected(benchmark::State& state) const
+    {
+        if(!created)
+        {
+            state.SkipWithError("history above CONFIG_MAX_INPUT_RELIABLE_HISTORY");
+        }
+        return !created;
+    }
+
+    /* Receives the message, reading it when it is the next one or the last fragment. */
+    void receive(uxrSeqNum seq_num, FragmentationInfo fragmentation_info = NO_FRAGMENTED)
+    {
+        message_[0] = uint8_t(fragmentation_info);
+        bool message_stored;
+        if(uxr_receive_reliable_message(&stream, seq_num, message_, MESSAGE_SIZE, &message_stored))
+        {
+            read_available();
+        }
+    }
+
+    /* Reads the stored messages, as the session does after a message ready to read. */
+    void read_available()
+    {
+        ucdrBuffer ub;
+        while(uxr_next_input_reliable_buffer_available(&stream, &ub, FRAGMENT_OFFSET))
+        {
+            benchmark::DoNotOptimize(ub.iterator);
+        }
+    }
+
+    uxrSeqNum next() { return next_; }
+    void advance(uint16_t messages) { next_ = uxr_seq_num_add(next_, messages); }
+
+    uxrInputReliableStream stream;
+    bool created;
+
+private:
+    std::vector<uint8_t> buffer_;
+    uint8_t message_[MESSAGE_SIZE];
+    uxrSeqNum next_;
+};
+
+void set_message_rate(benchmark::State& state, size_t messages_per_iteration)
+{
+    state.counters["message"] = benchmark::Counter(double(state.iterations()) * double(messages_per_iteration),
+                                                   benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+//==================================================================
+//                             OUTPUT
+//==================================================================
+/* When the history is full, the window is moved forward by hand so the acknowledgement is not measured. */
+void BM_PrepareReliableBufferToWrite(benchmark::State& state)
+{
+    OutputStream output(uint16_t(state.range(0)));
+    ucdrBuffer ub;
+    for(auto _ : state)
+    {
+        if(!uxr_prepare_reliable_buffer_to_write(&output.stream, SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub))
+        {
+            output.stream.last_sent = output.stream.last_written;
+            output.stream.last_acknown = output.stream.last_written;
+        }
+        benchmark::DoNotOptimize(ub.iterator);
+    }
+}
+
+/* The whole history is written once, and sent again every time it has been sent. */
+void BM_PrepareNextReliableBufferToSend(benchmark::State& state)
+{
+    uint16_t history = uint16_t(state.range(0));
+    OutputStream output(history);
+    ucdrBuffer ub;
+    for(uint16_t i = 0; i < history; ++i)
+    {
+        (void) uxr_prepare_reliable_buffer_to_write(&output.stream, SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub);
+    }
+    uxrSeqNum last_written = output.stream.last_written;
+    uxrSeqNum last_sent = output.stream.last_sent;
+
+    uint8_t* buffer; size_t length; uxrSeqNum seq_num;
+    for(auto _ : state)
+    {
+        if(!uxr_prepare_next_reliable_buffer_to_send(&output.stream, &buffer, &length, &seq_num))
+        {
+            output.stream.last_written = last_written;
+            output.stream.last_sent = last_sent;
+        }
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+
+void BM_OutputInOrder(benchmark::State& state)
+{
+    OutputStream output(uint16_t(state.range(0)));
+    for(auto _ : state)
+    {
+        output.write_and_send();
+        output.acknowledge();
+    }
+    set_message_rate(state, 1);
+}
+
+/* Messages of several slots, sent and acknowledged as a whole. */
+void BM_OutputFragmented(benchmark::State& state)
+{
+    uint16_t history = uint16_t(state.range(0));
+    OutputStream output(history);
+    size_t fragments = std::min(MAX_FRAGMENTS, size_t(history / 2));
+    size_t length = fragments * (MESSAGE_SIZE - OFFSET - FRAGMENT_OFFSET);
+
+    ucdrBuffer ub;
+    uint8_t* buffer; size_t buffer_length; uxrSeqNum seq_num;
+    for(auto _ : state)
+    {
+        (void) uxr_prepare_reliable_buffer_to_write(&output.stream, length, FRAGMENT_OFFSET, &ub);
+        while(uxr_prepare_next_reliable_buffer_to_send(&output.stream, &buffer, &buffer_length, &seq_num))
+        {
+            benchmark::DoNotOptimize(buffer);
+        }
+        output.acknowledge();
+    }
+    set_message_rate(state, 1);
+}
+
+/*
+ * The history is sent and a LOSS_RATE of it negatively acknowledged, which makes the Client send again
+ * every unacknowledged buffer. Then all is acknowledged.
+ */
+void BM_OutputLossy(benchmark::State& state)
+{
+    uint16_t history = uint16_t(state.range(0));
+    OutputStream output(history);
+    std::mt19937 generator(SEED);
+    std::bernoulli_distribution lost(LOSS_RATE);
+
+    uint8_t* buffer; size_t length;
+    for(auto _ : state)
+    {
+        uxrSeqNum first = uxr_seq_num_add(output.stream.last_sent, 1);
+        for(uint16_t i = 0; i < history; ++i)
+        {
+            output.write_and_send();
+        }
+
+        state.PauseTiming();
+        uint16_t bitmap = 0;
+        for(uint16_t i = 0; i < 16 && i < history; ++i)
+        {
+            bitmap = uint16_t(bitmap | (lost(generator) << i));
+        }
+        state.ResumeTiming();
+
+        uxr_process_acknack(&output.stream, bitmap, first);
+        uxrSeqNum seq_num_it = uxr_begin_output_nack_buffer_it(&output.stream);
+        while(uxr_next_reliable_nack_buffer_to_send(&output.stream, &buffer, &length, &seq_num_it))
+        {
+            benchmark::DoNotOptimize(buffer);
+        }
+        output.acknowledge();
+    }
+    set_message_rate(state, history);
+}
+
+//==================================================================
+//                             INPUT
+//==================================================================
+void BM_InputInOrder(benchmark::State& state)
+{
+    InputStream input(uint16_t(state.range(0)));
+    if(input.rejected(state))
+    {
+        return;
+    }
+    for(auto _ : state)
+    {
+        input.receive(input.next());
+        input.advance(1);
+    }
+    set_message_rate(state, 1);
+}
+
+/* Every window of history messages arrives shuffled. */
+void BM_InputOutOfOrder(benchmark::State& state)
+{
+    uint16_t history = uint16_t(state.range(0));
+    InputStream input(history);
+    if(input.rejected(state))
+    {
+        return;
+    }
+    std::vector<uint16_t> order(history);
+    for(uint16_t i = 0; i < history; ++i)
+    {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(SEED));
+
+    for(auto _ : state)
+    {
+        for(uint16_t i : order)
+        {
+            input.receive(uxr_seq_num_add(input.next(), i));
+        }
+        input.advance(history);
+    }
+    set_message_rate(state, history);
+}
+
+/* Messages of several fragments arriving in order, read once the last one arrives. */
+void BM_InputFragmented(benchmark::State& state)
+{
+    uint16_t history = uint16_t(state.range(0));
+    InputStream input(history);
+    if(input.rejected(state))
+    {
+        return;
+    }
+    uint16_t fragments = uint16_t(std::min(MAX_FRAGMENTS, size_t(history / 2)));
+
+    for(auto _ : state)
+    {
+        for(uint16_t i = 0; i < fragments; ++i)
+        {
+            FragmentationInfo info = (i + 1 == fragments) ? LAST_FRAGMENT : INTERMEDIATE_FRAGMENT;
+            input.receive(uxr_seq_num_add(input.next(), i), info);
+        }
+        input.read_available();
+        input.advance(fragments);
+    }
+    set_message_rate(state, 1);
+}
+
+/* A large sample spanning half the history, its fragments arriving in order. */
+void BM_InputLargeSample(benchmark::State& state)
+{
+    uint16_t history = uint16_t(state.range(0));
+    InputStream input(history);
+    if(input.rejected(state))
+    {
+        return;
+    }
+    uint16_t fragments = uint16_t(history / 2);
+
+    fragmentation_parses = 0;
+    for(auto _ : state)
+    {
+        for(uint16_t i = 0; i < fragments; ++i)
+        {
+            FragmentationInfo info = (i + 1 == fragments) ? LAST_FRAGMENT : INTERMEDIATE_FRAGMENT;
+            input.receive(uxr_seq_num_add(input.next(), i), info);
+        }
+        input.read_available();
+        input.advance(fragments);
+    }
+    set_message_rate(state, fragments);
+    /* Fragment headers parsed per fragment received. */
+    state.counters["parses"] = double(fragmentation_parses) / (double(state.iterations()) * double(fragments));
+}
+
+/* A LOSS_RATE of every window is lost, computed in the ACKNACK and received again. */
+void BM_InputLossy(benchmark::State& state)
+{
+    uint16_t history = uint16_t(state.range(0));
+    InputStream input(history);
+    if(input.rejected(state))
+    {
+        return;
+    }
+    std::mt19937 generator(SEED);
+    std::bernoulli_distribution lost(LOSS_RATE);
+    std::vector<uint16_t> losses;
+    losses.reserve(history);
+
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        losses.clear();
+        for(uint16_t i = 0; i < history; ++i)
+        {
+            if(lost(generator))
+            {
+                losses.push_back(i);
+            }
+        }
+        state.ResumeTiming();
+
+        std::vector<uint16_t>::const_iterator loss = losses.begin();
+        for(uint16_t i = 0; i < history; ++i)
+        {
+            if(losses.end() != loss && *loss == i)
+            {
+                ++loss;
+                continue;
+            }
+            input.receive(uxr_seq_num_add(input.next(), i));
+        }
+
+        uxrSeqNum from;
+        benchmark::DoNotOptimize(uxr_compute_acknack(&input.stream, &from));
+        for(uint16_t i : losses)
+        {
+            input.receive(uxr_seq_num_add(input.next(), i));
+        }
+        input.advance(history);
+    }
+    set_message_rate(state, history);
+}
+
+/* Every other message of the history is missing. */
+void BM_ComputeAcknack(benchmark::State& state)
+{
+    uint16_t history = uint16_t(state.range(0));
+    InputStream input(history);
+    if(input.rejected(state))
+    {
+        return;
+    }
+    for(uint16_t i = 1; i < history; i = uint16_t(i + 2))
+    {
+        input.receive(i);
+    }
+
+    uxrSeqNum from;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(uxr_compute_acknack(&input.stream, &from));
+    }
+}
+
+} // namespace
+
+#define HISTORIES RangeMultiplier(4)->Range(2, 1024)
+
+BENCHMARK(BM_PrepareReliableBufferToWrite)->HISTORIES;
+BENCHMARK(BM_PrepareNextReliableBufferToSend)->HISTORIES;
+BENCHMARK(BM_OutputInOrder)->HISTORIES;
+BENCHMARK(BM_OutputFragmented)->HISTORIES;
+BENCHMARK(BM_OutputLossy)->HISTORIES;
+BENCHMARK(BM_InputInOrder)->HISTORIES;
+BENCHMARK(BM_InputOutOfOrder)->HISTORIES;
+BENCHMARK(BM_InputFragmented)->HISTORIES;
+BENCHMARK(BM_InputLargeSample)->HISTORIES;
+BENCHMARK(BM_InputLossy)->HISTORIES;
+BENCHMARK(BM_ComputeAcknack)->HISTORIES;
+
+BENCHMARK_MAIN();
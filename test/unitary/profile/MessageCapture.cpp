@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+extern "C"
+{
+#include <c/profile/capture/message_capture_linux.c>
+#include <c/util/time.c>
+}
+
+#define CAPTURE_PATH        "/tmp/message_capture.pcapng"
+#define RING_SIZE           256
+#define MESSAGES            20
+#define RECV_TIMESTAMP      INT64_C(0x0000012345678901)
+
+/* The session is stubbed: the capture only sets its message callback and reads the receive timestamp. */
+extern "C" void uxr_set_message_callback(uxrSession* session, uxrOnMessageFunc on_message_func, void* args)
+{
+    session->on_message = on_message_func;
+    session->on_message_args = args;
+}
+
+extern "C" int64_t uxr_message_timestamp(const uxrSession* session)
+{
+    (void) session;
+    return RECV_TIMESTAMP;
+}
+
+struct Packet
+{
+    int64_t timestamp;
+    uint32_t flags;
+    std::vector<uint8_t> data;
+};
+
+class MessageCaptureTest : public testing::Test
+{
+public:
+    MessageCaptureTest()
+        : session()
+    {
+        (void) unlink(CAPTURE_PATH);
+    }
+
+    virtual ~MessageCaptureTest()
+    {
+        (void) unlink(CAPTURE_PATH);
+    }
+
+    /* Captures a message as the session does, waiting for the writer thread to drain the ring. */
+    void capture(bool output, const std::vector<uint8_t>& message)
+    {
+        session.on_message(&session, output, message.data(), message.size(), session.on_message_args);
+        while(__atomic_load_n(&capture_.tail, __ATOMIC_ACQUIRE) != capture_.head)
+        {
+            usleep(100);
+        }
+    }
+
+    /* Decodes the pcapng file, checking the section and interface blocks. */
+    std::vector<Packet> decode()
+    {
+        std::ifstream file(CAPTURE_PATH, std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::vector<Packet> packets;
+
+        size_t offset = 0;
+        while(offset + 12 <= bytes.size())
+        {
+            uint32_t type = read_word(bytes, offset);
+            uint32_t length = read_word(bytes, offset + 4);
+            EXPECT_EQ(0u, length % 4);
+            EXPECT_LE(offset + length, bytes.size());
+            EXPECT_EQ(length, read_word(bytes, offset + length - 4));
+
+            if(SHB_TYPE == type)
+            {
+                EXPECT_EQ(uint32_t(BYTE_ORDER_MAGIC), read_word(bytes, offset + 8));
+            }
+            else if(IDB_TYPE == type)
+            {
+                EXPECT_EQ(UXR_CAPTURE_LINKTYPE, read_word(bytes, offset + 8) & 0xFFFF);
+            }
+            else if(EPB_TYPE == type)
+            {
+                Packet packet;
+                packet.timestamp = int64_t((uint64_t(read_word(bytes, offset + 12)) << 32) | read_word(bytes, offset + 16));
+                uint32_t captured = read_word(bytes, offset + 20);
+                EXPECT_EQ(captured, read_word(bytes, offset + 24));
+                packet.data.assign(bytes.begin() + long(offset + 28), bytes.begin() + long(offset + 28 + captured));
+
+                size_t option = offset + 28 + ((captured + 3u) & ~3u);
+                EXPECT_EQ(uint32_t(OPTION_EPB_FLAGS | (sizeof(uint32_t) << 16)), read_word(bytes, option));
+                packet.flags = read_word(bytes, option + 4);
+                packets.push_back(packet);
+            }
+            offset += length;
+        }
+        EXPECT_EQ(bytes.size(), offset);
+
+        return packets;
+    }
+
+protected:
+    static uint32_t read_word(const std::vector<uint8_t>& bytes, size_t offset)
+    {
+        uint32_t word;
+        memcpy(&word, bytes.data() + offset, sizeof(word));
+        return word;
+    }
+
+    uxrSession session;
+    uxrMessageCapture capture_;
+    uint8_t ring[RING_SIZE];
+};
+
+TEST_F(MessageCaptureTest, RoundTrip)
+{
+    ASSERT_TRUE(uxr_start_message_capture(&capture_, &session, CAPTURE_PATH, ring, RING_SIZE));
+    ASSERT_TRUE(NULL != session.on_message);
+
+    /* Odd lengths, so the packets are padded, and more bytes than the ring, so the records wrap around. */
+    std::vector<std::vector<uint8_t>> messages;
+    int64_t start = uxr_nanos();
+    for(uint8_t i = 0; i < MESSAGES; ++i)
+    {
+        std::vector<uint8_t> message(size_t(13 + 2 * i));
+        for(size_t j = 0; j < message.size(); ++j)
+        {
+            message[j] = uint8_t(i + j);
+        }
+        capture(0 == i % 2, message);
+        messages.push_back(message);
+    }
+    int64_t end = uxr_nanos();
+
+    EXPECT_TRUE(uxr_stop_message_capture(&capture_, &session));
+    EXPECT_TRUE(NULL == session.on_message);
+    EXPECT_EQ(0u, capture_.dropped);
+    EXPECT_LT(size_t(RING_SIZE), capture_.head);
+
+    std::vector<Packet> packets = decode();
+    ASSERT_EQ(size_t(MESSAGES), packets.size());
+    for(size_t i = 0; i < packets.size(); ++i)
+    {
+        EXPECT_EQ(messages[i], packets[i].data);
+        if(0 == i % 2)
+        {
+            EXPECT_EQ(uint32_t(UXR_CAPTURE_OUTBOUND), packets[i].flags);
+            EXPECT_LE(start, packets[i].timestamp);
+            EXPECT_GE(end, packets[i].timestamp);
+        }
+        else
+        {
+            EXPECT_EQ(uint32_t(UXR_CAPTURE_INBOUND), packets[i].flags);
+            EXPECT_EQ(RECV_TIMESTAMP, packets[i].timestamp);
+        }
+    }
+}
+
+TEST_F(MessageCaptureTest, DropMessageLargerThanRing)
+{
+    ASSERT_TRUE(uxr_start_message_capture(&capture_, &session, CAPTURE_PATH, ring, RING_SIZE));
+
+    capture(true, std::vector<uint8_t>(RING_SIZE));
+    capture(true, std::vector<uint8_t>(8, 0xAA));
+
+    EXPECT_TRUE(uxr_stop_message_capture(&capture_, &session));
+    EXPECT_EQ(1u, capture_.dropped);
+
+    std::vector<Packet> packets = decode();
+    ASSERT_EQ(1u, packets.size());
+    EXPECT_EQ(std::vector<uint8_t>(8, 0xAA), packets[0].data);
+}
+
+TEST_F(MessageCaptureTest, RingNotPowerOfTwo)
+{
+    EXPECT_FALSE(uxr_start_message_capture(&capture_, &session, CAPTURE_PATH, ring, RING_SIZE - 1));
+    EXPECT_TRUE(NULL == session.on_message);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+#include <string>
+
+extern "C"
+{
+#include <c/core/session/flight_recorder.c>
+#include <c/util/time.c>
+}
+
+#define EVENTS UXR_CONFIG_FLIGHT_RECORDER_EVENTS
+
+class FlightRecorderTest : public testing::Test
+{
+public:
+    FlightRecorderTest()
+    {
+        uxr_init_flight_recorder(&recorder);
+        EXPECT_EQ(0u, recorder.count);
+    }
+
+protected:
+    uxrFlightRecorder recorder;
+};
+
+TEST_F(FlightRecorderTest, ReadEvents)
+{
+    uxr_record_flight_event(&recorder, UXR_EVENT_HEARTBEAT_SENT, 0x80, 1, 3, 2);
+    uxr_record_flight_event(&recorder, UXR_EVENT_ACKNACK_RECEIVED, 0x80, 2, 0x0001, 0);
+
+    uxrFlightEvent events[EVENTS];
+    ASSERT_EQ(2u, uxr_read_flight_events(&recorder, events, EVENTS));
+    EXPECT_EQ(UXR_EVENT_HEARTBEAT_SENT, events[0].type);
+    EXPECT_EQ(0x80, events[0].stream_id);
+    EXPECT_EQ(1u, events[0].seq_num);
+    EXPECT_EQ(3u, events[0].value);
+    EXPECT_EQ(2u, events[0].extra);
+    EXPECT_EQ(UXR_EVENT_ACKNACK_RECEIVED, events[1].type);
+    EXPECT_LE(events[0].timestamp, events[1].timestamp);
+
+    ASSERT_EQ(1u, uxr_read_flight_events(&recorder, events, 1));
+    EXPECT_EQ(UXR_EVENT_ACKNACK_RECEIVED, events[0].type);
+}
+
+TEST_F(FlightRecorderTest, OverwriteOldest)
+{
+    for(uint16_t i = 0; i < EVENTS + 3; ++i)
+    {
+        uxr_record_flight_event(&recorder, UXR_EVENT_PREPARE_FAILED, 0x80, i, 0, 0);
+    }
+
+    uxrFlightEvent events[EVENTS];
+    ASSERT_EQ(size_t(EVENTS), uxr_read_flight_events(&recorder, events, EVENTS));
+    for(uint16_t i = 0; i < EVENTS; ++i)
+    {
+        EXPECT_EQ(i + 3u, events[i].seq_num);
+    }
+}
+
+TEST_F(FlightRecorderTest, WriteEvents)
+{
+    uxr_record_flight_event(&recorder, UXR_EVENT_SEND_LOST, 0x81, 65535, 1, 0);
+    uxr_record_flight_event(&recorder, UXR_EVENT_FRAGMENTS_COMPLETED, 0x80, 12, 4, 0);
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_TRUE(uxr_write_flight_events(&recorder, fds[1]));
+    close(fds[1]);
+
+    char output[512];
+    ssize_t length = read(fds[0], output, sizeof(output));
+    close(fds[0]);
+    ASSERT_LT(0, length);
+
+    std::string text(output, size_t(length));
+    EXPECT_NE(std::string::npos, text.find(" SEND_LOST stream: 0x81 seq: 65535 value: 0x1 extra: 0\n"));
+    EXPECT_NE(std::string::npos, text.find(" FRAGMENTS_COMPLETED stream: 0x80 seq: 12 value: 0x4 extra: 0\n"));
+    EXPECT_LT(text.find("SEND_LOST"), text.find("FRAGMENTS_COMPLETED"));
+}
@@ -14,10 +14,14 @@ extern "C"
 #include <c/core/session/stream/output_best_effort_stream.c>
 #include <c/core/session/stream/input_reliable_stream.c>
 #include <c/core/session/stream/output_reliable_stream.c>
+#include <c/util/histogram.c>
+#include <c/util/token_bucket.c>
 
 #include <c/core/session/object_id.c>
 #include <c/core/session/submessage.c>
 #include <c/core/session/session_info.c>
+#include <c/core/session/time_sync.c>
+#include <c/core/session/flight_recorder.c>
 #include <c/core/session/read_access.c>
 #include <c/core/session/write_access.c>
 
@@ -32,6 +36,7 @@ extern "C"
 #include <string>
 #include <array>
 #include <vector>
+#include <algorithm>
 
 #define MTU                   64
 #define HISTORY               4
@@ -53,6 +58,7 @@ public:
         comm.send_msg = send_msg;
         comm.recv_msg = recv_msg;
         comm.comm_error = comm_error;
+        comm.msg_timestamps = NULL;
 
         uxr_init_session(&session, &comm, 0xAAAABBBB);
 
@@ -99,12 +105,19 @@ public:
     uint8_t output_reliable_buffer[MTU * HISTORY];
     uint8_t input_reliable_buffer[MTU * HISTORY];
 
+    std::vector<uint8_t> sent_streams;
+    std::vector<uint8_t> last_message;
+
     static int listening_counter;
 
     static bool send_msg(void* instance, const uint8_t* buf, size_t len)
     {
-        (void) buf;
         EXPECT_EQ(SessionTest::current, instance);
+        if(1 < len)
+        {
+            SessionTest::current->sent_streams.push_back(buf[1]);
+        }
+        SessionTest::current->last_message.assign(buf, buf + len);
         if(std::string("FlashStreams") == ::testing::UnitTest::GetInstance()->current_test_info()->name())
         {
             EXPECT_EQ(size_t(OFFSET + SUBHEADER_SIZE + 8), len);
@@ -118,13 +131,25 @@ public:
             EXPECT_EQ(size_t(MTU), len);
             return false;
         }
+        else if(std::string("StatsSendMessageError") == ::testing::UnitTest::GetInstance()->current_test_info()->name())
+        {
+            return false;
+        }
         else if(std::string("SendHeartbeat") == ::testing::UnitTest::GetInstance()->current_test_info()->name())
         {
-            EXPECT_EQ(size_t(HEARTBEAT_MAX_MSG_SIZE - (MAX_HEADER_SIZE - OFFSET)), len);
+            EXPECT_EQ(size_t(OFFSET + SUBHEADER_SIZE + HEARTBEAT_PAYLOAD_SIZE), len);
         }
         else if(std::string("SendAcknack") == ::testing::UnitTest::GetInstance()->current_test_info()->name())
         {
-            EXPECT_EQ(size_t(ACKNACK_MAX_MSG_SIZE - (MAX_HEADER_SIZE - OFFSET)), len);
+            EXPECT_EQ(size_t(OFFSET + SUBHEADER_SIZE + ACKNACK_PAYLOAD_SIZE), len);
+        }
+        else if(std::string("SendControlCoalesced") == ::testing::UnitTest::GetInstance()->current_test_info()->name())
+        {
+            EXPECT_EQ(size_t(OFFSET + CONTROL_SUBMESSAGE_SIZE + SUBHEADER_SIZE + ACKNACK_PAYLOAD_SIZE), len);
+        }
+        else if(std::string("PiggybackControl") == ::testing::UnitTest::GetInstance()->current_test_info()->name())
+        {
+            EXPECT_EQ(size_t(OFFSET + SUBHEADER_SIZE + 8 + SUBHEADER_SIZE + ACKNACK_PAYLOAD_SIZE), len);
         }
 
         return true;
@@ -190,6 +215,12 @@ public:
             SessionTest::listening_counter++;
             return false;
         }
+        else if(std::string("TimeSyncPeriodWithTimeCallback") == ::testing::UnitTest::GetInstance()->current_test_info()->name())
+        {
+            EXPECT_LE(0, timeout);
+            SessionTest::listening_counter++;
+            return false;
+        }
         else if(std::string("RecvMessageOk") == ::testing::UnitTest::GetInstance()->current_test_info()->name())
         {
             *len = 8;
@@ -199,6 +230,11 @@ public:
         {
             return false;
         }
+        else if(std::string("MessageCallback") == ::testing::UnitTest::GetInstance()->current_test_info()->name())
+        {
+            *len = 8;
+            return true;
+        }
         return false;
     }
 
@@ -240,6 +276,14 @@ public:
         (void) session; (void) current_timestamp; (void) transmit_timestamp; (void) received_timestamp;
         (void) originate_timestamp; (void) args;
     }
+
+    static void on_message_func (struct uxrSession* session, bool output, const uint8_t* buffer, size_t length,
+                                 void* args)
+    {
+        (void) session; (void) buffer;
+        size_t* counters = static_cast<size_t*>(args);
+        counters[output ? 0 : 1] += length;
+    }
 };
 
 SessionTest* SessionTest::current = nullptr;
@@ -269,6 +313,23 @@ TEST_F(SessionTest, SetTimeCallback)
     EXPECT_EQ(session.on_time_args, &user_data);
 }
 
+TEST_F(SessionTest, MessageCallback)
+{
+    size_t counters[2] = {0, 0};
+    uxr_set_message_callback(&session, on_message_func, counters);
+
+    uint8_t buffer[MTU];
+    uint8_t* input_buffer; size_t length;
+    (void) send_message(&session, buffer, MTU);
+    (void) recv_message(&session, &input_buffer, &length, 0);
+    EXPECT_EQ(size_t(MTU), counters[0]);
+    EXPECT_EQ(8u, counters[1]);
+
+    uxr_set_message_callback(&session, NULL, NULL);
+    (void) send_message(&session, buffer, MTU);
+    EXPECT_EQ(size_t(MTU), counters[0]);
+}
+
 TEST_F(SessionTest, CreateOk)
 {
     bool created = uxr_create_session(&session);
@@ -327,6 +388,161 @@ TEST_F(SessionTest, FlashStreams)
     uxr_flash_output_streams(&session);
 }
 
+TEST_F(SessionTest, FlashStreamsByPriority)
+{
+    ucdrBuffer ub;
+    uxrStreamId output_best_effort = uxr_stream_id(0, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
+    uxrStreamId output_reliable = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    ASSERT_TRUE(uxr_set_output_stream_priority(&session, output_best_effort, 1));
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_best_effort, 8, &ub, 1, 0);
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_reliable, 8, &ub, 1, 0);
+    uxr_flash_output_streams(&session);
+
+    std::vector<uint8_t> expected = {output_reliable.raw, output_best_effort.raw};
+    EXPECT_EQ(expected, sent_streams);
+}
+
+TEST_F(SessionTest, FlashStreamsByDeadline)
+{
+    ucdrBuffer ub;
+    uxrStreamId output_best_effort = uxr_stream_id(0, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
+    uxrStreamId output_reliable = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    ASSERT_TRUE(uxr_set_output_stream_priority(&session, output_reliable, 1));
+    for(int i = 0; i < 2; ++i)
+    {
+        (void) uxr_prepare_stream_to_write_submessage(&session, output_reliable, MTU, &ub, 1, 0);
+    }
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_best_effort, 8, &ub, 1, 0);
+    ASSERT_TRUE(uxr_set_output_stream_deadline(&session, output_reliable, uxr_millis() + 10));
+    ASSERT_TRUE(uxr_set_output_stream_deadline(&session, output_reliable, uxr_millis() + 1000));
+    uxr_flash_output_streams(&session);
+
+    ASSERT_LT(2u, sent_streams.size());
+    EXPECT_EQ(output_best_effort.raw, sent_streams.back());
+    EXPECT_EQ(sent_streams.size() - 1, size_t(std::count(sent_streams.begin(), sent_streams.end(), output_reliable.raw)));
+    EXPECT_EQ(INT64_MAX, session.streams.output_reliable[0].deadline);
+    EXPECT_FALSE(uxr_set_output_stream_deadline(&session, uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_INPUT_STREAM), 0));
+}
+
+TEST_F(SessionTest, FlashStreamsShaped)
+{
+    const size_t message_size = OFFSET + SUBHEADER_SIZE + 8;
+    uxrTokenBucket shaper;
+    uxr_init_token_bucket(&shaper, 1000, uint32_t(message_size));
+    uxr_set_session_shaper(&session, &shaper);
+
+    ucdrBuffer ub;
+    uxrStreamId output_best_effort = uxr_stream_id(0, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
+    uxrStreamId output_reliable = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_reliable, 8, &ub, 1, 0);
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_best_effort, 8, &ub, 1, 0);
+    uxr_flash_output_streams(&session);
+    EXPECT_EQ(1u, sent_streams.size());
+    EXPECT_NE(INT64_MAX, session.next_flash);
+
+    /* The session flashes the held back stream once the tokens are available. */
+    std::this_thread::sleep_for(std::chrono::milliseconds(session.next_flash - uxr_millis() + 1));
+    (void) uxr_run_session_until_timeout(&session, 0);
+    std::vector<uint8_t> expected = {output_best_effort.raw, output_reliable.raw};
+    EXPECT_EQ(expected, sent_streams);
+    EXPECT_EQ(INT64_MAX, session.next_flash);
+}
+
+TEST_F(SessionTest, FlashStreamShaped)
+{
+    uxrTokenBucket shaper;
+    uxr_init_token_bucket(&shaper, 1000, 1);
+    uxrStreamId output_best_effort = uxr_stream_id(0, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
+    uxrStreamId output_reliable = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    ASSERT_TRUE(uxr_set_output_stream_shaper(&session, output_best_effort, &shaper));
+
+    /* The other streams go on while one is held back. */
+    ucdrBuffer ub;
+    for(int i = 0; i < 2; ++i)
+    {
+        (void) uxr_prepare_stream_to_write_submessage(&session, output_best_effort, 8, &ub, 1, 0);
+        (void) uxr_prepare_stream_to_write_submessage(&session, output_reliable, 8, &ub, 1, 0);
+        uxr_flash_output_streams(&session);
+    }
+    std::vector<uint8_t> expected = {output_best_effort.raw, output_reliable.raw, output_reliable.raw};
+    EXPECT_EQ(expected, sent_streams);
+}
+
+#ifdef PROFILE_SESSION_STATS
+TEST_F(SessionTest, StatsFlashStreams)
+{
+    ucdrBuffer ub;
+    uxrStreamId output_best_effort = uxr_stream_id(0, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
+    uxrStreamId output_reliable = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_reliable, 8, &ub, 1, 0);
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_best_effort, 8, &ub, 1, 0);
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_best_effort, MTU, &ub, 1, 0);
+    uxr_flash_output_streams(&session);
+
+    uxrSessionStats stats;
+    uxr_get_session_stats(&session, &stats);
+    EXPECT_EQ(2u, stats.sent.messages);
+    EXPECT_EQ(2u * (OFFSET + SUBHEADER_SIZE + 8), stats.sent.bytes);
+    EXPECT_EQ(0u, stats.fragments_sent);
+    EXPECT_EQ(1u, stats.failed_prepares);
+
+    uxrStreamStats stream_stats;
+    ASSERT_TRUE(uxr_get_stream_stats(&session, output_best_effort, &stream_stats));
+    EXPECT_EQ(1u, stream_stats.messages);
+    ASSERT_TRUE(uxr_get_stream_stats(&session, output_reliable, &stream_stats));
+    EXPECT_EQ(1u, stream_stats.messages);
+    EXPECT_EQ(uint64_t(OFFSET + SUBHEADER_SIZE + 8), stream_stats.bytes);
+    EXPECT_FALSE(uxr_get_stream_stats(&session, uxr_stream_id(1, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM), &stream_stats));
+
+    uxr_reset_session_stats(&session);
+    uxr_get_session_stats(&session, &stats);
+    EXPECT_EQ(0u, stats.sent.messages);
+    EXPECT_EQ(0u, stats.failed_prepares);
+    ASSERT_TRUE(uxr_get_stream_stats(&session, output_reliable, &stream_stats));
+    EXPECT_EQ(0u, stream_stats.messages);
+}
+
+TEST_F(SessionTest, StatsSendMessageError)
+{
+    uint8_t buffer[MTU];
+    (void) send_message(&session, buffer, MTU);
+    session.streams.output_reliable[0].heartbeat_pending = true;
+    send_control_submessages(&session);
+
+    uxrSessionStats stats;
+    uxr_get_session_stats(&session, &stats);
+    EXPECT_EQ(2u, stats.send_errors);
+    EXPECT_EQ(0u, stats.sent.messages);
+    EXPECT_EQ(1u, stats.heartbeats_sent);
+}
+
+TEST_F(SessionTest, StatsRecvMessageWithoutCommError)
+{
+    comm.comm_error = NULL;
+    uint8_t* buffer; size_t length;
+    ASSERT_FALSE(recv_message(&session, &buffer, &length, 0));
+
+    uxrSessionStats stats;
+    uxr_get_session_stats(&session, &stats);
+    EXPECT_EQ(0u, stats.recv_errors);
+}
+#endif
+
+#ifdef PROFILE_FLIGHT_RECORDER
+TEST_F(SessionTest, FlightPrepareFailed)
+{
+    ucdrBuffer ub;
+    uxrStreamId output_reliable = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    EXPECT_FALSE(uxr_prepare_stream_to_write_submessage(&session, output_reliable, 2 * MTU * HISTORY, &ub, 1, 0));
+
+    uxrFlightEvent events[UXR_CONFIG_FLIGHT_RECORDER_EVENTS];
+    ASSERT_EQ(1u, uxr_get_flight_events(&session, events, UXR_CONFIG_FLIGHT_RECORDER_EVENTS));
+    EXPECT_EQ(UXR_EVENT_PREPARE_FAILED, events[0].type);
+    EXPECT_EQ(output_reliable.raw, events[0].stream_id);
+    EXPECT_EQ(size_t(SUBHEADER_SIZE + 2 * MTU * HISTORY), events[0].value);
+}
+#endif
+
 TEST_F(SessionTest, WaitSessionStatusBad)
 {
     // The OK version is already checked with the CreateOk and DeleteOk test versions
@@ -339,6 +555,16 @@ TEST_F(SessionTest, WaitSessionStatusBad)
     EXPECT_EQ(attempts, size_t(SessionTest::listening_counter));
 }
 
+TEST_F(SessionTest, TimeSyncPeriodWithTimeCallback)
+{
+    /* The time callback disables the background requests, so their schedule does not wake up the session. */
+    SessionTest::listening_counter = 0;
+    uxr_set_time_callback(&session, on_time_func, NULL);
+    uxr_set_time_sync_period(&session, 1);
+    (void) uxr_run_session_time(&session, 10);
+    EXPECT_EQ(1, SessionTest::listening_counter);
+}
+
 TEST_F(SessionTest, SendMessageOk)
 {
     uint8_t buffer[MTU];
@@ -370,14 +596,90 @@ TEST_F(SessionTest, RecvMessageError)
 
 TEST_F(SessionTest, SendHeartbeat)
 {
-    uxrStreamId output_reliable = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
-    write_submessage_heartbeat(&session, output_reliable);
+    session.streams.output_reliable[0].heartbeat_pending = true;
+    send_control_submessages(&session);
+    EXPECT_FALSE(session.streams.output_reliable[0].heartbeat_pending);
+    EXPECT_EQ(1u, sent_streams.size());
 }
 
 TEST_F(SessionTest, SendAcknack)
 {
-    uxrStreamId input_reliable = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_INPUT_STREAM);
-    write_submessage_acknack(&session, input_reliable);
+    session.streams.input_reliable[0].acknack_pending = true;
+    send_control_submessages(&session);
+    EXPECT_FALSE(session.streams.input_reliable[0].acknack_pending);
+    EXPECT_EQ(1u, sent_streams.size());
+}
+
+TEST_F(SessionTest, SendControlCoalesced)
+{
+    session.streams.output_reliable[0].heartbeat_pending = true;
+    session.streams.input_reliable[0].acknack_pending = true;
+    send_control_submessages(&session);
+    std::vector<uint8_t> expected = {0};
+    EXPECT_EQ(expected, sent_streams);
+}
+
+TEST_F(SessionTest, PiggybackControl)
+{
+    ucdrBuffer ub;
+    uxrStreamId output_best_effort = uxr_stream_id(0, UXR_BEST_EFFORT_STREAM, UXR_OUTPUT_STREAM);
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_best_effort, 8, &ub, 1, 0);
+    session.streams.input_reliable[0].acknack_pending = true;
+    uxr_flash_output_streams(&session);
+    send_control_submessages(&session);
+
+    std::vector<uint8_t> expected = {output_best_effort.raw};
+    EXPECT_EQ(expected, sent_streams);
+    EXPECT_FALSE(session.streams.input_reliable[0].acknack_pending);
+}
+
+TEST_F(SessionTest, NoPiggybackOnReliable)
+{
+    ucdrBuffer ub;
+    uxrStreamId output_reliable = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+    (void) uxr_prepare_stream_to_write_submessage(&session, output_reliable, 8, &ub, 1, 0);
+    session.streams.input_reliable[0].acknack_pending = true;
+    uxr_flash_output_streams(&session);
+    EXPECT_TRUE(session.streams.input_reliable[0].acknack_pending);
+    send_control_submessages(&session);
+
+    std::vector<uint8_t> expected = {output_reliable.raw, 0};
+    EXPECT_EQ(expected, sent_streams);
+}
+
+TEST_F(SessionTest, DurableRecovery)
+{
+    alignas(uint64_t) uint8_t memory[UXR_DURABLE_STREAM_OVERHEAD + MTU * HISTORY] = {0};
+    uxr_init_stream_storage(&session.streams);
+    uxrStreamId durable = uxr_create_output_durable_stream(&session, memory, sizeof(memory), HISTORY);
+    ASSERT_EQ(UXR_RELIABLE_STREAM, durable.type);
+
+    ucdrBuffer ub;
+    for(int i = 0; i < 2; ++i)
+    {
+        (void) uxr_prepare_stream_to_write_submessage(&session, durable, 8, &ub, 1, 0);
+        uxr_flash_output_streams(&session);
+    }
+    uxr_process_acknack(&session.streams.output_reliable[0], 0, 1);
+
+    /* After the restart, the message 1 is pending as the message 0 of the new session. */
+    uxr_init_stream_storage(&session.streams);
+    durable = uxr_create_output_durable_stream(&session, memory, sizeof(memory), HISTORY);
+    ASSERT_EQ(UXR_RELIABLE_STREAM, durable.type);
+
+    uint8_t acknack_buffer[SUBHEADER_SIZE + ACKNACK_PAYLOAD_SIZE];
+    ucdr_init_buffer(&ub, acknack_buffer, sizeof(acknack_buffer));
+    ACKNACK_Payload acknack = {0, {0x00, 0x01}, durable.raw};
+    (void) uxr_serialize_ACKNACK_Payload(&ub, &acknack);
+    ucdr_init_buffer(&ub, acknack_buffer, sizeof(acknack_buffer));
+    read_submessage_acknack(&session, &ub, uxr_stream_id_from_raw(0, UXR_INPUT_STREAM), ACKNACK_PAYLOAD_SIZE, 0);
+
+    ASSERT_FALSE(last_message.empty());
+    ucdr_init_buffer(&ub, last_message.data(), uint32_t(last_message.size()));
+    uint8_t stream_id_raw = 0; uxrSeqNum seq_num = SEQ_NUM_MAX;
+    ASSERT_TRUE(uxr_read_session_header(&session.info, &ub, &stream_id_raw, &seq_num));
+    EXPECT_EQ(durable.raw, stream_id_raw);
+    EXPECT_EQ(0u, seq_num);
 }
 
 TEST_F(SessionTest, ProcessStatus)
@@ -472,6 +774,65 @@ TEST_F(SessionTest, ReadUint64)
     read_message(&session, &ub);
 }
 
+TEST_F(SessionTest, ReadStatusAfterUnknownSubmessage)
+{
+    size_t status_count = 0;
+    uxr_set_status_callback(&session, [](uxrSession*, uxrObjectId object_id, uint16_t request_id, uint8_t status, void* args)
+    {
+        EXPECT_EQ(2, object_id.id);
+        EXPECT_EQ(2, object_id.type);
+        EXPECT_EQ(4, request_id);
+        EXPECT_EQ(UXR_STATUS_OK, status);
+        (*static_cast<size_t*>(args))++;
+    }, &status_count);
+
+    std::array<uint8_t, MTU> buffer;
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, buffer.data(), buffer.size());
+    uxr_serialize_message_header(&ub, session.info.id, BEST_EFFORT_STREAM_THRESHOLD, 0x00, session.info.key);
+
+    /* Not read by the Client, and of an unaligned length: skipped up to the next subheader. */
+    const uint8_t info[3] = {0x01, 0x02, 0x03};
+    uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_INFO, sizeof(info), 0);
+    ucdr_serialize_array_uint8_t(&ub, info, sizeof(info));
+
+    STATUS_Payload payload{};
+    payload.base.related_request.request_id.data[1] = 4;
+    uxr_object_id_to_raw(uxr_object_id(2, 2), payload.base.related_request.object_id.data);
+    payload.base.result.status = UXR_STATUS_OK;
+    uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_STATUS, 6, 0);
+    uxr_serialize_STATUS_Payload(&ub, &payload);
+
+    ucdr_init_buffer(&ub, buffer.data(), uint32_t(ub.iterator - ub.init));
+    read_message(&session, &ub);
+    EXPECT_EQ(1u, status_count);
+}
+
+TEST_F(SessionTest, ReadTruncatedStatus)
+{
+    size_t status_count = 0;
+    uxr_set_status_callback(&session, [](uxrSession*, uxrObjectId, uint16_t, uint8_t, void* args)
+    {
+        (*static_cast<size_t*>(args))++;
+    }, &status_count);
+
+    std::array<uint8_t, MTU> buffer;
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, buffer.data(), buffer.size());
+    uxr_serialize_message_header(&ub, session.info.id, BEST_EFFORT_STREAM_THRESHOLD, 0x00, session.info.key);
+
+    /* The truncated payload looks like a further submessage, which must not be read. */
+    uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_STATUS, 6, 0);
+    uint8_t* payload = ub.iterator;
+    uxr_buffer_submessage_header(&ub, SUBMESSAGE_ID_HEARTBEAT, 0, 0);
+
+    ucdr_init_buffer(&ub, buffer.data(), uint32_t(ub.iterator - ub.init));
+    read_message(&session, &ub);
+    EXPECT_EQ(0u, status_count);
+    EXPECT_TRUE(ub.error);
+    EXPECT_EQ(payload, ub.iterator);
+}
+
 TEST_F(SessionTest, WriteUint64)
 {
     ucdrBuffer written_ub;
@@ -128,3 +128,24 @@ TEST(SessionInfoTest, WriteReadSessionHeaderWithoutKey)
     EXPECT_EQ(seq_num, read_seq_num);
     EXPECT_EQ(size_t(MIN_HEADER_SIZE), ucdr_buffer_length(&ub));
 }
+
+TEST(SessionInfoTest, StampSessionHeaderAsSerialized)
+{
+    const uint8_t ids[] = {0x01, 0x81};
+    for(uint8_t id : ids)
+    {
+        uxrSessionInfo info;
+        uxr_init_session_info(&info, id, 0xAABBCCDD);
+
+        uint8_t stamped[MAX_HEADER_SIZE] = {0};
+        uxr_stamp_session_header(&info, 0x80, 0x1234, stamped);
+
+        uint8_t serialized[MAX_HEADER_SIZE] = {0};
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, serialized, MAX_HEADER_SIZE);
+        uxr_serialize_message_header(&ub, id, 0x80, 0x1234, info.key);
+
+        EXPECT_EQ(ucdr_buffer_length(&ub), uxr_session_header_offset(&info));
+        EXPECT_EQ(0, memcmp(serialized, stamped, MAX_HEADER_SIZE));
+    }
+}
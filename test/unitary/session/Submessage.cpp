@@ -52,6 +52,13 @@ TEST_F(SubmessageTest, WriteReadHeaderNoFits)
     write_and_read(SUBMESSAGE_ID_CREATE, PAYLOAD_SIZE, FLAG_LAST_FRAGMENT, false);
 }
 
+TEST_F(SubmessageTest, WriteReadHeaderLittleEndianLength)
+{
+    write_and_read(SUBMESSAGE_ID_WRITE_DATA, 0x1234, 0, false);
+    EXPECT_EQ(0x34, buffer[2]);
+    EXPECT_EQ(0x12, buffer[3]);
+}
+
 TEST(SubmessageTest_, PaddingHeader)
 {
     EXPECT_EQ(size_t(0), uxr_submessage_padding(4));
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+extern "C"
+{
+#include <c/core/session/time_sync.c>
+}
+
+#define SAMPLES     UXR_CONFIG_TIME_SYNC_SAMPLES
+#define PERIOD      int64_t(1000)
+
+class TimeSyncTest : public testing::Test
+{
+public:
+    TimeSyncTest()
+    {
+        uxr_init_time_sync(&sync);
+        EXPECT_FALSE(sync.active);
+        EXPECT_EQ(0u, sync.point_count);
+        EXPECT_EQ(0.0, sync.skew);
+        EXPECT_EQ(INT64_MAX, sync.next_request);
+    }
+
+    /* Adds an exchange with a remote clock behind the local one by `offset` and a symmetric delay. */
+    bool add_sample(int64_t nanos, int64_t offset, int64_t delay, int64_t asymmetry = 0)
+    {
+        int64_t t0 = nanos;
+        int64_t t1 = t0 + delay / 2 + asymmetry - offset;
+        int64_t t2 = t1;
+        int64_t t3 = t0 + delay;
+        return uxr_add_time_sync_sample(&sync, t0, t1, t2, t3, t3 / 1000000);
+    }
+
+protected:
+    uxrTimeSync sync;
+};
+
+TEST_F(TimeSyncTest, RequestScheduling)
+{
+    EXPECT_FALSE(uxr_update_time_sync_request(&sync, 0));
+
+    uxr_start_time_sync(&sync, 10);
+    EXPECT_TRUE(uxr_update_time_sync_request(&sync, 10));
+    EXPECT_FALSE(uxr_update_time_sync_request(&sync, 11));
+    EXPECT_TRUE(uxr_update_time_sync_request(&sync, 10 + REQUEST_TIMEOUT));
+
+    (void) add_sample(11000000, 0, 1000);
+    EXPECT_TRUE(uxr_update_time_sync_request(&sync, 11));
+}
+
+TEST_F(TimeSyncTest, PeriodicRequests)
+{
+    uxr_schedule_time_sync(&sync, PERIOD, 0);
+    EXPECT_FALSE(uxr_update_time_sync_request(&sync, PERIOD - 1));
+    EXPECT_TRUE(uxr_update_time_sync_request(&sync, PERIOD));
+    EXPECT_TRUE(sync.active);
+
+    for(size_t i = 0; i < SAMPLES - 1; ++i)
+    {
+        EXPECT_FALSE(add_sample(PERIOD * 1000000, 0, 1000));
+    }
+    EXPECT_TRUE(add_sample(PERIOD * 1000000, 0, 1000));
+    EXPECT_FALSE(sync.active);
+    EXPECT_EQ(2 * PERIOD, sync.next_request);
+}
+
+TEST_F(TimeSyncTest, LostReplies)
+{
+    uxr_schedule_time_sync(&sync, PERIOD, 0);
+    int64_t timestamp = PERIOD;
+    for(size_t i = 0; i < MAX_REQUESTS; ++i)
+    {
+        EXPECT_TRUE(uxr_update_time_sync_request(&sync, timestamp));
+        timestamp += REQUEST_TIMEOUT;
+    }
+    EXPECT_FALSE(uxr_update_time_sync_request(&sync, timestamp));
+    EXPECT_FALSE(sync.active);
+    EXPECT_EQ(timestamp + PERIOD, sync.next_request);
+}
+
+TEST_F(TimeSyncTest, MinimumDelayFilter)
+{
+    const int64_t offset = 5000000;
+    uxr_start_time_sync(&sync, 0);
+    for(size_t i = 0; i < SAMPLES; ++i)
+    {
+        /* Only the first samples are not delayed asymmetrically. */
+        int64_t delay = (i < (SAMPLES + 3) / 4) ? 100000 : 2000000;
+        int64_t asymmetry = (i < (SAMPLES + 3) / 4) ? 0 : 700000;
+        (void) add_sample(int64_t(i) * 10000000, offset, delay, asymmetry);
+    }
+
+    EXPECT_EQ(1u, sync.point_count);
+    EXPECT_EQ(offset, sync.offset);
+    EXPECT_EQ(0.0, sync.skew);
+}
+
+TEST_F(TimeSyncTest, SkewEstimation)
+{
+    const int64_t interval = 5000000000;
+    const double skew = 0.00005;
+    for(int64_t burst = 0; burst < 4; ++burst)
+    {
+        uxr_start_time_sync(&sync, 0);
+        for(size_t i = 0; i < SAMPLES; ++i)
+        {
+            int64_t nanos = burst * interval;
+            (void) add_sample(nanos, int64_t(skew * double(nanos)), 100000);
+        }
+    }
+
+    EXPECT_EQ(4u, sync.point_count);
+    EXPECT_NEAR(skew, sync.skew, 0.000001);
+
+    int64_t future = 5 * interval;
+    EXPECT_NEAR(skew * double(future), double(uxr_time_sync_offset(&sync, sync.offset, future)), 1000.0);
+}
+
+TEST_F(TimeSyncTest, SkewOfClosePoints)
+{
+    /* Two bursts 10 ms apart, with 1 ms of offset noise, tell nothing about the skew. */
+    const int64_t offsets[2] = {5000000, 6000000};
+    for(int64_t burst = 0; burst < 2; ++burst)
+    {
+        uxr_start_time_sync(&sync, 0);
+        for(size_t i = 0; i < SAMPLES; ++i)
+        {
+            (void) add_sample(burst * 10000000, offsets[burst], 100000);
+        }
+    }
+
+    EXPECT_EQ(2u, sync.point_count);
+    EXPECT_EQ(0.0, sync.skew);
+    EXPECT_EQ(5500000, sync.offset);
+}
+
+TEST_F(TimeSyncTest, SkewBounded)
+{
+    /* 10 ms of offset change along 20 s, far beyond the tolerance of a clock crystal. */
+    const int64_t interval = 10000000000;
+    for(int64_t burst = 0; burst < 3; ++burst)
+    {
+        uxr_start_time_sync(&sync, 0);
+        for(size_t i = 0; i < SAMPLES; ++i)
+        {
+            (void) add_sample(burst * interval, burst * 5000000, 100000);
+        }
+    }
+
+    EXPECT_EQ(3u, sync.point_count);
+    EXPECT_EQ(MAX_SKEW, sync.skew);
+}
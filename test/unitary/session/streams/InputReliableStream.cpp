@@ -1,5 +1,6 @@
 
 #include <gtest/gtest.h>
+#include <vector>
 
 extern "C"
 {
@@ -19,6 +20,9 @@ bool operator == (const uxrInputReliableStream& stream1, const uxrInputReliableS
         && stream1.history == stream2.history
         && stream1.last_handled == stream2.last_handled
         && stream1.last_announced == stream2.last_announced
+        && stream1.last_contiguous == stream2.last_contiguous
+        && stream1.last_fragment_found == stream2.last_fragment_found
+        && 0 == memcmp(stream1.received, stream2.received, sizeof(stream1.received))
         && stream1.on_get_fragmentation_info == stream2.on_get_fragmentation_info;
 }
 
@@ -54,6 +58,9 @@ public:
 
         dest->last_handled = source->last_handled;
         dest->last_announced = source->last_announced;
+        dest->last_contiguous = source->last_contiguous;
+        dest->last_fragment_found = source->last_fragment_found;
+        memcpy(dest->received, source->received, sizeof(dest->received));
 
         dest->on_get_fragmentation_info = source->on_get_fragmentation_info;
     }
@@ -158,6 +165,81 @@ TEST_F(InputReliableStreamTest, GetFirstUnacked)
     EXPECT_EQ(uxr_seq_num_add(stream.last_handled, 1), first_unknown);
 }
 
+TEST_F(InputReliableStreamTest, GetFirstUnackedAfterGap)
+{
+    bool message_stored;
+    (void) uxr_receive_reliable_message(&stream, 1, message, MAX_MESSAGE_SIZE, &message_stored);
+    (void) uxr_receive_reliable_message(&stream, 2, message, MAX_MESSAGE_SIZE, &message_stored);
+    EXPECT_EQ(0, uxr_get_first_unacked(&stream));
+
+    (void) uxr_receive_reliable_message(&stream, 0, message, MAX_MESSAGE_SIZE, &message_stored);
+    EXPECT_EQ(3, uxr_get_first_unacked(&stream));
+}
+
+TEST_F(InputReliableStreamTest, ComputeAcknack)
+{
+    bool message_stored;
+    (void) uxr_receive_reliable_message(&stream, 1, message, MAX_MESSAGE_SIZE, &message_stored);
+    (void) uxr_receive_reliable_message(&stream, 3, message, MAX_MESSAGE_SIZE, &message_stored);
+
+    uxrSeqNum from;
+    uint16_t nack_bitmap = uxr_compute_acknack(&stream, &from);
+    EXPECT_EQ(0, from);
+    EXPECT_EQ(0x0005, nack_bitmap);
+}
+
+TEST_F(InputReliableStreamTest, AcknackEveryMessage)
+{
+    bool message_stored;
+    (void) uxr_receive_reliable_message(&stream, 0, message, MAX_MESSAGE_SIZE, &message_stored);
+    EXPECT_TRUE(uxr_register_input_reliable_message(&stream, false, 0));
+}
+
+TEST_F(InputReliableStreamTest, AcknackDelayedByMessages)
+{
+    uxr_set_input_reliable_stream_acknack_delay(&stream, 3, 100);
+
+    bool message_stored;
+    for(uxrSeqNum seq_num = 0; seq_num < 2; ++seq_num)
+    {
+        (void) uxr_receive_reliable_message(&stream, seq_num, message, MAX_MESSAGE_SIZE, &message_stored);
+        EXPECT_FALSE(uxr_register_input_reliable_message(&stream, false, seq_num));
+    }
+    EXPECT_EQ(100, stream.next_acknack_timestamp);
+
+    (void) uxr_receive_reliable_message(&stream, 2, message, MAX_MESSAGE_SIZE, &message_stored);
+    EXPECT_TRUE(uxr_register_input_reliable_message(&stream, false, 2));
+
+    uxr_reset_input_stream_acknack(&stream);
+    EXPECT_EQ(0, stream.unacked_messages);
+    EXPECT_EQ(INT64_MAX, stream.next_acknack_timestamp);
+}
+
+TEST_F(InputReliableStreamTest, AcknackDelayedByTime)
+{
+    uxr_set_input_reliable_stream_acknack_delay(&stream, 8, 10);
+
+    bool message_stored;
+    (void) uxr_receive_reliable_message(&stream, 0, message, MAX_MESSAGE_SIZE, &message_stored);
+    EXPECT_FALSE(uxr_register_input_reliable_message(&stream, false, 0));
+    EXPECT_FALSE(uxr_is_input_acknack_due(&stream, 9));
+    EXPECT_TRUE(uxr_is_input_acknack_due(&stream, 10));
+}
+
+TEST_F(InputReliableStreamTest, AcknackAtOnceOnGap)
+{
+    uxr_set_input_reliable_stream_acknack_delay(&stream, 8, 100);
+
+    bool message_stored;
+    (void) uxr_receive_reliable_message(&stream, 1, message, MAX_MESSAGE_SIZE, &message_stored);
+    EXPECT_TRUE(uxr_register_input_reliable_message(&stream, false, 0));
+
+    uxr_reset_input_stream_acknack(&stream);
+    (void) uxr_receive_reliable_message(&stream, 0, message, MAX_MESSAGE_SIZE, &message_stored);
+    EXPECT_FALSE(uxr_register_input_reliable_message(&stream, false, 0));
+    EXPECT_TRUE(uxr_register_input_reliable_message(&stream, true, 0));
+}
+
 TEST_F(InputReliableStreamTest, ProcessNewHeartbeat)
 {
     uxrSeqNum last_seq_num = HISTORY * 2;
@@ -273,3 +355,167 @@ TEST_F(InputReliableStreamTest, FragmentationJumpToNextBufferLastPosition)
     EXPECT_EQ(slot_0 + size / 2, ub.final);
     EXPECT_EQ(size_t(0), uxr_get_reliable_buffer_length(slot_0));
 }
+
+TEST(InputReliableStreamWideTest, ReceivedSlotsAcrossWords)
+{
+    const uint16_t history = 64;
+    std::vector<uint8_t> buffer(history * 16);
+    uint8_t message[8] = {0};
+    uxrInputReliableStream stream;
+    uxr_init_input_reliable_stream(&stream, buffer.data(), buffer.size(), history,
+                                   [](uint8_t*) { return NO_FRAGMENTED; });
+
+    /* The received slots run from the first bitmap word into the second. */
+    bool message_stored;
+    for(uxrSeqNum seq_num = 1; seq_num < 36; ++seq_num)
+    {
+        (void) uxr_receive_reliable_message(&stream, seq_num, message, sizeof(message), &message_stored);
+    }
+    (void) uxr_receive_reliable_message(&stream, 37, message, sizeof(message), &message_stored);
+    (void) uxr_receive_reliable_message(&stream, 0, message, sizeof(message), &message_stored);
+    EXPECT_EQ(36, uxr_get_first_unacked(&stream));
+
+    uxrSeqNum from;
+    EXPECT_EQ(0x0001, uxr_compute_acknack(&stream, &from));
+    EXPECT_EQ(36, from);
+}
+
+TEST(InputReliableStreamWideTest, HistoryBoundedByBitmap)
+{
+    std::vector<uint8_t> buffer((UXR_CONFIG_MAX_INPUT_RELIABLE_HISTORY * 2) * 16);
+    uxrInputReliableStream stream;
+    EXPECT_FALSE(uxr_init_input_reliable_stream(&stream, buffer.data(), buffer.size(), UXR_CONFIG_MAX_INPUT_RELIABLE_HISTORY * 2,
+                                                [](uint8_t*) { return NO_FRAGMENTED; }));
+    EXPECT_TRUE(uxr_init_input_reliable_stream(&stream, buffer.data(), buffer.size(), UXR_CONFIG_MAX_INPUT_RELIABLE_HISTORY,
+                                               [](uint8_t*) { return NO_FRAGMENTED; }));
+    EXPECT_EQ(UXR_CONFIG_MAX_INPUT_RELIABLE_HISTORY, stream.history);
+}
+
+TEST(InputReliableStreamFragmentsTest, ReassemblyOutOfOrder)
+{
+    /* The first byte of every message stands for its fragmentation info, and the parses are counted. */
+    static size_t parses;
+    parses = 0;
+    const uint16_t history = 16;
+    std::vector<uint8_t> buffer(history * 16);
+    uxrInputReliableStream stream;
+    uxr_init_input_reliable_stream(&stream, buffer.data(), buffer.size(), history,
+                                   [](uint8_t* message) { ++parses; return FragmentationInfo(message[0]); });
+
+    /* Two samples: fragments 0 to 4 and 5 to 7. */
+    const uxrSeqNum arrivals[] = {7, 2, 1, 4, 3, 6, 5, 0};
+    bool ready_to_read = false;
+    for(uxrSeqNum seq_num : arrivals)
+    {
+        uint8_t message[8] = {uint8_t((4 == seq_num || 7 == seq_num) ? LAST_FRAGMENT : INTERMEDIATE_FRAGMENT)};
+        bool message_stored;
+        ready_to_read = uxr_receive_reliable_message(&stream, seq_num, message, sizeof(message), &message_stored);
+        ASSERT_TRUE(message_stored);
+        ASSERT_EQ(0 == seq_num, ready_to_read);
+    }
+
+    ucdrBuffer ub;
+    ASSERT_TRUE(uxr_next_input_reliable_buffer_available(&stream, &ub, 0));
+    EXPECT_EQ(4, stream.last_handled);
+    ASSERT_TRUE(uxr_next_input_reliable_buffer_available(&stream, &ub, 0));
+    EXPECT_EQ(7, stream.last_handled);
+    ASSERT_FALSE(uxr_next_input_reliable_buffer_available(&stream, &ub, 0));
+
+    /* One parse per arrival, one per fragment while reassembling and one per sample read. */
+    EXPECT_GE(size_t(8 + 8 + 2), parses);
+
+    /* The fragments are released with their sample, even though it was not read. */
+    uint8_t message[8] = {uint8_t(INTERMEDIATE_FRAGMENT)};
+    bool message_stored;
+    (void) uxr_receive_reliable_message(&stream, uxrSeqNum(history + 1), message, sizeof(message), &message_stored);
+    EXPECT_TRUE(message_stored);
+}
+
+class InputReliableStreamReassemblyTest : public testing::Test
+{
+public:
+    InputReliableStreamReassemblyTest()
+        : buffer_(HISTORY * 32)
+    {
+        uxr_init_input_reliable_stream(&stream, buffer_.data(), buffer_.size(), HISTORY,
+                                       [](uint8_t* message) { return FragmentationInfo(message[0]); });
+        uxr_set_input_reliable_stream_reassembly(&stream, reassembly, sizeof(reassembly), FRAGMENT_OFFSET);
+    }
+
+    /* Fragments of FRAGMENT_OFFSET bytes of header, the first one standing for the fragmentation info,
+     * and a payload of its seq_num repeated. */
+    bool receive(uxrSeqNum seq_num, bool last, bool* message_stored)
+    {
+        uint8_t message[FRAGMENT_OFFSET + 4];
+        memset(message, uint8_t(seq_num), sizeof(message));
+        message[0] = uint8_t(last ? LAST_FRAGMENT : INTERMEDIATE_FRAGMENT);
+        return uxr_receive_reliable_message(&stream, seq_num, message, sizeof(message), message_stored);
+    }
+
+protected:
+    uxrInputReliableStream stream;
+    std::vector<uint8_t> buffer_;
+    uint8_t reassembly[64];
+};
+
+TEST_F(InputReliableStreamReassemblyTest, SampleLargerThanHistory)
+{
+    /* A sample of 3 times the history, each fragment released as it arrives. */
+    const uxrSeqNum fragments = uxrSeqNum(HISTORY * 3);
+    bool message_stored;
+    for(uxrSeqNum seq_num = 0; seq_num < fragments; ++seq_num)
+    {
+        ASSERT_EQ(seq_num + 1 == fragments, receive(seq_num, seq_num + 1 == fragments, &message_stored));
+        ASSERT_TRUE(message_stored);
+        ASSERT_EQ(seq_num, stream.last_handled);
+    }
+
+    ucdrBuffer ub;
+    ASSERT_TRUE(uxr_next_input_reliable_buffer_available(&stream, &ub, FRAGMENT_OFFSET));
+    ASSERT_EQ(reassembly, ub.init);
+    ASSERT_EQ(size_t(fragments * 4), size_t(ub.final - ub.init));
+    for(size_t i = 0; i < size_t(fragments * 4); ++i)
+    {
+        ASSERT_EQ(uint8_t(i / 4), ub.init[i]);
+    }
+    ASSERT_FALSE(uxr_next_input_reliable_buffer_available(&stream, &ub, FRAGMENT_OFFSET));
+}
+
+TEST_F(InputReliableStreamReassemblyTest, OutOfOrderFragments)
+{
+    bool message_stored;
+    ASSERT_FALSE(receive(2, true, &message_stored));
+    ASSERT_FALSE(receive(1, false, &message_stored));
+    EXPECT_EQ(SEQ_NUM_MAX, stream.last_handled);
+
+    ASSERT_TRUE(receive(0, false, &message_stored));
+    EXPECT_EQ(2, stream.last_handled);
+
+    ucdrBuffer ub;
+    ASSERT_TRUE(uxr_next_input_reliable_buffer_available(&stream, &ub, FRAGMENT_OFFSET));
+    EXPECT_EQ(size_t(12), size_t(ub.final - ub.init));
+    EXPECT_EQ(0, ub.init[0]);
+    EXPECT_EQ(1, ub.init[4]);
+    EXPECT_EQ(2, ub.init[8]);
+
+    uxrSeqNum from;
+    EXPECT_EQ(0, uxr_compute_acknack(&stream, &from));
+    EXPECT_EQ(3, from);
+}
+
+TEST_F(InputReliableStreamReassemblyTest, SampleLargerThanBuffer)
+{
+    /* Dropped whole, the next sample is received. */
+    const uxrSeqNum fragments = uxrSeqNum(sizeof(reassembly) / 4 + 1);
+    bool message_stored;
+    for(uxrSeqNum seq_num = 0; seq_num < fragments; ++seq_num)
+    {
+        ASSERT_FALSE(receive(seq_num, seq_num + 1 == fragments, &message_stored));
+    }
+    ASSERT_TRUE(receive(fragments, true, &message_stored));
+
+    ucdrBuffer ub;
+    ASSERT_TRUE(uxr_next_input_reliable_buffer_available(&stream, &ub, FRAGMENT_OFFSET));
+    EXPECT_EQ(size_t(4), size_t(ub.final - ub.init));
+    EXPECT_EQ(uint8_t(fragments), ub.init[0]);
+}
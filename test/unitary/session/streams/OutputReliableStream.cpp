@@ -1,10 +1,13 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 extern "C"
 {
 #include <c/core/session/stream/seq_num.c>
 #include <c/core/session/stream/output_reliable_stream.c>
+#include <c/util/histogram.c>
 }
 
 #define BUFFER_SIZE           size_t(128)
@@ -27,7 +30,20 @@ bool operator == (const uxrOutputReliableStream& stream1, const uxrOutputReliabl
         && stream1.next_heartbeat_timestamp == stream2.next_heartbeat_timestamp
         && stream1.next_heartbeat_tries == stream2.next_heartbeat_tries
         && stream1.send_lost == stream2.send_lost
-        && stream1.on_new_fragment == stream2.on_new_fragment;
+        && stream1.congestion_control == stream2.congestion_control
+        && stream1.cwnd == stream2.cwnd
+        && stream1.ssthresh == stream2.ssthresh
+        && stream1.cwnd_acked == stream2.cwnd_acked
+        && stream1.recovery_seq_num == stream2.recovery_seq_num
+        && stream1.on_new_fragment == stream2.on_new_fragment
+        && stream1.fragmented_remaining == stream2.fragmented_remaining
+        && stream1.fragmented_offset == stream2.fragmented_offset
+        && stream1.on_full_history == stream2.on_full_history
+        && stream1.on_full_history_args == stream2.on_full_history_args
+        && stream1.packed == stream2.packed
+        && stream1.max_message_size == stream2.max_message_size
+        && stream1.durable == stream2.durable
+        && stream1.latency == stream2.latency;
 }
 
 bool operator != (const uxrOutputReliableStream& stream1, const uxrOutputReliableStream& stream2)
@@ -73,8 +89,21 @@ public:
         dest->next_heartbeat_timestamp = source->next_heartbeat_timestamp;
         dest->next_heartbeat_tries = source->next_heartbeat_tries;
         dest->send_lost = source->send_lost;
+        dest->congestion_control = source->congestion_control;
+        dest->cwnd = source->cwnd;
+        dest->ssthresh = source->ssthresh;
+        dest->cwnd_acked = source->cwnd_acked;
+        dest->recovery_seq_num = source->recovery_seq_num;
 
         dest->on_new_fragment = source->on_new_fragment;
+        dest->fragmented_remaining = source->fragmented_remaining;
+        dest->fragmented_offset = source->fragmented_offset;
+        dest->on_full_history = source->on_full_history;
+        dest->on_full_history_args = source->on_full_history_args;
+        dest->packed = source->packed;
+        dest->max_message_size = source->max_message_size;
+        dest->durable = source->durable;
+        dest->latency = source->latency;
     }
 
     virtual ~OutputReliableStreamTest()
@@ -401,6 +430,28 @@ TEST_F(OutputReliableStreamTest, AcknackProcessLost)
     EXPECT_EQ(message_length, uxr_get_reliable_buffer_length(slot_0));
 }
 
+TEST_F(OutputReliableStreamTest, AcknackProcessStale)
+{
+    uint8_t* slot_1 = uxr_get_output_buffer(&stream, 1);
+    ucdrBuffer ub;
+    uint8_t* message; size_t length; uxrSeqNum seq_num;
+    for(int i = 0; i < 2; ++i)
+    {
+        (void) uxr_prepare_reliable_buffer_to_write(&stream, MAX_SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub);
+        (void) uxr_prepare_next_reliable_buffer_to_send(&stream, &message, &length, &seq_num);
+    }
+    size_t message_length = uxr_get_reliable_buffer_length(slot_1);
+
+    uxr_process_acknack(&stream, 0, uxrSeqNum(1));
+    ASSERT_EQ(0u, stream.last_acknown);
+
+    /* An ACKNACK older than the last one received leaves the stream as it is. */
+    uxr_process_acknack(&stream, 1, uxrSeqNum(0));
+    EXPECT_FALSE(stream.send_lost);
+    EXPECT_EQ(0u, stream.last_acknown);
+    EXPECT_EQ(message_length, uxr_get_reliable_buffer_length(slot_1));
+}
+
 TEST_F(OutputReliableStreamTest, SendMessageLostNoLost)
 {
     uint8_t* lost_message; size_t lost_length; uxrSeqNum lost_seq_num_it;
@@ -431,6 +482,77 @@ TEST_F(OutputReliableStreamTest, SendMessageLost)
     ASSERT_FALSE(must_send);
 }
 
+/* Writes and sends one message per slot, returns the number of them sent. */
+static size_t write_and_send(uxrOutputReliableStream* stream, size_t messages)
+{
+    ucdrBuffer ub;
+    for(size_t i = 0; i < messages; ++i)
+    {
+        (void) uxr_prepare_reliable_buffer_to_write(stream, MAX_SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub);
+    }
+    size_t sent = 0;
+    uint8_t* message; size_t length; uxrSeqNum seq_num;
+    while(uxr_prepare_next_reliable_buffer_to_send(stream, &message, &length, &seq_num))
+    {
+        ++sent;
+    }
+    return sent;
+}
+
+TEST_F(OutputReliableStreamTest, CongestionWindowSlowStart)
+{
+    uxr_set_output_reliable_stream_congestion_control(&stream, true);
+    EXPECT_EQ(2u, stream.cwnd);
+
+    EXPECT_EQ(2u, write_and_send(&stream, HISTORY));
+    uxr_process_acknack(&stream, 0, uxrSeqNum(2));
+    EXPECT_EQ(HISTORY, stream.cwnd);
+    EXPECT_EQ(2u, write_and_send(&stream, 0));
+}
+
+TEST_F(OutputReliableStreamTest, CongestionWindowLoss)
+{
+    uxr_set_output_reliable_stream_congestion_control(&stream, true);
+    stream.cwnd = uint16_t(HISTORY);
+    EXPECT_EQ(HISTORY, write_and_send(&stream, HISTORY));
+
+    /* Both reports belong to the same congestion event. */
+    uxr_process_acknack(&stream, 1, uxrSeqNum(0));
+    EXPECT_EQ(HISTORY / 2, stream.cwnd);
+    EXPECT_EQ(HISTORY / 2, stream.ssthresh);
+    uxr_process_acknack(&stream, 1, uxrSeqNum(1));
+    EXPECT_EQ(HISTORY / 2, stream.cwnd);
+
+    /* Over the threshold the window grows by one message per window acknowledged. */
+    uxr_process_acknack(&stream, 0, uxrSeqNum(3));
+    EXPECT_EQ(HISTORY / 2 + 1, stream.cwnd);
+    EXPECT_EQ(0u, stream.cwnd_acked);
+
+    /* The next increment takes a whole window of single acknowledgements. */
+    uxr_process_acknack(&stream, 0, uxrSeqNum(4));
+    EXPECT_EQ(2u, write_and_send(&stream, 2));
+    uxr_process_acknack(&stream, 0, uxrSeqNum(5));
+    EXPECT_EQ(HISTORY / 2 + 1, stream.cwnd);
+    uxr_process_acknack(&stream, 0, uxrSeqNum(6));
+    EXPECT_EQ(HISTORY / 2 + 2, stream.cwnd);
+    EXPECT_EQ(0u, stream.cwnd_acked);
+}
+
+TEST_F(OutputReliableStreamTest, CongestionWindowHeartbeatTimeout)
+{
+    uxr_set_output_reliable_stream_congestion_control(&stream, true);
+    EXPECT_EQ(2u, write_and_send(&stream, 2));
+
+    int64_t timestamp = 0;
+    for(int i = 0; i < 3; ++i)
+    {
+        (void) uxr_update_output_stream_heartbeat_timestamp(&stream, timestamp);
+        timestamp = stream.next_heartbeat_timestamp;
+    }
+    EXPECT_EQ(1u, stream.cwnd);
+    EXPECT_EQ(1u, stream.ssthresh);
+}
+
 TEST_F(OutputReliableStreamTest, FragmentedSerialization)
 {
     uint8_t* slot_1 = uxr_get_output_buffer(&stream, 1);
@@ -446,3 +568,339 @@ TEST_F(OutputReliableStreamTest, FragmentedSerialization)
     EXPECT_EQ(slot_1 + uxr_get_reliable_buffer_length(slot_1), ub.final);
 }
 
+/* Sends every written slot, each one acknowledged as soon as it is sent, and keeps the fragment payloads. */
+struct FlushedFragments
+{
+    std::vector<uint8_t> data;
+    size_t messages;
+    size_t flushes;
+};
+
+static bool flush_and_acknowledge(uxrOutputReliableStream* stream, void* args)
+{
+    FlushedFragments* flushed = static_cast<FlushedFragments*>(args);
+    uint8_t* message; size_t length; uxrSeqNum seq_num;
+    while(uxr_prepare_next_reliable_buffer_to_send(stream, &message, &length, &seq_num))
+    {
+        flushed->data.insert(flushed->data.end(), message + OFFSET + FRAGMENT_OFFSET, message + length);
+        flushed->messages++;
+        uxr_process_acknack(stream, 0, uxr_seq_num_add(seq_num, 1));
+    }
+    flushed->flushes++;
+    return true;
+}
+
+TEST_F(OutputReliableStreamTest, WriteStreamedLargerThanHistory)
+{
+    const size_t fragment_size = uxr_get_output_buffer_size(&stream) - OFFSET - FRAGMENT_OFFSET;
+    const size_t message_length = fragment_size * HISTORY * 2 + 3;
+    std::vector<uint8_t> message(message_length);
+    for(size_t i = 0; i < message_length; ++i)
+    {
+        message[i] = uint8_t(i);
+    }
+
+    FlushedFragments flushed = {std::vector<uint8_t>(), 0, 0};
+    ucdrBuffer ub;
+    ASSERT_TRUE(uxr_prepare_reliable_buffer_to_write_streamed(&stream, message_length, FRAGMENT_OFFSET, &ub, flush_and_acknowledge, &flushed));
+    EXPECT_EQ(message_length - fragment_size, stream.fragmented_remaining);
+
+    /* Serialized in pieces not aligned with the fragments. */
+    for(size_t i = 0; i < message_length; i += 7)
+    {
+        uint32_t piece = uint32_t((message_length - i < 7) ? message_length - i : 7);
+        ASSERT_TRUE(ucdr_serialize_array_uint8_t(&ub, &message[i], piece));
+    }
+    EXPECT_EQ(0u, stream.fragmented_remaining);
+    EXPECT_EQ(2u, flushed.flushes);
+
+    (void) flush_and_acknowledge(&stream, &flushed);
+    EXPECT_EQ(HISTORY * 2 + 1, flushed.messages);
+    EXPECT_EQ(message, flushed.data);
+    EXPECT_TRUE(uxr_is_output_up_to_date(&stream));
+
+    /* Writing past the declared length fails. */
+    uint8_t extra = 0;
+    EXPECT_FALSE(ucdr_serialize_uint8_t(&ub, extra));
+}
+
+TEST_F(OutputReliableStreamTest, WriteStreamedWithoutFreeSlots)
+{
+    const size_t fragment_size = uxr_get_output_buffer_size(&stream) - OFFSET - FRAGMENT_OFFSET;
+    std::vector<uint8_t> message(fragment_size * (HISTORY + 1));
+
+    ucdrBuffer ub;
+    ASSERT_TRUE(uxr_prepare_reliable_buffer_to_write_streamed(&stream, message.size(), FRAGMENT_OFFSET, &ub,
+                                                              [](uxrOutputReliableStream*, void*) { return false; }, NULL));
+    EXPECT_FALSE(ucdr_serialize_array_uint8_t(&ub, message.data(), uint32_t(message.size())));
+    EXPECT_EQ(HISTORY - 1, stream.last_written);
+
+    /* The history is still full. */
+    EXPECT_FALSE(uxr_prepare_reliable_buffer_to_write_streamed(&stream, message.size(), FRAGMENT_OFFSET, &ub, NULL, NULL));
+    EXPECT_EQ(0u, stream.fragmented_remaining);
+}
+
+TEST_F(OutputReliableStreamTest, AckLatency)
+{
+    uxrOutputReliableStreamLatency latency;
+    uxrReliableSlotTiming slots[HISTORY];
+    uxr_set_output_reliable_stream_latency(&stream, &latency, slots);
+    EXPECT_EQ(&latency, stream.latency);
+
+    ucdrBuffer ub;
+    uint8_t* message; size_t length; uxrSeqNum seq_num;
+    for(int64_t i = 0; i < 3; ++i)
+    {
+        (void) uxr_prepare_reliable_buffer_to_write(&stream, MAX_SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub);
+        (void) uxr_prepare_next_reliable_buffer_to_send(&stream, &message, &length, &seq_num);
+        uxr_register_output_reliable_send(&stream, seq_num, (i + 1) * 1000000);
+    }
+
+    uxr_process_acknack(&stream, 1, uxrSeqNum(1));
+    uxr_register_output_reliable_acks(&stream, SEQ_NUM_MAX, 11000000);
+    EXPECT_EQ(1u, latency.ack_latency.total);
+    EXPECT_EQ(10000u, latency.ack_latency.max);
+
+    uxr_register_output_reliable_retransmission(&stream, 1);
+    uxr_register_output_reliable_retransmission(&stream, 1);
+    uxr_process_acknack(&stream, 0, uxrSeqNum(3));
+    uxr_register_output_reliable_acks(&stream, 0, 13000000);
+    EXPECT_EQ(3u, latency.ack_latency.total);
+    EXPECT_EQ(10000u, latency.ack_latency.min);
+    EXPECT_EQ(11000u, latency.ack_latency.max);
+    EXPECT_EQ(2u, latency.retransmissions[0]);
+    EXPECT_EQ(1u, latency.retransmissions[2]);
+}
+
+TEST_F(OutputReliableStreamTest, DurableInitialization)
+{
+    alignas(uxrOutputReliableStreamCursors) uint8_t memory[UXR_DURABLE_STREAM_OVERHEAD + BUFFER_SIZE] = {0};
+    uxrOutputReliableStream durable_stream;
+    uxr_init_output_durable_stream(&durable_stream, memory, sizeof(memory), HISTORY, OFFSET, on_new_fragment);
+    EXPECT_EQ(memory + UXR_DURABLE_STREAM_OVERHEAD, durable_stream.buffer);
+    EXPECT_EQ(BUFFER_SIZE, durable_stream.size);
+    EXPECT_EQ(0, durable_stream.last_written);
+    EXPECT_EQ(SEQ_NUM_MAX, durable_stream.last_sent);
+    EXPECT_EQ(SEQ_NUM_MAX, durable_stream.last_acknown);
+    ASSERT_EQ(reinterpret_cast<uxrOutputReliableStreamCursors*>(memory), durable_stream.durable);
+    EXPECT_EQ(BUFFER_SIZE, durable_stream.durable->size);
+    EXPECT_EQ(HISTORY, durable_stream.durable->history);
+    EXPECT_EQ(OFFSET, durable_stream.durable->offset);
+}
+
+TEST_F(OutputReliableStreamTest, DurableRecovery)
+{
+    alignas(uxrOutputReliableStreamCursors) uint8_t memory[UXR_DURABLE_STREAM_OVERHEAD + BUFFER_SIZE] = {0};
+    uxrOutputReliableStream durable_stream;
+    uxr_init_output_durable_stream(&durable_stream, memory, sizeof(memory), HISTORY, OFFSET, on_new_fragment);
+
+    for(uint8_t i = 0; i < 3; ++i)
+    {
+        ucdrBuffer ub;
+        (void) uxr_prepare_reliable_buffer_to_write(&durable_stream, MAX_SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub);
+        ub.iterator[0] = i;
+    }
+
+    uint8_t* message; size_t length; uxrSeqNum seq_num;
+    (void) uxr_prepare_next_reliable_buffer_to_send(&durable_stream, &message, &length, &seq_num);
+    (void) uxr_prepare_next_reliable_buffer_to_send(&durable_stream, &message, &length, &seq_num);
+    uxr_process_acknack(&durable_stream, 0, uxrSeqNum(1));
+    EXPECT_EQ(0u, durable_stream.last_acknown);
+    EXPECT_EQ(1u, durable_stream.last_sent);
+
+    // The message 1 is pending, the message 2 was never sent.
+    uxrOutputReliableStream recovered_stream;
+    uxr_init_output_durable_stream(&recovered_stream, memory, sizeof(memory), HISTORY, OFFSET, on_new_fragment);
+    EXPECT_EQ(1u, recovered_stream.last_written);
+    EXPECT_EQ(0u, recovered_stream.last_sent);
+    EXPECT_EQ(SEQ_NUM_MAX, recovered_stream.last_acknown);
+
+    uint8_t* slot_0 = uxr_get_output_buffer(&recovered_stream, 0);
+    uint8_t* slot_1 = uxr_get_output_buffer(&recovered_stream, 1);
+    EXPECT_EQ(OFFSET + MAX_SUBMESSAGE_SIZE, uxr_get_reliable_buffer_length(slot_0));
+    EXPECT_EQ(1u, slot_0[OFFSET]);
+    EXPECT_EQ(OFFSET, uxr_get_reliable_buffer_length(slot_1));
+    EXPECT_FALSE(uxr_is_output_up_to_date(&recovered_stream));
+
+    uxr_reset_output_reliable_stream(&recovered_stream);
+    EXPECT_EQ(0u, recovered_stream.last_sent);
+    EXPECT_EQ(1u, slot_0[OFFSET]);
+}
+
+TEST_F(OutputReliableStreamTest, DurableLayoutMismatch)
+{
+    alignas(uxrOutputReliableStreamCursors) uint8_t memory[UXR_DURABLE_STREAM_OVERHEAD + BUFFER_SIZE] = {0};
+    uxrOutputReliableStream durable_stream;
+    uxr_init_output_durable_stream(&durable_stream, memory, sizeof(memory), HISTORY, OFFSET, on_new_fragment);
+    ucdrBuffer ub;
+    (void) uxr_prepare_reliable_buffer_to_write(&durable_stream, SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub);
+    uint8_t* message; size_t length; uxrSeqNum seq_num;
+    (void) uxr_prepare_next_reliable_buffer_to_send(&durable_stream, &message, &length, &seq_num);
+
+    uxr_init_output_durable_stream(&durable_stream, memory, sizeof(memory), HISTORY / 2, OFFSET, on_new_fragment);
+    EXPECT_EQ(0, durable_stream.last_written);
+    EXPECT_EQ(SEQ_NUM_MAX, durable_stream.last_sent);
+    EXPECT_EQ(HISTORY / 2, durable_stream.durable->history);
+}
+
+TEST_F(OutputReliableStreamTest, DurableInvalidMemory)
+{
+    alignas(uxrOutputReliableStreamCursors) uint8_t memory[UXR_DURABLE_STREAM_OVERHEAD + BUFFER_SIZE] = {0};
+    uxrOutputReliableStream durable_stream;
+    EXPECT_FALSE(uxr_init_output_durable_stream(&durable_stream, memory, UXR_DURABLE_STREAM_OVERHEAD / 2, HISTORY, OFFSET, on_new_fragment));
+    EXPECT_FALSE(uxr_init_output_durable_stream(&durable_stream, memory + 1, sizeof(memory) - 1, HISTORY, OFFSET, on_new_fragment));
+    EXPECT_EQ(0u, reinterpret_cast<uxrOutputReliableStreamCursors*>(memory)->magic);
+    EXPECT_TRUE(uxr_init_output_durable_stream(&durable_stream, memory, sizeof(memory), HISTORY, OFFSET, on_new_fragment));
+}
+
+#define PACKED_HISTORY        size_t(16)
+#define PACKED_SIZE           (UXR_PACKED_STREAM_OVERHEAD(PACKED_HISTORY) + BUFFER_SIZE)
+
+class OutputPackedStreamTest : public OutputReliableStreamTest
+{
+public:
+    OutputPackedStreamTest()
+    {
+        /* The same messages memory as the fixed stream, with blocks as large as its slots. */
+        uxr_init_output_packed_stream(&packed_stream, memory, PACKED_SIZE, PACKED_HISTORY, MAX_MESSAGE_SIZE, OFFSET, on_new_fragment);
+        EXPECT_EQ(memory + UXR_PACKED_STREAM_OVERHEAD(PACKED_HISTORY), packed_stream.buffer);
+        EXPECT_EQ(BUFFER_SIZE, packed_stream.size);
+        EXPECT_EQ(MAX_MESSAGE_SIZE, uxr_get_output_buffer_size(&packed_stream));
+        EXPECT_EQ(0, packed_stream.last_written);
+    }
+
+    /* Writes a message of one submessage, filled with the given value, and sends it. */
+    bool write_and_send(uxrOutputReliableStream* output, size_t size, uint8_t value)
+    {
+        ucdrBuffer ub;
+        bool written = uxr_prepare_reliable_buffer_to_write(output, size, FRAGMENT_OFFSET, &ub);
+        if(written)
+        {
+            memset(ub.iterator, value, size);
+            uint8_t* message; size_t length; uxrSeqNum seq_num;
+            written = uxr_prepare_next_reliable_buffer_to_send(output, &message, &length, &seq_num);
+        }
+        return written;
+    }
+
+protected:
+    uxrOutputReliableStream packed_stream;
+    uint8_t memory[PACKED_SIZE];
+};
+
+TEST_F(OutputPackedStreamTest, SmallMessagesInFlight)
+{
+    size_t fixed_in_flight = 0;
+    while(write_and_send(&stream, SUBMESSAGE_SIZE, 0))
+    {
+        ++fixed_in_flight;
+    }
+
+    size_t packed_in_flight = 0;
+    while(write_and_send(&packed_stream, SUBMESSAGE_SIZE, 0))
+    {
+        ++packed_in_flight;
+    }
+
+    EXPECT_EQ(HISTORY, fixed_in_flight);
+    EXPECT_EQ(BUFFER_SIZE / (OFFSET + SUBMESSAGE_SIZE), packed_in_flight);
+}
+
+TEST_F(OutputPackedStreamTest, GrowInPlace)
+{
+    ucdrBuffer ub;
+    ASSERT_TRUE(uxr_prepare_reliable_buffer_to_write(&packed_stream, SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub));
+    ASSERT_TRUE(uxr_prepare_reliable_buffer_to_write(&packed_stream, SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub));
+    EXPECT_EQ(0, packed_stream.last_written);
+    EXPECT_EQ(OFFSET + 2 * SUBMESSAGE_SIZE, packed_stream.packed[0].length);
+    EXPECT_EQ(packed_stream.buffer + OFFSET + SUBMESSAGE_SIZE, ub.iterator);
+
+    /* Larger than what is left of the block. */
+    ASSERT_TRUE(uxr_prepare_reliable_buffer_to_write(&packed_stream, MAX_SUBMESSAGE_SIZE, FRAGMENT_OFFSET, &ub));
+    EXPECT_EQ(1, packed_stream.last_written);
+    EXPECT_EQ(OFFSET + 2 * SUBMESSAGE_SIZE, packed_stream.packed[1].start);
+}
+
+TEST_F(OutputPackedStreamTest, WrapAround)
+{
+    /* Messages of 28 bytes, 4 fit before the end of the buffer. */
+    for(uint8_t i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(write_and_send(&packed_stream, 20, i));
+    }
+    ASSERT_FALSE(write_and_send(&packed_stream, 20, 4));
+
+    /* The first one acknowledged, the next message goes to the beginning of the buffer. */
+    uxr_process_acknack(&packed_stream, 0, 1);
+    ASSERT_TRUE(write_and_send(&packed_stream, 20, 4));
+    EXPECT_EQ(0, packed_stream.packed[4].start);
+    EXPECT_FALSE(write_and_send(&packed_stream, 20, 5));
+
+    for(uxrSeqNum seq_num = 1; seq_num <= 4; ++seq_num)
+    {
+        uint8_t* message = uxr_get_output_buffer(&packed_stream, seq_num);
+        EXPECT_EQ(OFFSET + 20, packed_stream.packed[seq_num].length);
+        EXPECT_EQ(seq_num, message[OFFSET]);
+        EXPECT_EQ(seq_num, message[OFFSET + 19]);
+    }
+}
+
+TEST_F(OutputPackedStreamTest, KeptMessagesNeverOverlap)
+{
+    /* Messages of varying sizes, acknowledged in bursts, each one checked until it is acknowledged. */
+    uxrSeqNum next_seq_num = 0;
+    for(size_t round = 0; round < 200; ++round)
+    {
+        size_t size = 1 + (round * 7) % MAX_SUBMESSAGE_SIZE;
+        if(write_and_send(&packed_stream, size, uint8_t(next_seq_num)))
+        {
+            next_seq_num = uxr_seq_num_add(next_seq_num, 1);
+        }
+        else
+        {
+            uxrSeqNum first_unacked = uxr_seq_num_add(packed_stream.last_acknown, uxrSeqNum(1 + round % 3));
+            first_unacked = (0 < uxr_seq_num_cmp(first_unacked, next_seq_num)) ? next_seq_num : first_unacked;
+            uxr_process_acknack(&packed_stream, 0, first_unacked);
+        }
+
+        for(uxrSeqNum seq_num = uxr_seq_num_add(packed_stream.last_acknown, 1);
+            0 > uxr_seq_num_cmp(seq_num, next_seq_num);
+            seq_num = uxr_seq_num_add(seq_num, 1))
+        {
+            const uxrPackedMessage* packed = &packed_stream.packed[seq_num % PACKED_HISTORY];
+            ASSERT_LE(size_t(packed->start + packed->length), BUFFER_SIZE);
+            uint8_t* message = uxr_get_output_buffer(&packed_stream, seq_num % PACKED_HISTORY);
+            for(size_t i = OFFSET; i < packed->length; ++i)
+            {
+                ASSERT_EQ(uint8_t(seq_num), message[i]);
+            }
+        }
+    }
+    EXPECT_LT(50, next_seq_num);
+}
+
+TEST_F(OutputPackedStreamTest, WriteFragmentMessage)
+{
+    const size_t fragment_size = MAX_MESSAGE_SIZE - OFFSET - FRAGMENT_OFFSET;
+    std::vector<uint8_t> message(fragment_size * 3);
+
+    ucdrBuffer ub;
+    ASSERT_TRUE(uxr_prepare_reliable_buffer_to_write(&packed_stream, message.size(), FRAGMENT_OFFSET, &ub));
+    ASSERT_TRUE(ucdr_serialize_array_uint8_t(&ub, message.data(), uint32_t(message.size())));
+    EXPECT_EQ(2, packed_stream.last_written);
+    for(size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(MAX_MESSAGE_SIZE, packed_stream.packed[i].length);
+    }
+
+    /* Without room for all the fragments, nothing is written. */
+    uxrOutputReliableStream backup;
+    copy(&backup, &packed_stream);
+    std::vector<uint8_t> large_message(fragment_size * 2);
+    ASSERT_FALSE(uxr_prepare_reliable_buffer_to_write(&packed_stream, large_message.size(), FRAGMENT_OFFSET, &ub));
+    EXPECT_EQ(backup, packed_stream);
+    for(size_t i = 3; i < PACKED_HISTORY; ++i)
+    {
+        EXPECT_EQ(OFFSET, packed_stream.packed[i].length);
+    }
+}
@@ -125,6 +125,28 @@ TEST_F(StreamStorageTest, InputReliableInitialization)
     EXPECT_EQ(UXR_INPUT_STREAM, id.direction);
 }
 
+TEST_F(StreamStorageTest, InputReliableHistoryAboveBound)
+{
+    uxrStreamId id = uxr_add_input_reliable_buffer(&storage, ir_buffer, BUFFER_SIZE, UXR_CONFIG_MAX_INPUT_RELIABLE_HISTORY * 2, on_get_fragmentation_info);
+    EXPECT_EQ(UXR_NONE_STREAM, id.type);
+    EXPECT_EQ(0u, storage.input_reliable_size);
+
+    id = uxr_add_input_reliable_buffer(&storage, ir_buffer, BUFFER_SIZE, HISTORY, on_get_fragmentation_info);
+    EXPECT_EQ(0, id.index);
+    EXPECT_EQ(UXR_RELIABLE_STREAM, id.type);
+}
+
+TEST_F(StreamStorageTest, OutputDurableInvalidMemory)
+{
+    uxrStreamId id = uxr_add_output_durable_buffer(&storage, or_buffer, 0, HISTORY, OFFSET, on_new_fragment);
+    EXPECT_EQ(UXR_NONE_STREAM, id.type);
+    EXPECT_EQ(0u, storage.output_reliable_size);
+
+    id = uxr_add_output_durable_buffer(&storage, or_buffer, BUFFER_SIZE, HISTORY, OFFSET, on_new_fragment);
+    EXPECT_EQ(0, id.index);
+    EXPECT_EQ(UXR_RELIABLE_STREAM, id.type);
+}
+
 TEST_F(StreamStorageTest, OutputReliableInitialization)
 {
     output_reliable_initialized = false;
@@ -170,6 +192,40 @@ TEST_F(StreamStorageTest, OutputStreamNoConfirmed)
     (void) uxr_add_output_reliable_buffer(&storage, or_buffer, BUFFER_SIZE, HISTORY, OFFSET, on_new_fragment);
     EXPECT_FALSE(uxr_output_streams_confirmed(&storage));
 }
+
+TEST_F(StreamStorageTest, CapacityReached)
+{
+    for(int i = 0; i < UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS; ++i)
+    {
+        (void) uxr_add_output_reliable_buffer(&storage, or_buffer, BUFFER_SIZE, HISTORY, OFFSET, on_new_fragment);
+    }
+    uxrStreamId id = uxr_add_output_reliable_buffer(&storage, or_buffer, BUFFER_SIZE, HISTORY, OFFSET, on_new_fragment);
+    EXPECT_EQ(UXR_NONE_STREAM, id.type);
+    EXPECT_EQ(UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS, storage.output_reliable_size);
+}
+
+TEST_F(StreamStorageTest, CallerArrays)
+{
+    const uint8_t streams = UXR_CONFIG_MAX_OUTPUT_RELIABLE_STREAMS + 8;
+    uxrOutputReliableStream output_reliable[streams];
+    uxrStreamArrays arrays = {};
+    arrays.output_reliable = output_reliable;
+    arrays.output_reliable_capacity = streams;
+    uxr_set_stream_storage_arrays(&storage, &arrays);
+
+    for(uint8_t i = 0; i < streams; ++i)
+    {
+        uxrStreamId id = uxr_add_output_reliable_buffer(&storage, or_buffer, BUFFER_SIZE, HISTORY, OFFSET, on_new_fragment);
+        EXPECT_EQ(i, id.index);
+        EXPECT_EQ(&output_reliable[i], uxr_get_output_reliable_stream(&storage, i));
+    }
+    EXPECT_EQ(UXR_NONE_STREAM, uxr_add_output_reliable_buffer(&storage, or_buffer, BUFFER_SIZE, HISTORY, OFFSET, on_new_fragment).type);
+
+    /* The kinds not given keep the embedded arrays. */
+    (void) uxr_add_input_reliable_buffer(&storage, ir_buffer, BUFFER_SIZE, HISTORY, on_get_fragmentation_info);
+    EXPECT_EQ(&storage.default_input_reliable[0], uxr_get_input_reliable_stream(&storage, 0));
+}
+
 // ****************************************************************************Y
 //                                  MOCKS
 // ****************************************************************************Y
@@ -209,10 +265,11 @@ void uxr_init_output_best_effort_stream(uxrOutputBestEffortStream* stream, uint8
     StreamStorageTest::output_best_effort_initialized = true;
 }
 
-void uxr_init_input_reliable_stream(uxrInputReliableStream* stream, uint8_t* buffer, size_t size, uint16_t history, OnGetFragmentationInfo on_get_fragmentation_info)
+bool uxr_init_input_reliable_stream(uxrInputReliableStream* stream, uint8_t* buffer, size_t size, uint16_t history, OnGetFragmentationInfo on_get_fragmentation_info)
 {
-    (void) stream; (void) buffer; (void) size; (void) history; (void) on_get_fragmentation_info;
+    (void) stream; (void) buffer; (void) size; (void) on_get_fragmentation_info;
     StreamStorageTest::input_reliable_initialized = true;
+    return UXR_CONFIG_MAX_INPUT_RELIABLE_HISTORY >= history;
 }
 
 void uxr_init_output_reliable_stream(uxrOutputReliableStream* stream, uint8_t* buffer, size_t size, uint16_t history, uint8_t header_offset, OnNewFragment on_new_fragment)
@@ -226,3 +283,16 @@ bool uxr_is_output_up_to_date(const uxrOutputReliableStream* stream)
     (void) stream;
     return StreamStorageTest::output_reliable_up_to_date;
 }
+
+bool uxr_init_output_durable_stream(uxrOutputReliableStream* stream, uint8_t* memory, size_t size, uint16_t history, uint8_t header_offset, OnNewFragment on_new_fragment)
+{
+    (void) stream; (void) memory; (void) history; (void) header_offset; (void) on_new_fragment;
+    StreamStorageTest::output_reliable_initialized = true;
+    return 0 < size;
+}
+
+void uxr_init_output_packed_stream(uxrOutputReliableStream* stream, uint8_t* memory, size_t size, uint16_t history, size_t max_message_size, uint8_t header_offset, OnNewFragment on_new_fragment)
+{
+    (void) stream; (void) memory; (void) size; (void) history; (void) max_message_size; (void) header_offset; (void) on_new_fragment;
+    StreamStorageTest::output_reliable_initialized = true;
+}
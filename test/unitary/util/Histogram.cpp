@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+extern "C"
+{
+#include <c/util/histogram.c>
+}
+
+class HistogramTest : public testing::Test
+{
+public:
+    HistogramTest()
+    {
+        uxr_reset_histogram(&histogram);
+        EXPECT_EQ(0u, histogram.total);
+        EXPECT_EQ(0u, uxr_histogram_percentile(&histogram, 50.0));
+    }
+
+protected:
+    uxrHistogram histogram;
+};
+
+TEST_F(HistogramTest, BucketIndex)
+{
+    for(uint32_t i = 0; i < SUB_BUCKETS * 2; ++i)
+    {
+        EXPECT_EQ(i, bucket_index(i));
+    }
+    EXPECT_EQ(SUB_BUCKETS * 2, bucket_index(SUB_BUCKETS * 2));
+    EXPECT_EQ(SUB_BUCKETS * 2, bucket_index(SUB_BUCKETS * 2 + 1));
+    EXPECT_EQ(uint32_t(UXR_HISTOGRAM_SIZE - 1), bucket_index(UINT32_MAX));
+}
+
+TEST_F(HistogramTest, BucketRelativeError)
+{
+    for(uint32_t value = 1; value < UINT32_MAX / 3; value = value * 3 + 1)
+    {
+        uint32_t highest = bucket_highest_value(bucket_index(value));
+        EXPECT_LE(value, highest);
+        EXPECT_LE(double(highest - value) / double(value), 1.0 / SUB_BUCKETS);
+    }
+}
+
+TEST_F(HistogramTest, Percentiles)
+{
+    for(uint32_t i = 1; i <= 1000; ++i)
+    {
+        uxr_record_histogram_value(&histogram, i);
+    }
+    EXPECT_EQ(1000u, histogram.total);
+    EXPECT_EQ(1u, histogram.min);
+    EXPECT_EQ(1000u, histogram.max);
+
+    EXPECT_EQ(1u, uxr_histogram_percentile(&histogram, 0.0));
+    EXPECT_NEAR(500.0, double(uxr_histogram_percentile(&histogram, 50.0)), 500.0 / SUB_BUCKETS);
+    EXPECT_NEAR(990.0, double(uxr_histogram_percentile(&histogram, 99.0)), 990.0 / SUB_BUCKETS);
+    EXPECT_EQ(1000u, uxr_histogram_percentile(&histogram, 100.0));
+}
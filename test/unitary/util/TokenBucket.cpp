@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+extern "C"
+{
+#include <c/util/token_bucket.c>
+}
+
+#define RATE    1000
+#define BURST   100
+
+class TokenBucketTest : public testing::Test
+{
+public:
+    TokenBucketTest()
+    {
+        uxr_init_token_bucket(&bucket, RATE, BURST);
+        EXPECT_EQ(0, uxr_token_bucket_delay(&bucket, BURST, 0));
+    }
+
+protected:
+    uxrTokenBucket bucket;
+};
+
+TEST_F(TokenBucketTest, Burst)
+{
+    uxr_take_tokens(&bucket, BURST / 2, 0);
+    EXPECT_EQ(0, uxr_token_bucket_delay(&bucket, BURST / 2, 0));
+    uxr_take_tokens(&bucket, BURST / 2, 0);
+    EXPECT_EQ(1, uxr_token_bucket_delay(&bucket, 1, 0));
+}
+
+TEST_F(TokenBucketTest, Refill)
+{
+    uxr_take_tokens(&bucket, BURST, 0);
+    EXPECT_EQ(BURST * 1000 / RATE, uxr_token_bucket_delay(&bucket, BURST, 0));
+    EXPECT_EQ(BURST * 1000 / RATE / 2, uxr_token_bucket_delay(&bucket, BURST, BURST * 1000 / RATE / 2));
+    EXPECT_EQ(0, uxr_token_bucket_delay(&bucket, BURST, BURST * 1000 / RATE));
+}
+
+TEST_F(TokenBucketTest, SlowRate)
+{
+    /* Less than a byte per millisecond is still refilled on every millisecond. */
+    uxr_init_token_bucket(&bucket, 300, 10);
+    uxr_take_tokens(&bucket, 10, 0);
+    for(int64_t t = 1; t < 4; ++t)
+    {
+        EXPECT_EQ(4 - t, uxr_token_bucket_delay(&bucket, 1, t));
+    }
+    EXPECT_EQ(0, uxr_token_bucket_delay(&bucket, 1, 4));
+}
+
+TEST_F(TokenBucketTest, LargerThanBurst)
+{
+    /* A full bucket lets it go, the debt delays the next ones. */
+    EXPECT_EQ(0, uxr_token_bucket_delay(&bucket, BURST * 3, 0));
+    uxr_take_tokens(&bucket, BURST * 3, 0);
+    EXPECT_EQ((BURST * 2 + 1) * 1000 / RATE, uxr_token_bucket_delay(&bucket, 1, 0));
+}
+
+TEST_F(TokenBucketTest, LongIdle)
+{
+    uxr_take_tokens(&bucket, BURST, 0);
+    EXPECT_EQ(0, uxr_token_bucket_delay(&bucket, BURST, INT64_MAX / 2));
+    uxr_take_tokens(&bucket, 1, INT64_MAX / 2);
+    EXPECT_EQ(1, uxr_token_bucket_delay(&bucket, BURST, INT64_MAX / 2));
+}
+
+TEST_F(TokenBucketTest, Unlimited)
+{
+    uxr_init_token_bucket(&bucket, 0, 0);
+    uxr_take_tokens(&bucket, BURST, 0);
+    EXPECT_EQ(0, uxr_token_bucket_delay(&bucket, BURST, 0));
+}
@@ -0,0 +1,143 @@
+// Copyright 2019 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <uxr/client/profile/capture/message_capture.h>
+
+#include "core/log/log_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHB_TYPE            0x0A0D0D0A
+#define IDB_TYPE            0x00000001
+#define EPB_TYPE            0x00000006
+#define BYTE_ORDER_MAGIC    0x1A2B3C4D
+#define OPTION_END          0
+#define OPTION_EPB_FLAGS    2
+#define EPB_HEADER_SIZE     20
+#define MAX_BLOCK_SIZE      (1 << 20)
+
+static int decode_packet(const uint8_t* body, uint32_t body_length);
+
+int main(int args, char** argv)
+{
+    // CLI
+    if(2 > args)
+    {
+        printf("usage: program <capture.pcapng>\n");
+        return 1;
+    }
+
+    FILE* file = fopen(argv[1], "rb");
+    if(NULL == file)
+    {
+        printf("Error at opening %s\n", argv[1]);
+        return 1;
+    }
+
+    // Blocks
+    static uint8_t body[MAX_BLOCK_SIZE];
+    uint32_t block_header[2];
+    int packets = 0;
+    int error = 0;
+    while(0 == error && 1 == fread(block_header, sizeof(block_header), 1, file))
+    {
+        uint32_t type = block_header[0];
+        uint32_t body_length = block_header[1] - (uint32_t)(sizeof(block_header) + sizeof(uint32_t));
+        if(block_header[1] % 4 != 0 || MAX_BLOCK_SIZE < body_length
+           || 1 != fread(body, body_length + sizeof(uint32_t), 1, file))
+        {
+            printf("Error: truncated block\n");
+            error = 1;
+        }
+        else if(SHB_TYPE == type)
+        {
+            uint32_t magic;
+            memcpy(&magic, body, sizeof(magic));
+            if(BYTE_ORDER_MAGIC != magic)
+            {
+                printf("Error: only captures with the native byte order are supported\n");
+                error = 1;
+            }
+        }
+        else if(IDB_TYPE == type)
+        {
+            uint16_t link_type;
+            memcpy(&link_type, body, sizeof(link_type));
+            if(UXR_CAPTURE_LINKTYPE != link_type)
+            {
+                printf("Error: unexpected link type %hu\n", link_type);
+                error = 1;
+            }
+        }
+        else if(EPB_TYPE == type)
+        {
+            error = decode_packet(body, body_length);
+            packets++;
+        }
+    }
+
+    printf("%d messages\n", packets);
+    fclose(file);
+
+    return error;
+}
+
+int decode_packet(const uint8_t* body, uint32_t body_length)
+{
+    if(EPB_HEADER_SIZE > body_length)
+    {
+        printf("Error: truncated packet\n");
+        return 1;
+    }
+
+    uint32_t fields[5]; // interface, timestamp high, timestamp low, captured length, original length
+    memcpy(fields, body, sizeof(fields));
+    int64_t timestamp = (int64_t)(((uint64_t)fields[1] << 32) | fields[2]);
+    uint32_t length = fields[3];
+    /* Bounded before being padded, so a corrupted length can not wrap around.
+       The body is 4-byte aligned, so the padding fits as well. */
+    if(body_length - EPB_HEADER_SIZE < length)
+    {
+        printf("Error: truncated packet\n");
+        return 1;
+    }
+    uint32_t padded_length = (length + 3u) & ~3u;
+
+    uint32_t flags = 0;
+    uint32_t offset = EPB_HEADER_SIZE + padded_length;
+    while(offset + 4 <= body_length)
+    {
+        uint16_t option[2]; // code, length
+        memcpy(option, body + offset, sizeof(option));
+        if(OPTION_END == option[0])
+        {
+            break;
+        }
+        if(OPTION_EPB_FLAGS == option[0] && sizeof(flags) == option[1] && offset + 8 <= body_length)
+        {
+            memcpy(&flags, body + offset + 4, sizeof(flags));
+        }
+        offset += 4u + (((uint32_t)option[1] + 3u) & ~3u);
+    }
+
+    /* The message log parses the buffer in place, so it is decoded from a copy. */
+    static uint8_t message[MAX_BLOCK_SIZE];
+    memcpy(message, body + EPB_HEADER_SIZE, length);
+    int direction = (UXR_CAPTURE_OUTBOUND == (flags & 0x03)) ? UXR_SEND : UXR_RECV;
+    uxr_print_message_at(direction, message, length, NULL, timestamp / 1000000);
+
+    return 0;
+}